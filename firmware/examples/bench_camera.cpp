@@ -0,0 +1,272 @@
+/**
+ * @file bench_camera.cpp
+ * @brief Camera Pipeline Benchmark - Frame Size / Quality / XCLK / Buffer Sweep.
+ * @author Alejandro Moyano (@AleSMC)
+ *
+ * @details
+ * Measures the OV2640 + JPEG + DMA pipeline alone (no WiFi, no HTTP) for every
+ * combination of:
+ * - Driver settings (re-init):   xclk_freq_hz x fb_count x grab_mode.
+ * - Sensor settings (live):      frame size x JPEG quality.
+ *
+ * For each combination it discards a few warm-up frames, then captures
+ * BENCH_FRAMES frames and prints one CSV row:
+ * xclk_mhz,fb_count,grab,framesize,width,height,quality,frames,fps,
+ * get_p50_us,get_p90_us,get_p99_us,get_max_us,jpeg_min,jpeg_avg,jpeg_p90,jpeg_max,
+ * psram_fb_bytes,psram_free_min
+ *
+ * - fps:            frames / wall time of the capture loop (fb_get + return only).
+ * - get_*_us:       esp_camera_fb_get() latency percentiles.
+ * - jpeg_*:         JPEG size distribution (bytes).
+ * - psram_fb_bytes: PSRAM taken by the driver at init (frame buffers).
+ * - psram_free_min: PSRAM low-water mark since boot.
+ * - A combination that delivers no frame prints frames = 0 and empty statistics.
+ *
+ * =================================================================================
+ * @section execution Deployment Procedure (CLI)
+ * =================================================================================
+ *
+ * 1. HARDWARE PREPARATION:
+ * - Camera connected. Point it at a representative scene (JPEG size depends on it).
+ *
+ * 2. SOFTWARE PREPARATION:
+ * - Copy the entire content of this file.
+ * - Paste it into 'firmware/src/main.cpp' (overwriting current content).
+ *
+ * 3. TERMINAL COMMANDS (From project root):
+ * $ cd firmware
+ * $ pio run -t upload
+ * $ pio device monitor > bench_camera.csv   (or copy the CSV block)
+ *
+ * 4. VERIFICATION:
+ * - Every row must show frames == BENCH_FRAMES (otherwise fb_get timed out).
+ * - Compare fps / jpeg_avg to pick the profile values in lib/CameraProfiles.
+ * =================================================================================
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include "soc/soc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "config.h"
+
+// =============================================================================
+// SWEEP DEFINITION
+// =============================================================================
+
+const int BENCH_FRAMES = 60; ///< Measured frames per combination
+const int BENCH_WARMUP = 5;  ///< Discarded frames after each change (AEC settles)
+
+const int XCLK_MHZ[] = {10, 15, 20};
+const size_t FB_COUNTS[] = {1, 2};
+const camera_grab_mode_t GRAB_MODES[] = {CAMERA_GRAB_WHEN_EMPTY, CAMERA_GRAB_LATEST};
+const framesize_t FRAMESIZES[] = {FRAMESIZE_QQVGA, FRAMESIZE_QVGA, FRAMESIZE_CIF, FRAMESIZE_VGA, FRAMESIZE_SVGA};
+const char *FRAMESIZE_NAMES[] = {"QQVGA", "QVGA", "CIF", "VGA", "SVGA"};
+const int QUALITIES[] = {10, 30, 60};
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+// AI Thinker pin map (same as CameraServer.cpp)
+#define PWDN_GPIO_NUM 32
+#define RESET_GPIO_NUM -1
+#define XCLK_GPIO_NUM 0
+#define SIOD_GPIO_NUM 26
+#define SIOC_GPIO_NUM 27
+#define Y9_GPIO_NUM 35
+#define Y8_GPIO_NUM 34
+#define Y7_GPIO_NUM 39
+#define Y6_GPIO_NUM 36
+#define Y5_GPIO_NUM 21
+#define Y4_GPIO_NUM 19
+#define Y3_GPIO_NUM 18
+#define Y2_GPIO_NUM 5
+#define VSYNC_GPIO_NUM 25
+#define HREF_GPIO_NUM 23
+#define PCLK_GPIO_NUM 22
+
+static uint32_t getUs[BENCH_FRAMES];  ///< fb_get latency samples
+static uint32_t jpegLen[BENCH_FRAMES]; ///< JPEG size samples
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+/**
+ * @brief Starts the driver with the given clock and buffer strategy.
+ * @details Buffers are sized for the largest swept frame size (SVGA).
+ * @return PSRAM bytes taken by the driver, or -1 on failure.
+ */
+static long startCamera(int xclkMhz, size_t fbCount, camera_grab_mode_t grab)
+{
+    camera_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.ledc_channel = LEDC_CHANNEL_0;
+    config.ledc_timer = LEDC_TIMER_0;
+    config.pin_d0 = Y2_GPIO_NUM;
+    config.pin_d1 = Y3_GPIO_NUM;
+    config.pin_d2 = Y4_GPIO_NUM;
+    config.pin_d3 = Y5_GPIO_NUM;
+    config.pin_d4 = Y6_GPIO_NUM;
+    config.pin_d5 = Y7_GPIO_NUM;
+    config.pin_d6 = Y8_GPIO_NUM;
+    config.pin_d7 = Y9_GPIO_NUM;
+    config.pin_xclk = XCLK_GPIO_NUM;
+    config.pin_pclk = PCLK_GPIO_NUM;
+    config.pin_vsync = VSYNC_GPIO_NUM;
+    config.pin_href = HREF_GPIO_NUM;
+    config.pin_sccb_sda = SIOD_GPIO_NUM;
+    config.pin_sccb_scl = SIOC_GPIO_NUM;
+    config.pin_pwdn = PWDN_GPIO_NUM;
+    config.pin_reset = RESET_GPIO_NUM;
+    config.xclk_freq_hz = xclkMhz * 1000000;
+    config.pixel_format = PIXFORMAT_JPEG;
+    config.frame_size = FRAMESIZE_SVGA;
+    config.jpeg_quality = 10; // Worst case size for buffer allocation
+    config.fb_count = fbCount;
+    config.fb_location = CAMERA_FB_IN_PSRAM;
+    config.grab_mode = grab;
+
+    size_t before = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    if (esp_camera_init(&config) != ESP_OK)
+        return -1;
+    return (long)(before - heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+}
+
+/**
+ * @brief Nearest-rank percentile of a sorted array.
+ */
+static uint32_t pct(const uint32_t *sorted, int n, int p)
+{
+    int k = (n * p + 99) / 100 - 1;
+    return sorted[k < 0 ? 0 : (k >= n ? n - 1 : k)];
+}
+
+/**
+ * @brief Captures BENCH_FRAMES frames with the current settings and prints the row.
+ */
+static void measure(int xclkMhz, size_t fbCount, camera_grab_mode_t grab, int fsIdx, int quality, long fbBytes)
+{
+    // 1. WARM-UP (let AEC/AGC settle and flush frames taken with the old settings)
+    for (int i = 0; i < BENCH_WARMUP; i++)
+    {
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (fb)
+            esp_camera_fb_return(fb);
+    }
+
+    // 2. MEASUREMENT
+    int n = 0;
+    uint16_t width = 0, height = 0;
+    uint64_t jpegSum = 0;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        int64_t t0 = esp_timer_get_time();
+        camera_fb_t *fb = esp_camera_fb_get();
+        uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+        if (!fb)
+            continue;
+        getUs[n] = dt;
+        jpegLen[n] = fb->len;
+        jpegSum += fb->len;
+        width = fb->width;
+        height = fb->height;
+        n++;
+        esp_camera_fb_return(fb);
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    if (n == 0)
+    {
+        // Same 19 columns as the header: frames = 0, no latency/size statistics
+        Serial.printf("%d,%u,%s,%s,0,0,%d,0,0.00,,,,,,,,,%ld,%u\n", xclkMhz, (unsigned)fbCount,
+                      grab == CAMERA_GRAB_LATEST ? "latest" : "when_empty", FRAMESIZE_NAMES[fsIdx], quality,
+                      fbBytes, (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+        return;
+    }
+
+    // 3. STATISTICS
+    std::sort(getUs, getUs + n);
+    std::sort(jpegLen, jpegLen + n);
+    float fps = n * 1000000.0f / (float)elapsed;
+
+    Serial.printf("%d,%u,%s,%s,%u,%u,%d,%d,%.2f,%u,%u,%u,%u,%u,%u,%u,%u,%ld,%u\n",
+                  xclkMhz, (unsigned)fbCount, grab == CAMERA_GRAB_LATEST ? "latest" : "when_empty",
+                  FRAMESIZE_NAMES[fsIdx], width, height, quality, n, fps,
+                  pct(getUs, n, 50), pct(getUs, n, 90), pct(getUs, n, 99), getUs[n - 1],
+                  jpegLen[0], (unsigned)(jpegSum / n), pct(jpegLen, n, 90), jpegLen[n - 1],
+                  fbBytes, (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+}
+
+// =============================================================================
+// SETUP / LOOP
+// =============================================================================
+
+void setup()
+{
+    // 1. Power Management: Disable Brownout Detector
+    WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
+
+    // 2. Start serial port
+    Serial.begin(LOG_BAUD);
+    Serial.println("\n[BOOT] Camera Pipeline Benchmark");
+
+    if (!psramFound())
+    {
+        Serial.println("[ERROR] PSRAM required (SVGA buffers). Benchmark aborted.");
+        while (true)
+            delay(1000);
+    }
+
+    Serial.println("[INFO] Starting in 5 seconds... (point the camera at a typical scene)");
+    delay(5000);
+}
+
+void loop()
+{
+    Serial.println("xclk_mhz,fb_count,grab,framesize,width,height,quality,frames,fps,"
+                   "get_p50_us,get_p90_us,get_p99_us,get_max_us,jpeg_min,jpeg_avg,jpeg_p90,jpeg_max,"
+                   "psram_fb_bytes,psram_free_min");
+
+    for (int x = 0; x < COUNT_OF(XCLK_MHZ); x++)
+    {
+        for (int b = 0; b < COUNT_OF(FB_COUNTS); b++)
+        {
+            for (int g = 0; g < COUNT_OF(GRAB_MODES); g++)
+            {
+                // GRAB_LATEST needs a spare buffer to drop into
+                if (FB_COUNTS[b] == 1 && GRAB_MODES[g] == CAMERA_GRAB_LATEST)
+                    continue;
+
+                // 1. DRIVER SETTINGS (require re-init)
+                long fbBytes = startCamera(XCLK_MHZ[x], FB_COUNTS[b], GRAB_MODES[g]);
+                if (fbBytes < 0)
+                {
+                    Serial.printf("[ERROR] Init failed (xclk %d, fb %u)\n", XCLK_MHZ[x], (unsigned)FB_COUNTS[b]);
+                    continue;
+                }
+                sensor_t *s = esp_camera_sensor_get();
+
+                // 2. SENSOR SETTINGS (live, same as CameraProfiles)
+                for (int f = 0; f < COUNT_OF(FRAMESIZES); f++)
+                {
+                    s->set_framesize(s, FRAMESIZES[f]);
+                    for (int q = 0; q < COUNT_OF(QUALITIES); q++)
+                    {
+                        s->set_quality(s, QUALITIES[q]);
+                        measure(XCLK_MHZ[x], FB_COUNTS[b], GRAB_MODES[g], f, QUALITIES[q], fbBytes);
+                    }
+                }
+
+                esp_camera_deinit();
+                delay(100); // Let the sensor power down between inits
+            }
+        }
+    }
+
+    Serial.println("[BENCH] Sweep complete. Repeating in 60 seconds...");
+    delay(60000);
+}
@@ -0,0 +1,367 @@
+/**
+ * @file bench_control_jitter.cpp
+ * @brief Control Jitter Benchmark - Task Layout Comparison under Video Load.
+ * @author Alejandro Moyano (@AleSMC)
+ *
+ * @details
+ * Measures how late a control packet is handled while the camera is
+ * capturing and streaming at full rate, for several core/priority layouts
+ * (see 'TASK LAYOUT' in config.h).
+ *
+ * For each layout the benchmark starts three tasks:
+ * - pacer:   sends a timestamped UDP datagram to 127.0.0.1 every BENCH_PERIOD_MS
+ *            (core 0, priority 20, like packets delivered by the WiFi/lwIP tasks).
+ * - control: blocks in recv() and records (receive time - send time). Placed per layout.
+ * - video:   esp_camera_fb_get() + MJPEG send to the TCP client on port 81,
+ *            the same work the stream sender tasks do. Placed per layout.
+ *
+ * Output is one CSV row per layout (latency in microseconds):
+ * layout,ctrl_core,ctrl_prio,video_core,video_prio,samples,lost,p50_us,p99_us,max_us,video_fps
+ *
+ * @note
+ * Loopback skips the radio: the numbers isolate scheduling and lwIP (tcpip task)
+ * contention. Over-the-air latency is added on top, use tools.control_latency for it.
+ *
+ * =================================================================================
+ * @section execution Deployment Procedure (CLI)
+ * =================================================================================
+ *
+ * 1. HARDWARE PREPARATION:
+ * - Camera connected. Motors are NOT used (battery optional).
+ *
+ * 2. SOFTWARE PREPARATION:
+ * - Copy the entire content of this file.
+ * - Paste it into 'firmware/src/main.cpp' (overwriting current content).
+ *
+ * 3. TERMINAL COMMANDS (From project root):
+ * $ cd firmware
+ * $ pio run -t upload
+ * $ pio device monitor -b 115200
+ *
+ * 4. VIDEO LOAD (From the PC, keep it running during the whole benchmark):
+ * $ curl -s http://<ROVER_IP>:81/ -o /dev/null
+ * - Without a client only the capture load is applied (video_fps still reported).
+ *
+ * 5. VERIFICATION:
+ * - Copy the CSV rows and compare p99_us/max_us between layouts.
+ * - Compare against the 'firmware_config' row (taken from config.h) and port
+ *   the best layout to TASK_CONTROL / TASK_STREAM in config.h.
+ * =================================================================================
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include "soc/soc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "config.h"
+#include "NetworkManager.h"
+#include "CameraServer.h"
+
+// =============================================================================
+// BENCHMARK PARAMETERS
+// =============================================================================
+
+const int BENCH_PERIOD_MS = 10;       ///< Control packet period (100 Hz, like the pilot)
+const int BENCH_DURATION_MS = 20000;  ///< Measurement window per layout
+const int BENCH_PORT = 9998;          ///< Loopback control port
+const int BENCH_VIDEO_PORT = 81;      ///< MJPEG sink port for the load client
+const int BENCH_MAX_SAMPLES = BENCH_DURATION_MS / BENCH_PERIOD_MS + 16;
+
+/** @brief One layout under test: control receiver and video sender placement. */
+struct BenchLayout
+{
+    const char *name;
+    TaskPlacement control;
+    TaskPlacement video;
+};
+
+const BenchLayout LAYOUTS[] = {
+    // Baseline: what the firmware runs (config.h TASK_CONTROL / TASK_STREAM)
+    {"firmware_config", TASK_CONTROL, TASK_STREAM},
+    // Arduino defaults: loopTask (core 1, prio 1), httpd (no affinity, prio 5)
+    {"arduino_default", {1, 1, 4096}, {tskNO_AFFINITY, 5, 4096}},
+    // Control owns core 1, video next to WiFi
+    {"split_ctrl1_video0", {1, 10, 4096}, {0, 5, 4096}},
+    // Inverted split: control next to WiFi/lwIP, video alone on core 1
+    {"split_ctrl0_video1", {0, 10, 4096}, {1, 5, 4096}},
+    // Everything on the APP core, control above video
+    {"shared_core1", {1, 10, 4096}, {1, 5, 4096}},
+    // Control below video: shows what priority inversion costs
+    {"ctrl_below_video", {1, 3, 4096}, {1, 5, 4096}},
+};
+const int LAYOUT_COUNT = sizeof(LAYOUTS) / sizeof(LAYOUTS[0]);
+
+/** @brief Control datagram payload. */
+struct BenchPacket
+{
+    uint32_t seq;
+    int64_t sentUs;
+};
+
+// =============================================================================
+// SHARED STATE
+// =============================================================================
+
+NetworkManager network;
+CameraServer camera;
+
+static volatile bool running = false;        ///< Cleared to stop the round
+static SemaphoreHandle_t exited = NULL;      ///< Given by each task on exit
+static uint32_t samples[BENCH_MAX_SAMPLES];  ///< Control latency (us)
+static volatile int sampleCount = 0;
+static volatile uint32_t lastSeq = 0;        ///< Highest sequence received
+static volatile uint32_t sentCount = 0;
+static volatile uint32_t framesCaptured = 0;
+static int listenSock = -1;                  ///< MJPEG load listener
+static int videoClient = -1;                 ///< Current load client (kept between rounds)
+
+// =============================================================================
+// BENCHMARK TASKS
+// =============================================================================
+
+/**
+ * @brief Sends one timestamped datagram every BENCH_PERIOD_MS to the control socket.
+ */
+static void pacerTask(void *arg)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in dst;
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons(BENCH_PORT);
+    dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    BenchPacket pkt;
+    pkt.seq = 0;
+    TickType_t lastWake = xTaskGetTickCount();
+
+    while (running)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(BENCH_PERIOD_MS));
+        pkt.seq++;
+        pkt.sentUs = esp_timer_get_time();
+        sendto(sock, &pkt, sizeof(pkt), 0, (struct sockaddr *)&dst, sizeof(dst));
+        sentCount = pkt.seq;
+    }
+
+    close(sock);
+    xSemaphoreGive(exited);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Control receiver stand-in: blocks in recv() and records the latency.
+ */
+static void controlTask(void *arg)
+{
+    int sock = *(int *)arg;
+    BenchPacket pkt;
+
+    while (running)
+    {
+        int len = recv(sock, &pkt, sizeof(pkt), 0); // SO_RCVTIMEO bounds the wait
+        if (len != sizeof(pkt))
+            continue;
+
+        int64_t latency = esp_timer_get_time() - pkt.sentUs;
+        if (sampleCount < BENCH_MAX_SAMPLES)
+        {
+            samples[sampleCount] = (uint32_t)latency;
+            sampleCount = sampleCount + 1;
+        }
+        lastSeq = pkt.seq;
+    }
+
+    xSemaphoreGive(exited);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Sends all of 'len' bytes to the load client.
+ * @return false if the client is gone (socket closed).
+ */
+static bool sendAll(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (len > 0)
+    {
+        int n = send(videoClient, p, len, 0);
+        if (n <= 0)
+        {
+            close(videoClient);
+            videoClient = -1;
+            Serial.println("[BENCH] Video client disconnected.");
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief Video load: capture + MJPEG send, same work as CameraServer::streamHandler.
+ */
+static void videoTask(void *arg)
+{
+    static const char HEADER[] =
+        "HTTP/1.1 200 OK\r\nContent-Type: multipart/x-mixed-replace;boundary=frame\r\n\r\n";
+    char part[96];
+
+    while (running)
+    {
+        // 1. ACCEPT (non-blocking): a client may join at any time
+        if (videoClient < 0)
+        {
+            videoClient = accept(listenSock, NULL, NULL);
+            if (videoClient >= 0)
+            {
+                // Blocking sends like httpd, bounded by a timeout
+                fcntl(videoClient, F_SETFL, fcntl(videoClient, F_GETFL, 0) & ~O_NONBLOCK);
+                struct timeval tv = {1, 0}; // Never hang the round on a stalled client
+                setsockopt(videoClient, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+                Serial.println("[BENCH] Video client connected.");
+                sendAll(HEADER, sizeof(HEADER) - 1);
+            }
+        }
+
+        // 2. CAPTURE
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (!fb)
+        {
+            delay(10);
+            continue;
+        }
+        framesCaptured = framesCaptured + 1;
+
+        // 3. SEND (only if someone is listening)
+        if (videoClient >= 0)
+        {
+            int hlen = snprintf(part, sizeof(part),
+                                "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
+                                (unsigned)fb->len);
+            if (sendAll(part, hlen) && sendAll(fb->buf, fb->len))
+                sendAll("\r\n", 2);
+        }
+        esp_camera_fb_return(fb);
+    }
+
+    xSemaphoreGive(exited);
+    vTaskDelete(NULL);
+}
+
+// =============================================================================
+// ROUND EXECUTION
+// =============================================================================
+
+/**
+ * @brief Runs one layout for BENCH_DURATION_MS and prints its CSV row.
+ */
+static void runLayout(const BenchLayout &layout)
+{
+    // 1. RESET
+    sampleCount = 0;
+    lastSeq = 0;
+    sentCount = 0;
+    framesCaptured = 0;
+
+    int ctrlSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(ctrlSock, (struct sockaddr *)&addr, sizeof(addr));
+    struct timeval tv = {0, 100000};
+    setsockopt(ctrlSock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    // 2. START (receivers first, pacer last)
+    running = true;
+    xTaskCreatePinnedToCore(controlTask, "control", layout.control.stack, &ctrlSock,
+                            layout.control.priority, NULL, layout.control.core);
+    xTaskCreatePinnedToCore(videoTask, "video", layout.video.stack, NULL,
+                            layout.video.priority, NULL, layout.video.core);
+    xTaskCreatePinnedToCore(pacerTask, "pacer", 3072, NULL, 20, NULL, 0);
+
+    delay(BENCH_DURATION_MS);
+
+    // 3. STOP AND JOIN
+    running = false;
+    for (int i = 0; i < 3; i++)
+        xSemaphoreTake(exited, portMAX_DELAY);
+    close(ctrlSock);
+
+    // 4. REPORT
+    int n = sampleCount;
+    if (n == 0)
+    {
+        Serial.printf("%s,ERROR: no samples\n", layout.name);
+        return;
+    }
+    std::sort(samples, samples + n);
+    uint32_t lost = sentCount > (uint32_t)n ? sentCount - n : 0;
+    Serial.printf("%s,%d,%u,%d,%u,%d,%u,%u,%u,%u,%.1f\n",
+                  layout.name,
+                  (int)layout.control.core, (unsigned)layout.control.priority,
+                  (int)layout.video.core, (unsigned)layout.video.priority,
+                  n, (unsigned)lost,
+                  (unsigned)samples[n / 2],
+                  (unsigned)samples[(n * 99) / 100],
+                  (unsigned)samples[n - 1],
+                  framesCaptured * 1000.0f / BENCH_DURATION_MS);
+}
+
+// =============================================================================
+// SETUP / LOOP
+// =============================================================================
+
+void setup()
+{
+    // 1. Power Management: Disable Brownout Detector
+    WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
+
+    // 2. Start serial port
+    Serial.begin(115200);
+    Serial.println("\n[BOOT] Control Jitter Benchmark");
+
+    // 3. Camera + Network (same drivers as the firmware)
+    if (!camera.init())
+    {
+        Serial.println("[ERROR] Camera not detected. CHECK FLEX CABLE.");
+        while (true)
+            delay(1000);
+    }
+    network.begin();
+
+    // 4. MJPEG load listener (non-blocking accept)
+    listenSock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_VIDEO_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    bind(listenSock, (struct sockaddr *)&addr, sizeof(addr));
+    listen(listenSock, 1);
+    fcntl(listenSock, F_SETFL, fcntl(listenSock, F_GETFL, 0) | O_NONBLOCK);
+
+    exited = xSemaphoreCreateCounting(3, 0);
+
+    Serial.printf("[INFO] Video load: curl -s http://%s:%d/ -o /dev/null\n",
+                  network.getIP(), BENCH_VIDEO_PORT);
+    Serial.println("[INFO] Starting in 10 seconds...");
+    delay(10000);
+}
+
+void loop()
+{
+    Serial.println("layout,ctrl_core,ctrl_prio,video_core,video_prio,samples,lost,p50_us,p99_us,max_us,video_fps");
+    for (int i = 0; i < LAYOUT_COUNT; i++)
+    {
+        runLayout(LAYOUTS[i]);
+    }
+    Serial.println("[BENCH] Cycle end. Repeating in 10 seconds...");
+    delay(10000);
+}
@@ -0,0 +1,301 @@
+/**
+ * @file bench_network.cpp
+ * @brief Network Capacity Benchmark - Control Flood + Concurrent Stream Clients.
+ * @author Alejandro Moyano (@AleSMC)
+ *
+ * @details
+ * Runs the production service set (NetworkManager, CameraServer, RemoteControl,
+ * Scheduler, control task) with the motors attached, and prints one CSV row
+ * per second describing what the firmware actually processed while the host
+ * load generator (tools.load_generator) floods UDP 9999 and opens N '/stream'
+ * clients:
+ *
+ * t_s,rx_pps,rejected,failsafe,apply_n,apply_p50_us,apply_p90_us,apply_p99_us,
+ * loop_p99_us,capture_fps,stream_fps,ws_fps,clients,per_client_fps
+ *
+ * - rx_pps:          control datagrams read from the socket (per second).
+ * - apply_*_us:      packet-to-PWM latency (recvfrom() returned -> PWM registers
+ *                    written), from Metrics::controlApplyUs. Values are bucket
+ *                    upper bounds; -1 means above the last bound.
+ * - loop_p99_us:     control task body duration (all services of one wake-up).
+ * - per_client_fps:  "fd:fps" per client held by a stream sender, '|' separated.
+ *
+ * Drops are counted by the host: datagrams sent minus rover_udp_received_total
+ * (scraped from '/metrics' before and after each step). At most
+ * STREAM_MAX_CLIENTS clients appear in per_client_fps: a further client purges
+ * the least recently served one (rover_stream_evictions_total).
+ *
+ * =================================================================================
+ * @section execution Deployment Procedure (CLI)
+ * =================================================================================
+ *
+ * 1. HARDWARE PREPARATION:
+ * - Camera connected. Wheels OFF THE GROUND: the generator sends neutral
+ *   commands (Coast + Center), but a bad packet would still move the rover.
+ *
+ * 2. SOFTWARE PREPARATION:
+ * - Copy the entire content of this file.
+ * - Paste it into 'firmware/src/main.cpp' (overwriting current content).
+ *
+ * 3. TERMINAL COMMANDS (From project root):
+ * $ cd firmware
+ * $ pio run -t upload
+ * $ pio device monitor > bench_network.csv   (or copy the CSV block)
+ *
+ * 4. LOAD (From the PC, in another terminal):
+ * $ cd software
+ * $ python -m tools.load_generator --ip <ROVER_IP> --rates 50,100,200,500,1000 --clients 0,1,2
+ *
+ * 5. VERIFICATION:
+ * - rx_pps follows the generator rate until the capacity limit: the knee is
+ *   where apply_p99_us or the host-side drops start to climb.
+ * - failsafe must stay 0 during every step.
+ * =================================================================================
+ */
+
+#include <Arduino.h>
+#include "soc/soc.h"
+#include "soc/rtc_cntl_reg.h"
+#include "esp_timer.h"
+#include "config.h"
+#include "NetworkManager.h"
+#include "CameraServer.h"
+#include "SolidAxle.h"
+#include "SteeringServo.h"
+#include "RemoteControl.h"
+#include "Metrics.h"
+#include "Scheduler.h"
+
+// =============================================================================
+// BENCHMARK PARAMETERS
+// =============================================================================
+
+const int BENCH_REPORT_MS = 1000; ///< CSV row period
+const int BENCH_MAX_CLIENTS = 4;  ///< Stream clients listed per row
+
+// =============================================================================
+// SERVICES (Same wiring as src/main.cpp)
+// =============================================================================
+
+NetworkManager network;
+CameraServer camera;
+SolidAxle motors(PIN_MOTOR_FWD, PIN_MOTOR_REV, PIN_MOTOR_PWM);
+SteeringServo steering(PIN_SERVO, STEERING_CENTER, STEERING_LEFT_MAX, STEERING_RIGHT_MAX);
+RemoteControl remote(&motors, &steering);
+Scheduler scheduler;
+
+static void onControlEvent(void *ctx)
+{
+    remote.listen();
+}
+
+static uint32_t failsafeTimer(void *ctx)
+{
+    remote.checkFailsafe();
+    return remote.msUntilFailsafe();
+}
+
+static void controlTask(void *arg)
+{
+    while (true)
+    {
+        scheduler.wait();
+        int64_t loopStart = esp_timer_get_time();
+        Metrics::loopIterations.inc();
+        scheduler.dispatch();
+        Metrics::loopUs.observe((uint32_t)(esp_timer_get_time() - loopStart));
+    }
+}
+
+// =============================================================================
+// HISTOGRAM DELTAS
+// =============================================================================
+
+/**
+ * @brief Bucket counts of a histogram at the previous report.
+ */
+struct HistogramSnapshot
+{
+    uint32_t buckets[Histogram::MAX_BUCKETS + 1];
+};
+
+/**
+ * @brief Observations since the last snapshot, and refreshes the snapshot.
+ * @param delta Output: per-bucket counts in this period.
+ * @return Number of observations in this period.
+ */
+static uint32_t takeDelta(const Histogram &h, HistogramSnapshot &prev, uint32_t *delta)
+{
+    uint32_t total = 0;
+    for (int i = 0; i <= h.numBounds(); i++)
+    {
+        uint32_t now = h.bucket(i);
+        delta[i] = now - prev.buckets[i];
+        prev.buckets[i] = now;
+        total += delta[i];
+    }
+    return total;
+}
+
+/**
+ * @brief Nearest-rank percentile over bucket counts.
+ * @return Upper bound of the bucket holding the rank, -1 for "+Inf", 0 if empty.
+ */
+static long bucketPct(const Histogram &h, const uint32_t *delta, uint32_t total, int p)
+{
+    if (total == 0)
+        return 0;
+    uint32_t rank = (uint32_t)(((uint64_t)total * p + 99) / 100);
+    uint32_t cumulative = 0;
+    for (int i = 0; i < h.numBounds(); i++)
+    {
+        cumulative += delta[i];
+        if (cumulative >= rank)
+            return (long)h.bound(i);
+    }
+    return -1;
+}
+
+// =============================================================================
+// REPORT TASK
+// =============================================================================
+
+/**
+ * @brief Prints one CSV row every BENCH_REPORT_MS (TASK_TELEMETRY placement).
+ */
+static void reportTask(void *arg)
+{
+    static HistogramSnapshot applySnap, loopSnap;
+    uint32_t applyDelta[Histogram::MAX_BUCKETS + 1];
+    uint32_t loopDelta[Histogram::MAX_BUCKETS + 1];
+
+    // Previous per-client frame counters (matched by fd)
+    StreamClientStats clients[BENCH_MAX_CLIENTS];
+    StreamClientStats prevClients[BENCH_MAX_CLIENTS];
+    int prevCount = 0;
+
+    uint32_t prevRx = Metrics::udpReceived.get();
+    uint32_t prevRejected = Metrics::udpRejected.get();
+    uint32_t prevFailsafe = Metrics::failsafeTrips.get();
+    uint32_t prevCaptured = Metrics::framesCaptured.get();
+    uint32_t prevSent = Metrics::framesSent.get();
+    uint32_t prevWs = Metrics::wsFramesSent.get();
+    takeDelta(Metrics::controlApplyUs, applySnap, applyDelta);
+    takeDelta(Metrics::loopUs, loopSnap, loopDelta);
+
+    char line[256];
+    TickType_t lastWake = xTaskGetTickCount();
+    int64_t lastUs = esp_timer_get_time();
+
+    Serial.println("t_s,rx_pps,rejected,failsafe,apply_n,apply_p50_us,apply_p90_us,apply_p99_us,"
+                   "loop_p99_us,capture_fps,stream_fps,ws_fps,clients,per_client_fps");
+
+    while (true)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(BENCH_REPORT_MS));
+        int64_t nowUs = esp_timer_get_time();
+        float dt = (float)(nowUs - lastUs) / 1000000.0f;
+        lastUs = nowUs;
+
+        // 1. COUNTER DELTAS
+        uint32_t rx = Metrics::udpReceived.get();
+        uint32_t rejected = Metrics::udpRejected.get();
+        uint32_t failsafe = Metrics::failsafeTrips.get();
+        uint32_t captured = Metrics::framesCaptured.get();
+        uint32_t sent = Metrics::framesSent.get();
+        uint32_t ws = Metrics::wsFramesSent.get();
+
+        uint32_t applyN = takeDelta(Metrics::controlApplyUs, applySnap, applyDelta);
+        uint32_t loopN = takeDelta(Metrics::loopUs, loopSnap, loopDelta);
+
+        int len = snprintf(line, sizeof(line), "%lu,%.0f,%u,%u,%u,%ld,%ld,%ld,%ld,%.1f,%.1f,%.1f,",
+                           (unsigned long)(nowUs / 1000000), (rx - prevRx) / dt,
+                           rejected - prevRejected, failsafe - prevFailsafe, applyN,
+                           bucketPct(Metrics::controlApplyUs, applyDelta, applyN, 50),
+                           bucketPct(Metrics::controlApplyUs, applyDelta, applyN, 90),
+                           bucketPct(Metrics::controlApplyUs, applyDelta, applyN, 99),
+                           bucketPct(Metrics::loopUs, loopDelta, loopN, 99),
+                           (captured - prevCaptured) / dt, (sent - prevSent) / dt, (ws - prevWs) / dt);
+
+        prevRx = rx;
+        prevRejected = rejected;
+        prevFailsafe = failsafe;
+        prevCaptured = captured;
+        prevSent = sent;
+        prevWs = ws;
+
+        // 2. PER-CLIENT FRAME RATE (new clients count from 0)
+        int count = CameraServer::getStreamStats(clients, BENCH_MAX_CLIENTS);
+        len += snprintf(line + len, sizeof(line) - len, "%d,", count);
+        for (int i = 0; i < count && len < (int)sizeof(line); i++)
+        {
+            uint32_t before = 0;
+            for (int j = 0; j < prevCount; j++)
+            {
+                if (prevClients[j].fd == clients[i].fd && prevClients[j].frames <= clients[i].frames)
+                    before = prevClients[j].frames;
+            }
+            len += snprintf(line + len, sizeof(line) - len, "%s%d:%.1f", i ? "|" : "",
+                            clients[i].fd, (clients[i].frames - before) / dt);
+        }
+        memcpy(prevClients, clients, sizeof(StreamClientStats) * count);
+        prevCount = count;
+
+        Serial.println(line);
+    }
+}
+
+// =============================================================================
+// SETUP / LOOP
+// =============================================================================
+
+void setup()
+{
+    // 1. Power Management: Disable Brownout Detector
+    WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
+
+    // 2. Start serial port
+    Serial.begin(LOG_BAUD);
+    Serial.println("\n[BOOT] Network Capacity Benchmark");
+
+    // 3. Actuators (neutral), camera, network
+    motors.begin();
+    steering.begin();
+    steering.center();
+
+    if (!camera.init())
+    {
+        Serial.println("[ERROR] Camera not detected. Benchmark aborted.");
+        while (true)
+            delay(1000);
+    }
+    network.begin();
+
+    // 4. Services
+    camera.startServer();
+    camera.addEndpoint("/metrics", HTTP_GET, Metrics::httpHandler);
+    remote.begin();
+    camera.setControlSink([](const uint8_t *frame, size_t len)
+                          { remote.submit(frame, len); scheduler.wake(); });
+
+    scheduler.begin();
+    scheduler.addReadable("udp_control", remote.getSocket(), onControlEvent, NULL);
+    scheduler.onWake(onControlEvent, NULL);
+    scheduler.addTimer("failsafe", failsafeTimer, NULL, UDP_FAILSAFE_MS);
+
+    xTaskCreatePinnedToCore(controlTask, "control", TASK_CONTROL.stack, NULL,
+                            TASK_CONTROL.priority, NULL, TASK_CONTROL.core);
+
+    Serial.printf("[INFO] Control: %s:%d | Stream: http://%s/stream | Metrics: http://%s/metrics\n",
+                  network.getIP(), UDP_PORT, network.getIP(), network.getIP());
+    Serial.println("[INFO] Waiting for tools.load_generator...");
+
+    // 5. Report (telemetry placement, larger stack: float formatting + row buffer)
+    xTaskCreatePinnedToCore(reportTask, "report", 4096, NULL,
+                            TASK_TELEMETRY.priority, NULL, TASK_TELEMETRY.core);
+}
+
+void loop()
+{
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file bench_protocol.cpp
+ * @brief Host Benchmark - Control Codec Round Trip and Throughput.
+ * @author Alejandro Moyano (@AleSMC)
+ *
+ * @details
+ * Compiles 'include/control_protocol.h' exactly as the firmware does and:
+ * 1. Verifies encode -> PacketView round trips for every traction/steering
+ *    pair and every probe length (0..PROBE_MAX), plus the rejection rules
+ *    (short packets, oversized probes, small output buffers).
+ * 2. Measures encode + decode throughput (packets per second) on a batch of
+ *    pre-built commands, the figure that bounds how fast a host tool can
+ *    generate load with the shared codec.
+ *
+ * Exits with status 1 on the first mismatch, so it doubles as a pre-flash check
+ * after touching the layout.
+ *
+ * =================================================================================
+ * @section execution Build & Run (Host, Linux/macOS)
+ * =================================================================================
+ *
+ * 1. BUILD (From 'firmware/'):
+ * $ g++ -O2 -std=c++11 -I include host/bench_protocol.cpp -o bench_protocol
+ *
+ * 2. RUN:
+ * $ ./bench_protocol
+ *
+ * 3. VERIFICATION:
+ * - "[BENCH] Round trip OK" with the number of packets checked.
+ * - Throughput in the hundreds of Mpkt/s: the codec is a few byte moves,
+ *   never the bottleneck next to a sendto().
+ * - Python side: 'python -m tools.gen_protocol --check' (from 'software/').
+ * =================================================================================
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "control_protocol.h"
+
+using namespace ControlProtocol;
+
+const int BATCH = 4096;      ///< Commands per benchmark pass (fits in L1/L2)
+const int PASSES = 20000;    ///< Benchmark passes (timer resolution)
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Reports a failed check and exits.
+ */
+static void fail(const char *what, int traction, int steering, size_t probeLen)
+{
+    fprintf(stderr, "[BENCH] FAIL: %s (traction %d, steering %d, probe %zu)\n",
+            what, traction, steering, probeLen);
+    exit(1);
+}
+
+/**
+ * @brief Exhaustive round trip over the whole command space.
+ * @return Packets checked.
+ */
+static long roundTrip()
+{
+    uint8_t probe[PROBE_MAX];
+    uint8_t packet[PACKET_MAX];
+    long checked = 0;
+
+    for (size_t len = 0; len <= PROBE_MAX; len++)
+    {
+        for (int t = 0; t < 256; t++)
+        {
+            for (int s = 0; s < 256; s++)
+            {
+                for (size_t i = 0; i < len; i++)
+                    probe[i] = (uint8_t)(t * 31 + s * 7 + i);
+
+                size_t n = encode(packet, sizeof(packet), (uint8_t)t, (uint8_t)s, len ? probe : nullptr, len);
+                if (n != COMMAND_SIZE + len)
+                    fail("encoded size", t, s, len);
+
+                PacketView view(packet, n);
+                if (!view.valid() || view.traction() != t || view.steering() != s)
+                    fail("command fields", t, s, len);
+                if (view.probeSize() != len || (len && memcmp(view.probe(), probe, len) != 0))
+                    fail("probe token", t, s, len);
+                if (!len && view.probe() != nullptr)
+                    fail("empty probe must be null", t, s, len);
+                checked++;
+            }
+        }
+    }
+
+    // Rejection rules
+    if (PacketView(packet, COMMAND_SIZE - 1).valid() || PacketView(nullptr, COMMAND_SIZE).valid())
+        fail("short/null packet accepted", 0, 0, 0);
+    if (encode(packet, sizeof(packet), 0, 0, probe, PROBE_MAX + 1) != 0)
+        fail("oversized probe accepted", 0, 0, PROBE_MAX + 1);
+    if (encode(packet, COMMAND_SIZE + 3, 0, 0, probe, 4) != 0)
+        fail("small output buffer accepted", 0, 0, 4);
+    if (encode(packet, sizeof(packet), 0, 0, nullptr, 2) != 0)
+        fail("null probe with length accepted", 0, 0, 2);
+
+    return checked;
+}
+
+int main()
+{
+    // 1. CORRECTNESS
+    long checked = roundTrip();
+    printf("[BENCH] Round trip OK: %ld packets (all commands x probe 0..%zu)\n", checked, PROBE_MAX);
+
+    // 2. THROUGHPUT (encode into a ring of buffers, decode back, fold the fields)
+    std::vector<uint8_t> cmds(BATCH * 2);
+    for (int i = 0; i < BATCH; i++)
+    {
+        cmds[2 * i] = (uint8_t)(i * 13);
+        cmds[2 * i + 1] = (uint8_t)(i % (STEERING_MAX + 1));
+    }
+    std::vector<uint8_t> wire(BATCH * PACKET_MAX);
+    const uint8_t token[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    const size_t probeLens[] = {0, sizeof(token)};
+    for (size_t probeLen : probeLens)
+    {
+        volatile uint32_t sink = 0; // Keeps the loop from being folded away
+        Clock::time_point t0 = Clock::now();
+        for (int p = 0; p < PASSES; p++)
+        {
+            uint32_t acc = 0;
+            for (int i = 0; i < BATCH; i++)
+            {
+                uint8_t *slot = &wire[i * PACKET_MAX];
+                size_t n = encode(slot, PACKET_MAX, cmds[2 * i], cmds[2 * i + 1], probeLen ? token : nullptr, probeLen);
+                PacketView view(slot, n);
+                acc += view.traction() + view.steering() + (uint32_t)view.probeSize();
+            }
+            sink = sink + acc;
+        }
+        double s = std::chrono::duration<double>(Clock::now() - t0).count();
+        double packets = (double)PASSES * BATCH;
+        printf("[BENCH] probe %zu B: %.1f Mpkt/s encode+decode (%.2f ns/pkt)\n",
+               probeLen, packets / s / 1e6, s * 1e9 / packets);
+    }
+    return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file bench_vision.cpp
+ * @brief Host Benchmark - Obstacle Detector Kernels on Recorded Frames.
+ * @author Alejandro Moyano (@AleSMC)
+ *
+ * @details
+ * Runs the exact kernels of 'lib/ObstacleDetector/VisionKernels.h' on a
+ * sequence of recorded JPEG frames, decoded at 1/8 scale like on the rover
+ * (libjpeg scale_denom = 8 here, ROM TJpgDec scale 3 there: both keep only
+ * the DC coefficient of each 8x8 block).
+ *
+ * Prints one CSV row per frame with the scores the rover would compute
+ * (edge density, motion, resulting level with the config.h thresholds), then
+ * a summary with kernel throughput. Use it to tune VISION_* on real footage
+ * and to check the kernel cost before flashing.
+ *
+ * frame,width,height,edges_q8,motion_q8,level,decode_us,kernel_us
+ *
+ * =================================================================================
+ * @section execution Build & Run (Host, Linux/macOS with libjpeg)
+ * =================================================================================
+ *
+ * 1. RECORD FRAMES (rover streaming, from the PC):
+ * $ mkdir frames && cd frames
+ * $ ffmpeg -i http://<ROVER_IP>/stream -frames:v 300 -q:v 5 %04d.jpg
+ *
+ * 2. BUILD (From 'firmware/'):
+ * $ g++ -O2 -std=c++11 -I lib/ObstacleDetector host/bench_vision.cpp -ljpeg -o bench_vision
+ *
+ * 3. RUN:
+ * $ ./bench_vision frames/0*.jpg > vision.csv
+ * - Without arguments a synthetic sequence (textured floor, looming block) is used.
+ *
+ * 4. VERIFICATION:
+ * - 'level' must go to 1/2 only where an obstacle fills the lower image.
+ * - Kernel time per frame should be a few us here; the rover's '/vision'
+ *   endpoint reports the on-target figure (kernel_us).
+ * =================================================================================
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <jpeglib.h>
+#include "VisionKernels.h"
+
+// Thresholds: keep in sync with section 8 of include/config.h
+const int VISION_ROI_START_PCT = 60;
+const int VISION_DIFF_THRESHOLD = 24;
+const int VISION_EDGE_THRESHOLD = 40;
+const int VISION_EDGE_SLOW_Q8 = 64;
+const int VISION_EDGE_STOP_Q8 = 115;
+const int VISION_MOTION_LOOM_Q8 = 51;
+
+const int KERNEL_REPEAT = 1000; ///< Kernel runs per frame (timer resolution)
+const int SYNTH_FRAMES = 60;    ///< Synthetic sequence length
+
+typedef std::chrono::steady_clock Clock;
+
+/** @brief One decoded luma frame. */
+struct Frame
+{
+    int width;
+    int height;
+    std::vector<uint8_t> luma;
+};
+
+/**
+ * @brief Decodes a JPEG file at 1/8 scale into luma (same weights as the rover).
+ */
+static bool decodeFile(const char *path, Frame &out)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+
+    jpeg_decompress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_decompress(&cinfo);
+    jpeg_stdio_src(&cinfo, f);
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = 8;
+    cinfo.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&cinfo);
+
+    out.width = cinfo.output_width;
+    out.height = cinfo.output_height;
+    out.luma.resize(out.width * out.height);
+    std::vector<uint8_t> row(out.width * 3);
+    while (cinfo.output_scanline < cinfo.output_height)
+    {
+        uint8_t *rowPtr = row.data();
+        int y = cinfo.output_scanline;
+        jpeg_read_scanlines(&cinfo, &rowPtr, 1);
+        for (int x = 0; x < out.width; x++)
+            out.luma[y * out.width + x] = VisionKernels::luma(row[3 * x], row[3 * x + 1], row[3 * x + 2]);
+    }
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Synthetic QVGA/8 frame: checkered floor drifting down, plus a block
+ * that grows from frame SYNTH_FRAMES/2 (obstacle getting closer).
+ */
+static void synthFrame(int i, Frame &out)
+{
+    out.width = 40;
+    out.height = 30;
+    out.luma.assign(out.width * out.height, 0);
+    for (int y = 0; y < out.height; y++)
+    {
+        for (int x = 0; x < out.width; x++)
+        {
+            // Soft floor texture: low gradient, slow drift
+            out.luma[y * out.width + x] = (uint8_t)(100 + ((x / 4 + (y + i) / 4) & 1) * 12);
+        }
+    }
+    int size = i - SYNTH_FRAMES / 2;
+    if (size > 0)
+    {
+        int half = size > out.width / 2 ? out.width / 2 : size;
+        for (int y = out.height - half; y < out.height; y++)
+        {
+            for (int x = out.width / 2 - half; x < out.width / 2 + half; x++)
+            {
+                // High-contrast stripes: the obstacle's edges
+                out.luma[y * out.width + x] = ((x + y + i) & 1) ? 230 : 20;
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc > 1 ? argc - 1 : SYNTH_FRAMES;
+    Frame prev, cur;
+    bool havePrev = false;
+    double kernelTotalUs = 0;
+    long pixelsTotal = 0;
+    int scored = 0;
+
+    printf("frame,width,height,edges_q8,motion_q8,level,decode_us,kernel_us\n");
+
+    for (int i = 0; i < count; i++)
+    {
+        // 1. DECODE
+        Clock::time_point t0 = Clock::now();
+        if (argc > 1)
+        {
+            if (!decodeFile(argv[i + 1], cur))
+            {
+                fprintf(stderr, "[BENCH] Cannot read %s\n", argv[i + 1]);
+                continue;
+            }
+        }
+        else
+        {
+            synthFrame(i, cur);
+        }
+        double decodeUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+
+        if (havePrev && (prev.width != cur.width || prev.height != cur.height))
+            havePrev = false;
+
+        // 2. KERNELS (repeated: one run is below the timer resolution)
+        int w = cur.width, h = cur.height;
+        int y0 = (h * VISION_ROI_START_PCT) / 100;
+        uint32_t edges = 0, moved = 0;
+        volatile uint32_t sink = 0; // Keeps the repeated calls from being folded
+        t0 = Clock::now();
+        for (int r = 0; r < KERNEL_REPEAT; r++)
+        {
+            edges = VisionKernels::edgeCount(cur.luma.data(), w, h, y0, h, VISION_EDGE_THRESHOLD);
+            if (havePrev)
+                moved = VisionKernels::diffCount(cur.luma.data(), prev.luma.data(), w, y0, h, VISION_DIFF_THRESHOLD);
+            sink = sink + edges + moved;
+        }
+        double kernelUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / KERNEL_REPEAT;
+
+        // 3. SCORES AND LEVEL (same rules as ObstacleDetector::evaluate, without hysteresis)
+        uint16_t edgeQ8 = VisionKernels::ratioQ8(edges, (uint32_t)(h - 1 - y0) * (w - 1));
+        uint16_t motionQ8 = havePrev ? VisionKernels::ratioQ8(moved, (uint32_t)(h - y0) * w) : 0;
+        int level = 0;
+        if (edgeQ8 >= VISION_EDGE_STOP_Q8 && motionQ8 >= VISION_MOTION_LOOM_Q8)
+            level = 2;
+        else if (edgeQ8 >= VISION_EDGE_SLOW_Q8)
+            level = 1;
+
+        printf("%d,%d,%d,%u,%u,%d,%.1f,%.3f\n", i, w, h, edgeQ8, motionQ8, level, decodeUs, kernelUs);
+
+        kernelTotalUs += kernelUs;
+        pixelsTotal += (long)(h - y0) * w;
+        scored++;
+        std::swap(prev, cur);
+        havePrev = true;
+    }
+
+    if (scored > 0)
+    {
+        fprintf(stderr, "[BENCH] %d frames | kernels %.3f us/frame | %.1f Mpix/s (ROI, both kernels)\n",
+                scored, kernelTotalUs / scored, pixelsTotal / kernelTotalUs);
+    }
+    return 0;
+}
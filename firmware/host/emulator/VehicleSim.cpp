@@ -0,0 +1,156 @@
+/**
+ * @file VehicleSim.cpp
+ * @brief Traction/Steering Response, Bicycle Kinematics and FPV Floor Renderer.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "VehicleSim.h"
+#include "config.h"
+#include "EmuHw.h"
+
+// --- MODEL PARAMETERS (1:16 TT-motor chassis) ---
+static const int SIM_RATE_HZ = 100;
+static const float WHEELBASE_M = 0.15f;
+static const float SPEED_MAX_MS = 1.2f;    ///< Full duty, no load
+static const float TAU_DRIVE_S = 0.40f;    ///< Motor + inertia
+static const float TAU_BRAKE_S = 0.15f;    ///< L298N short brake
+static const float TAU_COAST_S = 2.0f;     ///< Rolling friction only
+static const float SERVO_RATE_DPS = 500.0f; ///< 60 deg / 0.12 s
+
+// --- CAMERA (OV2640 stock lens on the chassis) ---
+static const float CAM_HEIGHT_M = 0.10f;
+static const float CAM_PITCH_RAD = 0.20f; ///< Tilted down
+static const float CAM_HFOV_RAD = 1.15f;  ///< ~66 deg
+static const float TILE_M = 0.25f;
+
+VehicleState VehicleSim::_state = {0, 0, 0, 0, 0, 0};
+float VehicleSim::_servoDeg = STEERING_CENTER;
+portMUX_TYPE VehicleSim::_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void VehicleSim::begin()
+{
+    xTaskCreatePinnedToCore(simTask, "vehicle_sim", 4096, NULL, 1, NULL, 0);
+    Serial.printf("[SIM] Vehicle model running at %d Hz (wheelbase %.2f m, %.1f m/s max)\n",
+                  SIM_RATE_HZ, WHEELBASE_M, SPEED_MAX_MS);
+}
+
+VehicleState VehicleSim::state()
+{
+    portENTER_CRITICAL(&_lock);
+    VehicleState s = _state;
+    portEXIT_CRITICAL(&_lock);
+    return s;
+}
+
+void VehicleSim::step(float dt)
+{
+    // 1. TRACTION (L298N truth table)
+    bool fwd = EmuHw::pinLevel[PIN_MOTOR_FWD] == HIGH;
+    bool rev = EmuHw::pinLevel[PIN_MOTOR_REV] == HIGH;
+    float duty = EmuHw::ledcLevel(MOTOR_PWM_CHANNEL);
+
+    float target = 0.0f;
+    float tau = TAU_COAST_S;
+    if (fwd != rev)
+    {
+        target = (fwd ? 1.0f : -1.0f) * SPEED_MAX_MS * duty;
+        tau = TAU_DRIVE_S;
+    }
+    else if (duty > 0.5f)
+    {
+        tau = TAU_BRAKE_S; // Both inputs equal with EN high: motor terminals shorted
+    }
+
+    // 2. STEERING (servo horn follows the pulse at a finite rate)
+    int us = EmuHw::servoUs[PIN_SERVO];
+    if (us > 0)
+    {
+        float cmd = (us - 500) * 180.0f / 1900.0f;
+        float maxStep = SERVO_RATE_DPS * dt;
+        _servoDeg += constrain(cmd - _servoDeg, -maxStep, maxStep);
+    }
+
+    // 3. KINEMATICS
+    portENTER_CRITICAL(&_lock);
+    VehicleState &s = _state;
+    s.speed += (target - s.speed) * dt / tau;
+    s.steerDeg = STEERING_CENTER - _servoDeg;
+    float delta = s.steerDeg * (float)M_PI / 180.0f;
+    s.x += s.speed * cosf(s.yaw) * dt;
+    s.y += s.speed * sinf(s.yaw) * dt;
+    s.yaw += s.speed * tanf(delta) / WHEELBASE_M * dt;
+    s.yaw = remainderf(s.yaw, 2.0f * (float)M_PI);
+    s.odometer += fabsf(s.speed) * dt;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void VehicleSim::simTask(void *arg)
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(1000 / SIM_RATE_HZ));
+        step(1.0f / SIM_RATE_HZ);
+    }
+}
+
+void VehicleSim::render(uint8_t *rgb, int width, int height, uint32_t frame)
+{
+    VehicleState s = state();
+    float focal = (width / 2.0f) / tanf(CAM_HFOV_RAD / 2.0f);
+    float cp = cosf(CAM_PITCH_RAD), sp = sinf(CAM_PITCH_RAD);
+    float cy = cosf(s.yaw), sy = sinf(s.yaw);
+
+    for (int v = 0; v < height; v++)
+    {
+        uint8_t *row = rgb + (size_t)v * width * 3;
+
+        // 1. ROW RAY (camera: forward 1, down ny) rotated by the pitch
+        float ny = (v - height / 2.0f) / focal;
+        float down = ny * cp + sp;
+        float ahead = cp - ny * sp;
+        if (down <= 1e-4f)
+        {
+            // Sky: horizon-to-zenith gradient
+            uint8_t b = (uint8_t)constrain(200 + (int)(ny * 120), 120, 230);
+            for (int u = 0; u < width; u++)
+            {
+                row[u * 3] = b / 2;
+                row[u * 3 + 1] = (uint8_t)(b * 3 / 4);
+                row[u * 3 + 2] = b;
+            }
+            continue;
+        }
+
+        // 2. FLOOR: one ray/plane hit per pixel, checker + distance haze
+        float t = CAM_HEIGHT_M / down;
+        float dist = t * ahead;
+        int haze = constrain((int)(t * 24.0f), 0, 200);
+        for (int u = 0; u < width; u++)
+        {
+            float right = t * (u - width / 2.0f) / focal;
+            float wx = s.x + dist * cy + right * sy;
+            float wy = s.y + dist * sy - right * cy;
+            bool dark = ((int)floorf(wx / TILE_M) + (int)floorf(wy / TILE_M)) & 1;
+            int grey = dark ? 40 : 210;
+            uint8_t *p = row + u * 3;
+            p[0] = (uint8_t)(grey + (160 - grey) * haze / 255);
+            p[1] = (uint8_t)(grey + (170 - grey) * haze / 255);
+            p[2] = (uint8_t)(grey + (180 - grey) * haze / 255);
+        }
+    }
+}
+
+esp_err_t VehicleSim::httpHandler(httpd_req_t *req)
+{
+    VehicleState s = state();
+    char json[384];
+    snprintf(json, sizeof(json),
+             "{\"x\":%.3f,\"y\":%.3f,\"heading_deg\":%.1f,\"speed\":%.3f,\"steer_deg\":%.1f,"
+             "\"odometer\":%.2f,\"motor\":{\"fwd\":%d,\"rev\":%d,\"duty\":%.3f},\"servo_us\":%d}",
+             s.x, s.y, s.yaw * 180.0f / (float)M_PI, s.speed, s.steerDeg, s.odometer,
+             EmuHw::pinLevel[PIN_MOTOR_FWD].load(), EmuHw::pinLevel[PIN_MOTOR_REV].load(),
+             EmuHw::ledcLevel(MOTOR_PWM_CHANNEL), EmuHw::servoUs[PIN_SERVO].load());
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, json);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file VehicleSim.h
+ * @brief Host Emulator - Bicycle-Model Rover Driven by the Firmware's Actuator Outputs.
+ * @author Alejandro Moyano (@AleSMC)
+ * @details
+ * Reads what SolidAxle and SteeringServo write (EmuHw: L298N direction pins,
+ * LEDC duty, servo pulse) and integrates a kinematic bicycle model at
+ * SIM_RATE_HZ:
+ * - Traction: first-order speed response per L298N state (drive, brake with
+ *   both inputs low and EN high, coast with EN low).
+ * - Steering: servo angle rate-limited like a 0.12 s/60 deg micro servo;
+ *   wheel angle = STEERING_CENTER - servo angle (left positive).
+ * - Pose: x' = v cos(yaw), y' = v sin(yaw), yaw' = v tan(delta) / L.
+ *
+ * The pose feeds the synthetic camera (render(): checkerboard floor seen from
+ * the rover's FPV camera) and '/sim' (JSON), so a pilot closes the loop
+ * through the real firmware exactly as on the floor.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "esp_http_server.h"
+
+/** @brief Simulated vehicle state (SI units, world frame). */
+struct VehicleState
+{
+    float x;        ///< m
+    float y;        ///< m
+    float yaw;      ///< rad, counter-clockwise
+    float speed;    ///< m/s, negative = reverse
+    float steerDeg; ///< Front wheel angle, left positive
+    float odometer; ///< Distance travelled (m)
+};
+
+class VehicleSim
+{
+public:
+    /**
+     * @brief Starts the integration thread.
+     */
+    static void begin();
+
+    /** @brief Consistent copy of the current state. */
+    static VehicleState state();
+
+    /**
+     * @brief EmuHw::SceneFn: FPV view of the floor from the current pose.
+     */
+    static void render(uint8_t *rgb, int width, int height, uint32_t frame);
+
+    /**
+     * @brief '/sim': state and raw actuator inputs as JSON.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+
+private:
+    /**
+     * @brief One integration step of dt seconds.
+     */
+    static void step(float dt);
+
+    static void simTask(void *arg);
+
+    static VehicleState _state;
+    static float _servoDeg; ///< Servo horn angle (rate-limited)
+    static portMUX_TYPE _lock;
+};
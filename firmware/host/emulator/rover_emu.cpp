@@ -0,0 +1,229 @@
+/**
+ * @file rover_emu.cpp
+ * @brief Host Emulator - The Rover's Firmware Services on a PC (POSIX Sockets).
+ * @author Alejandro Moyano (@AleSMC)
+ * @details
+ * Compiles the unmodified CameraServer, CameraProfiles, RemoteControl,
+ * NetworkManager, SolidAxle, SteeringServo, Scheduler, Metrics and EventLog
+ * sources against the shims in 'shim/' (FreeRTOS on threads, lwIP on POSIX
+ * sockets, esp_http_server, a timed OV2640 model) and closes the loop with
+ * VehicleSim: UDP packets on UDP_PORT steer a simulated chassis whose FPV
+ * view comes back on '/stream'. The Python client works unchanged against
+ * 127.0.0.1.
+ *
+ * Not compiled in: PowerGovernor (no die sensor / brown-out comparator),
+ * ParamRegistry, WebUI (no LittleFS), TaskMonitor, HeapAudit, vision, and
+ * '/ws' (the shim server has no WebSocket support). mDNS is not announced.
+ *
+ * @note --- BUILD AND RUN (from 'firmware/', needs libjpeg) ---
+ *   LIBS="CameraServer CameraProfiles RemoteControl NetworkManager SolidAxle SteeringServo Metrics EventLog Scheduler"
+ *   g++ -O2 -std=gnu++11 -pthread -D MDNS_NAME=\"rover\" -I host/emulator/shim -I include \
+ *       $(for d in lib/[A-Z]*; do printf -- '-I %s ' $d; done) \
+ *       host/emulator/rover_emu.cpp host/emulator/VehicleSim.cpp host/emulator/shim/emu_*.cpp \
+ *       $(for m in $LIBS; do echo lib/$m/$m.cpp; done) -ljpeg -o rover_emu
+ *   ./rover_emu --http-port 8080
+ */
+
+#include <Arduino.h>
+#include <getopt.h>
+
+#include "config.h"
+#include "NetworkManager.h"
+#include "CameraServer.h"
+#include "CameraProfiles.h"
+#include "SolidAxle.h"
+#include "SteeringServo.h"
+#include "RemoteControl.h"
+#include "Scheduler.h"
+#include "Metrics.h"
+#include "EventLog.h"
+#include "EmuHw.h"
+#include "VehicleSim.h"
+
+// =============================================================================
+// GLOBAL INSTANCES (same wiring as src/main.cpp)
+// =============================================================================
+
+NetworkManager network;
+CameraServer camera;
+SolidAxle motors(PIN_MOTOR_FWD, PIN_MOTOR_REV, PIN_MOTOR_PWM);
+SteeringServo steering(PIN_SERVO, STEERING_CENTER, STEERING_LEFT_MAX, STEERING_RIGHT_MAX);
+RemoteControl remote(&motors, &steering);
+Scheduler scheduler;
+
+// =============================================================================
+// EVENT-DRIVEN SERVICES (as in src/main.cpp, minus the power governor)
+// =============================================================================
+
+static void onControlEvent(void *ctx)
+{
+    remote.listen();
+}
+
+static uint32_t failsafeTimer(void *ctx)
+{
+    remote.checkFailsafe();
+    return remote.msUntilFailsafe();
+}
+
+static uint32_t linkTimer(void *ctx)
+{
+    remote.updateLink(network.getRssi());
+    remote.checkFailsafe();
+    return LINK_UPDATE_MS;
+}
+
+static uint32_t networkTimer(void *ctx)
+{
+    network.update();
+    return NETWORK_UPDATE_MS;
+}
+
+static void controlTask(void *arg)
+{
+    while (true)
+    {
+        scheduler.wait();
+
+        int64_t loopStart = esp_timer_get_time();
+        Metrics::loopIterations.inc();
+
+        scheduler.dispatch();
+
+        Metrics::loopUs.observe((uint32_t)(esp_timer_get_time() - loopStart));
+    }
+}
+
+/**
+ * @brief Telemetry: the firmware's [ALIVE] line plus the simulated pose.
+ */
+static void telemetryTask(void *arg)
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    char line[160];
+
+    while (true)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(TELEMETRY_PERIOD_MS));
+
+        snprintf(line, sizeof(line), "[ALIVE] Mode: %s | IP: %s | Uptime: %lu s\n",
+                 network.getMode(), network.getIP(), millis() / 1000);
+        Serial.print(line);
+
+        VehicleState s = VehicleSim::state();
+        snprintf(line, sizeof(line), "[SIM] x %.2f m | y %.2f m | heading %.0f deg | %.2f m/s | steer %.0f deg | odo %.1f m\n",
+                 s.x, s.y, s.yaw * 180.0f / (float)M_PI, s.speed, s.steerDeg, s.odometer);
+        Serial.print(line);
+    }
+}
+
+// =============================================================================
+// COMMAND LINE
+// =============================================================================
+
+static void usage(const char *argv0)
+{
+    printf("Usage: %s [--http-port N] [--rssi DBM] [--frames DIR]\n"
+           "  --http-port N  HTTP port (default %d; below 1024 needs privileges)\n"
+           "  --rssi DBM     Pilot RSSI reported to the link governor (default %d, 0 = unknown)\n"
+           "  --frames DIR   Serve the *.jpg in DIR (name order, looped) instead of the simulated view\n",
+           argv0, HTTP_PORT, EmuHw::rssiDbm.load());
+}
+
+static bool parseArgs(int argc, char **argv)
+{
+    static const struct option OPTIONS[] = {
+        {"http-port", required_argument, NULL, 'p'},
+        {"rssi", required_argument, NULL, 'r'},
+        {"frames", required_argument, NULL, 'f'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}};
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:r:f:h", OPTIONS, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            EmuHw::httpPort = (uint16_t)atoi(optarg);
+            break;
+        case 'r':
+            EmuHw::rssiDbm = atoi(optarg);
+            break;
+        case 'f':
+            EmuHw::framesDir = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// =============================================================================
+// BOOT (src/main.cpp setup(), sequential)
+// =============================================================================
+
+int main(int argc, char **argv)
+{
+    if (!parseArgs(argc, argv))
+        return 1;
+    int httpPort = EmuHw::httpPort ? EmuHw::httpPort : HTTP_PORT;
+
+    Serial.begin(LOG_BAUD);
+    EventLog::begin();
+
+    // 1. ACTUATORS + VEHICLE (the sim reads what the drivers write)
+    Serial.println("\n[BOOT] Initializing Motors and Servo...");
+    motors.begin();
+    steering.begin();
+    steering.center();
+    VehicleSim::begin();
+
+    // 2. CAMERA (synthetic view unless recorded frames were given)
+    if (!EmuHw::framesDir)
+        EmuHw::scene = VehicleSim::render;
+    if (!camera.init())
+    {
+        Serial.println("[ERROR] Camera emulation failed to start.");
+        return 1;
+    }
+
+    // 3. NETWORK (loopback "station")
+    network.begin();
+
+    // 4. SERVICES
+    camera.startServer();
+    remote.begin();
+    camera.setControlSink([](const uint8_t *frame, size_t len)
+                          { remote.submit(frame, len); scheduler.wake(); });
+
+    scheduler.begin();
+    scheduler.addReadable("udp_control", remote.getSocket(), onControlEvent, NULL);
+    scheduler.onWake(onControlEvent, NULL);
+    scheduler.addTimer("failsafe", failsafeTimer, NULL, UDP_FAILSAFE_MS);
+    scheduler.addTimer("network", networkTimer, NULL, NETWORK_UPDATE_MS);
+    scheduler.addTimer("link", linkTimer, NULL, LINK_UPDATE_MS);
+
+    xTaskCreatePinnedToCore(controlTask, "control", TASK_CONTROL.stack, NULL,
+                            TASK_CONTROL.priority, NULL, TASK_CONTROL.core);
+    xTaskCreatePinnedToCore(telemetryTask, "telemetry", TASK_TELEMETRY.stack, NULL,
+                            TASK_TELEMETRY.priority, NULL, TASK_TELEMETRY.core);
+
+    camera.addEndpoint("/metrics", HTTP_GET, Metrics::httpHandler);
+    camera.addEndpoint("/profile", HTTP_GET, CameraProfiles::httpHandler);
+    camera.addEndpoint("/sim", HTTP_GET, VehicleSim::httpHandler);
+
+    Serial.println("\n[BOOT] EMULATOR ONLINE - ROVER READY.");
+    Serial.printf("[INFO] Video Stream: http://127.0.0.1:%d/stream\n", httpPort);
+    Serial.printf("[INFO] UDP Control:  127.0.0.1:%d\n", UDP_PORT);
+    Serial.printf("[INFO] Metrics:      http://127.0.0.1:%d/metrics\n", httpPort);
+    Serial.printf("[INFO] Cam Profile:  http://127.0.0.1:%d/profile?name=fpv\n", httpPort);
+    Serial.printf("[INFO] Still:        http://127.0.0.1:%d/still?size=UXGA\n", httpPort);
+    Serial.printf("[INFO] Vehicle:      http://127.0.0.1:%d/sim\n", httpPort);
+
+    // Everything runs in the firmware's tasks (Arduino loop() is deleted too)
+    while (true)
+        delay(1000);
+}
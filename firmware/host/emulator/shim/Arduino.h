@@ -0,0 +1,86 @@
+/**
+ * @file Arduino.h
+ * @brief Host Shim - The Subset of the ESP32 Arduino Core the Firmware Uses.
+ * @author Alejandro Moyano (@AleSMC)
+ * @details Time, GPIO/LEDC (recorded in EmuHw), Serial (stdout, binary
+ * EventLog records decoded to text) and IPAddress.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <netinet/in.h> // INADDR_NONE, as lwIP provides it to the core
+#include <algorithm>
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+using std::max;
+using std::min;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+double ledcChangeFrequency(uint8_t channel, double freq, uint8_t resolution_bits);
+
+bool psramFound();
+
+/**
+ * @brief stdout console. Lines from different tasks are not interleaved.
+ */
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud) {}
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char *s);
+    size_t println(const char *s = "");
+    size_t write(const uint8_t *buf, size_t len);
+};
+extern HardwareSerial Serial;
+
+/**
+ * @brief IPv4 address, byte 0 first in memory (same layout as the core).
+ */
+class IPAddress
+{
+private:
+    union
+    {
+        uint8_t bytes[4];
+        uint32_t dword;
+    } _address;
+
+public:
+    IPAddress() { _address.dword = 0; }
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+        _address.bytes[0] = a;
+        _address.bytes[1] = b;
+        _address.bytes[2] = c;
+        _address.bytes[3] = d;
+    }
+    IPAddress(uint32_t address) { _address.dword = address; }
+    operator uint32_t() const { return _address.dword; }
+    uint8_t operator[](int index) const { return _address.bytes[index]; }
+};
@@ -0,0 +1,28 @@
+/**
+ * @file ESP32Servo.h
+ * @brief Host Shim - Servo Pulses Recorded in EmuHw::servoUs.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+#include "Arduino.h"
+
+class Servo
+{
+private:
+    int _pin = -1;
+    int _minUs = 544;
+    int _maxUs = 2400;
+
+public:
+    void setPeriodHertz(int hertz) {}
+    int attach(int pin, int minUs, int maxUs);
+    void write(int value);
+    void writeMicroseconds(int us);
+};
+
+class ESP32PWM
+{
+public:
+    static void allocateTimer(int timerNumber) {}
+};
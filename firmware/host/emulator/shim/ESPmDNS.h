@@ -0,0 +1,18 @@
+/**
+ * @file ESPmDNS.h
+ * @brief Host Shim - mDNS Responder (records accepted, never announced).
+ * @author Alejandro Moyano (@AleSMC)
+ * @details Point the client at 127.0.0.1 (ROVER_IP) instead of discovery.
+ */
+
+#pragma once
+#include "Arduino.h"
+
+class MDNSResponder
+{
+public:
+    bool begin(const char *hostName) { return true; }
+    bool addService(const char *service, const char *proto, uint16_t port) { return true; }
+    bool addServiceTxt(const char *service, const char *proto, const char *key, const char *value) { return true; }
+};
+extern MDNSResponder MDNS;
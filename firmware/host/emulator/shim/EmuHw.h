@@ -0,0 +1,41 @@
+/**
+ * @file EmuHw.h
+ * @brief Emulated Board State (Pins, LEDC, Servo Pulses, Radio, Camera Source).
+ * @author Alejandro Moyano (@AleSMC)
+ * @details
+ * What the shims write instead of touching hardware, and what the vehicle
+ * simulation and the emulator front-end read back. Everything is atomic: the
+ * firmware tasks write, the simulation thread samples.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+namespace EmuHw
+{
+    const int PIN_COUNT = 40;
+    const int LEDC_CHANNELS = 16;
+
+    // --- OUTPUTS (written by the firmware through the Arduino shims) ---
+    extern std::atomic<int> pinLevel[PIN_COUNT];           ///< digitalWrite() level
+    extern std::atomic<uint32_t> ledcDuty[LEDC_CHANNELS];  ///< ledcWrite() raw duty
+    extern std::atomic<uint8_t> ledcBits[LEDC_CHANNELS];   ///< Resolution of each channel
+    extern std::atomic<int> servoUs[PIN_COUNT];            ///< Servo pulse width (us, 0 = detached)
+
+    // --- INPUTS (set by the emulator front-end) ---
+    extern std::atomic<int> rssiDbm;  ///< Reported pilot RSSI (0 = unknown)
+    extern uint16_t httpPort;         ///< Overrides httpd_config_t::server_port (0 = keep)
+    extern const char *framesDir;     ///< Recorded JPEGs served instead of the scene (NULL = scene)
+
+    /**
+     * @brief Scene renderer for the synthetic camera (RGB888, row-major).
+     * @details Called from the capturing task with the current sensor output
+     * size. NULL = built-in test pattern.
+     */
+    typedef void (*SceneFn)(uint8_t *rgb, int width, int height, uint32_t frame);
+    extern SceneFn scene;
+
+    /** @brief Duty of a LEDC channel as a fraction of full scale (0..1). */
+    float ledcLevel(int channel);
+}
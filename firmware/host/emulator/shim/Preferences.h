@@ -0,0 +1,22 @@
+/**
+ * @file Preferences.h
+ * @brief Host Shim - NVS Namespaces Kept in Memory (lost at exit).
+ * @author Alejandro Moyano (@AleSMC)
+ * @details Every emulator run is a first boot: the full association path.
+ */
+
+#pragma once
+#include "Arduino.h"
+
+class Preferences
+{
+private:
+    const char *_ns = NULL;
+
+public:
+    bool begin(const char *name, bool readOnly = false);
+    void end() { _ns = NULL; }
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+    size_t putBytes(const char *key, const void *value, size_t len);
+    bool remove(const char *key);
+};
@@ -0,0 +1,49 @@
+/**
+ * @file WiFi.h
+ * @brief Host Shim - Station That Always Associates (loopback address).
+ * @author Alejandro Moyano (@AleSMC)
+ * @details RSSI comes from EmuHw::rssiDbm ('--rssi'), so the link governor
+ * and the failsafe can be exercised without a radio.
+ */
+
+#pragma once
+#include "Arduino.h"
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2
+} wifi_mode_t;
+
+class WiFiClass
+{
+private:
+    wl_status_t _status = WL_DISCONNECTED;
+
+public:
+    void persistent(bool persistent) {}
+    bool mode(wifi_mode_t m) { return true; }
+    wl_status_t begin(const char *ssid, const char *pass, int32_t channel = 0,
+                      const uint8_t *bssid = NULL, bool connect = true);
+    bool config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns = IPAddress()) { return true; }
+    bool disconnect(bool wifioff = false);
+    wl_status_t status() { return _status; }
+    int8_t RSSI();
+    bool softAP(const char *ssid, const char *pass, int channel, int hidden, int maxConn) { return true; }
+    IPAddress softAPIP();
+    IPAddress localIP();
+    IPAddress gatewayIP() { return localIP(); }
+    IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+    IPAddress dnsIP(uint8_t n = 0) { return localIP(); }
+    uint8_t *BSSID();
+    int32_t channel() { return 1; }
+};
+extern WiFiClass WiFi;
@@ -0,0 +1,383 @@
+/**
+ * @file emu_arduino.cpp
+ * @brief Host Shim - Arduino Core, Radio, NVS and Heap Entry Points.
+ * @author Alejandro Moyano (@AleSMC)
+ * @details
+ * Outputs land in EmuHw (read by the vehicle simulation). Serial goes to
+ * stdout; binary EventLog records are decoded in place with the same table
+ * as 'tools.log_decoder', so the console reads like the decoder's output.
+ */
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include <Preferences.h>
+#include <ESP32Servo.h>
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_wifi.h"
+#include "log_events.h"
+#include "EmuHw.h"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// =============================================================================
+// EMULATED BOARD STATE
+// =============================================================================
+
+namespace EmuHw
+{
+    std::atomic<int> pinLevel[PIN_COUNT];
+    std::atomic<uint32_t> ledcDuty[LEDC_CHANNELS];
+    std::atomic<uint8_t> ledcBits[LEDC_CHANNELS];
+    std::atomic<int> servoUs[PIN_COUNT];
+    std::atomic<int> rssiDbm(-55);
+    uint16_t httpPort = 0;
+    const char *framesDir = NULL;
+    SceneFn scene = NULL;
+
+    /** @brief Pin -> LEDC channel (-1 = plain GPIO). */
+    static std::atomic<int> pinChannel[PIN_COUNT];
+    static bool pinChannelInit = []()
+    {
+        for (int i = 0; i < PIN_COUNT; i++)
+            pinChannel[i] = -1;
+        return true;
+    }();
+
+    float ledcLevel(int channel)
+    {
+        if (channel < 0 || channel >= LEDC_CHANNELS || ledcBits[channel] == 0)
+            return 0.0f;
+        return (float)ledcDuty[channel] / (float)((1u << ledcBits[channel]) - 1);
+    }
+}
+
+// =============================================================================
+// TIME
+// =============================================================================
+
+typedef std::chrono::steady_clock Clock;
+static const Clock::time_point bootTime = Clock::now();
+
+int64_t esp_timer_get_time()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - bootTime).count();
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)esp_timer_get_time();
+}
+
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// =============================================================================
+// GPIO / LEDC
+// =============================================================================
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    if (pin < EmuHw::PIN_COUNT)
+        EmuHw::pinLevel[pin] = val ? HIGH : LOW;
+}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits)
+{
+    if (channel >= EmuHw::LEDC_CHANNELS || resolution_bits == 0 || resolution_bits > 20)
+        return 0;
+    EmuHw::ledcBits[channel] = resolution_bits;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel)
+{
+    if (pin < EmuHw::PIN_COUNT)
+        EmuHw::pinChannel[pin] = channel;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty)
+{
+    if (channel < EmuHw::LEDC_CHANNELS)
+        EmuHw::ledcDuty[channel] = duty;
+}
+
+double ledcChangeFrequency(uint8_t channel, double freq, uint8_t resolution_bits)
+{
+    return ledcSetup(channel, freq, resolution_bits);
+}
+
+bool psramFound()
+{
+    return true;
+}
+
+// =============================================================================
+// SERVO
+// =============================================================================
+
+int Servo::attach(int pin, int minUs, int maxUs)
+{
+    _pin = pin;
+    _minUs = minUs;
+    _maxUs = maxUs;
+    return 1;
+}
+
+void Servo::write(int value)
+{
+    // Same rule as ESP32Servo: below the minimum pulse it is an angle
+    if (value < _minUs)
+    {
+        value = constrain(value, 0, 180);
+        value = _minUs + value * (_maxUs - _minUs) / 180;
+    }
+    writeMicroseconds(value);
+}
+
+void Servo::writeMicroseconds(int us)
+{
+    if (_pin >= 0 && _pin < EmuHw::PIN_COUNT)
+        EmuHw::servoUs[_pin] = constrain(us, _minUs, _maxUs);
+}
+
+// =============================================================================
+// SERIAL (stdout + EventLog decoding)
+// =============================================================================
+
+HardwareSerial Serial;
+
+static std::mutex serialLock;
+
+/** @brief Format strings indexed by LogEvent (log_events.h). */
+static const char *const EVENT_FORMATS[] = {
+#define LOG_EVENT_FORMAT(name, fmt) fmt,
+    ROVER_LOG_EVENTS(LOG_EVENT_FORMAT)
+#undef LOG_EVENT_FORMAT
+};
+
+/**
+ * @brief Undoes COBS; returns the decoded length (0 = malformed).
+ */
+static size_t cobsDecode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t i = 0, o = 0;
+    while (i < len)
+    {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len)
+            return 0;
+        for (uint8_t k = 1; k < code; k++)
+            out[o++] = in[i++];
+        if (code < 0xFF && i < len)
+            out[o++] = 0;
+    }
+    return o;
+}
+
+/**
+ * @brief Prints one EventLog record as "[t] text" (caller holds serialLock).
+ */
+static void printRecord(const uint8_t *frame, size_t len)
+{
+    uint8_t raw[64];
+    if (len > sizeof(raw))
+        return;
+    size_t n = cobsDecode(frame, len, raw);
+    if (n < 8)
+        return;
+
+    uint16_t id;
+    uint32_t ts;
+    uint32_t args[3] = {0, 0, 0};
+    memcpy(&id, raw, 2);
+    memcpy(&ts, raw + 2, 4);
+    uint8_t nargs = raw[6] & 0x0F;
+    if (nargs > 3 || n != 8 + 4u * nargs || id >= LOG_EVENT_COUNT)
+        return;
+    memcpy(args, raw + 7, 4 * nargs);
+
+    char text[160];
+    snprintf(text, sizeof(text), EVENT_FORMATS[id], args[0], args[1], args[2]);
+    printf("[%10.3f] %s\n", ts / 1e6, text);
+}
+
+size_t HardwareSerial::printf(const char *format, ...)
+{
+    char line[512];
+    va_list ap;
+    va_start(ap, format);
+    int n = vsnprintf(line, sizeof(line), format, ap);
+    va_end(ap);
+    print(line);
+    return n > 0 ? (size_t)n : 0;
+}
+
+size_t HardwareSerial::print(const char *s)
+{
+    std::lock_guard<std::mutex> lk(serialLock);
+    fputs(s, stdout);
+    fflush(stdout);
+    return strlen(s);
+}
+
+size_t HardwareSerial::println(const char *s)
+{
+    std::lock_guard<std::mutex> lk(serialLock);
+    fputs(s, stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+    return strlen(s) + 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buf, size_t len)
+{
+    // EventLog writes whole frames: 0x00 | COBS | 0x00
+    std::lock_guard<std::mutex> lk(serialLock);
+    size_t start = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (buf[i] != 0x00)
+            continue;
+        if (i > start)
+            printRecord(buf + start, i - start);
+        start = i + 1;
+    }
+    fflush(stdout);
+    return len;
+}
+
+// =============================================================================
+// RADIO (loopback station, RSSI from EmuHw)
+// =============================================================================
+
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+static uint8_t emuBssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *pass, int32_t channel,
+                             const uint8_t *bssid, bool connect)
+{
+    _status = WL_CONNECTED;
+    return _status;
+}
+
+bool WiFiClass::disconnect(bool wifioff)
+{
+    _status = WL_DISCONNECTED;
+    return true;
+}
+
+int8_t WiFiClass::RSSI()
+{
+    return (int8_t)EmuHw::rssiDbm.load();
+}
+
+IPAddress WiFiClass::softAPIP()
+{
+    return IPAddress(127, 0, 0, 1);
+}
+
+IPAddress WiFiClass::localIP()
+{
+    return IPAddress(127, 0, 0, 1);
+}
+
+uint8_t *WiFiClass::BSSID()
+{
+    return emuBssid;
+}
+
+esp_err_t esp_wifi_ap_get_sta_list(wifi_sta_list_t *sta)
+{
+    // The pilot is the only station
+    memset(sta, 0, sizeof(*sta));
+    sta->num = 1;
+    sta->sta[0].rssi = (int8_t)EmuHw::rssiDbm.load();
+    return ESP_OK;
+}
+
+// =============================================================================
+// NVS (in memory)
+// =============================================================================
+
+static std::mutex nvsLock;
+static std::map<std::string, std::vector<uint8_t>> nvs;
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+    _ns = name;
+    return true;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen)
+{
+    if (!_ns)
+        return 0;
+    std::lock_guard<std::mutex> lk(nvsLock);
+    auto it = nvs.find(std::string(_ns) + "/" + key);
+    if (it == nvs.end() || it->second.size() > maxLen)
+        return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len)
+{
+    if (!_ns)
+        return 0;
+    std::lock_guard<std::mutex> lk(nvsLock);
+    const uint8_t *p = (const uint8_t *)value;
+    nvs[std::string(_ns) + "/" + key].assign(p, p + len);
+    return len;
+}
+
+bool Preferences::remove(const char *key)
+{
+    if (!_ns)
+        return false;
+    std::lock_guard<std::mutex> lk(nvsLock);
+    return nvs.erase(std::string(_ns) + "/" + key) > 0;
+}
+
+// =============================================================================
+// HEAP (PSRAM and internal RAM are the host heap)
+// =============================================================================
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return malloc(size);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return 0;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    return 0;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return 0;
+}
@@ -0,0 +1,332 @@
+/**
+ * @file emu_camera.cpp
+ * @brief Host Shim - OV2640 Timing Model and JPEG Frame Source.
+ * @author Alejandro Moyano (@AleSMC)
+ * @details
+ * Timing follows the sensor, not the host: the frame period depends on the
+ * sensor mode (CIF / SVGA / UXGA readout) and scales with XCLK, and a grab
+ * waits for the next VSYNC once the single buffer is free. Content is
+ * EmuHw::scene (or a test pattern) at the current output size, compressed
+ * with libjpeg at the current quality; or recorded JPEGs from
+ * EmuHw::framesDir, served unchanged at the same rate.
+ */
+
+#include "esp_camera.h"
+#include "esp_timer.h"
+#include "EmuHw.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <jpeglib.h>
+
+const resolution_info_t resolution[] = {
+    {96, 96}, {160, 120}, {176, 144}, {240, 176}, {240, 240}, {320, 240}, {400, 296},
+    {480, 320}, {640, 480}, {800, 600}, {1024, 768}, {1280, 720}, {1280, 1024}, {1600, 1200},
+};
+
+/**
+ * @brief Readout modes of the OV2640, numbered like the driver's
+ * ov2640_sensor_mode_t (set_res_raw() 'startX').
+ */
+enum SensorMode
+{
+    MODE_UXGA,
+    MODE_SVGA,
+    MODE_CIF,
+    MODE_COUNT
+};
+static const char *const MODE_NAMES[] = {"UXGA", "SVGA", "CIF"};
+static const int64_t MODE_PERIOD_US[] = {125000, 50000, 40000}; ///< At 20 MHz XCLK
+static const framesize_t MODE_AREA[] = {FRAMESIZE_UXGA, FRAMESIZE_SVGA, FRAMESIZE_CIF}; ///< Window space
+
+static struct
+{
+    std::mutex lock;
+    std::condition_variable freed;
+    bool held = false; ///< The only frame buffer is with the application
+
+    SensorMode mode = MODE_UXGA;
+    int xclkMhz = 20;
+    int width = 1600;
+    int height = 1200;
+    int quality = 12;
+    uint32_t frames = 0;
+
+    sensor_t sensor;
+    camera_fb_t fb;
+    std::vector<uint8_t> jpeg;
+    std::vector<uint8_t> rgb;
+    std::vector<std::vector<uint8_t>> recorded;
+} cam;
+
+// =============================================================================
+// SENSOR REGISTERS
+// =============================================================================
+
+static int setFramesize(sensor_t *s, framesize_t framesize)
+{
+    if (framesize >= FRAMESIZE_INVALID)
+        return -1;
+    std::lock_guard<std::mutex> lk(cam.lock);
+    cam.mode = framesize <= FRAMESIZE_CIF ? MODE_CIF : framesize <= FRAMESIZE_SVGA ? MODE_SVGA : MODE_UXGA;
+    cam.width = resolution[framesize].width;
+    cam.height = resolution[framesize].height;
+    s->status.framesize = framesize;
+    return 0;
+}
+
+static int setQuality(sensor_t *s, int quality)
+{
+    std::lock_guard<std::mutex> lk(cam.lock);
+    cam.quality = std::max(0, std::min(63, quality));
+    s->status.quality = (uint8_t)cam.quality;
+    return 0;
+}
+
+static int setXclk(sensor_t *s, int timer, int xclk)
+{
+    if (xclk <= 0 || xclk > 20)
+        return -1;
+    std::lock_guard<std::mutex> lk(cam.lock);
+    cam.xclkMhz = xclk;
+    s->xclk_freq_hz = xclk * 1000000;
+    return 0;
+}
+
+static int setResRaw(sensor_t *s, int startX, int startY, int endX, int endY, int offsetX, int offsetY,
+                     int totalX, int totalY, int outputX, int outputY, bool scale, bool binning)
+{
+    // OV2640 driver: 'startX' selects the readout mode, the window lives in its space
+    if (startX < 0 || startX >= MODE_COUNT || outputX <= 0 || outputY <= 0)
+        return -1;
+    const resolution_info_t &area = resolution[MODE_AREA[startX]];
+    if (offsetX + totalX > area.width || offsetY + totalY > area.height)
+        return -1;
+    printf("[EMU] camera: %dx%d window at (%d, %d) of the %s readout\n",
+           totalX, totalY, offsetX, offsetY, MODE_NAMES[startX]);
+
+    std::lock_guard<std::mutex> lk(cam.lock);
+    cam.mode = (SensorMode)startX;
+    cam.width = outputX;
+    cam.height = outputY;
+    return 0;
+}
+
+static int setGainceiling(sensor_t *s, gainceiling_t gainceiling) { return 0; }
+static int setFlag(sensor_t *s, int value) { return 0; }
+
+// =============================================================================
+// FRAME SOURCE
+// =============================================================================
+
+/**
+ * @brief Built-in pattern: colour bars scrolling one column per frame.
+ */
+static void testPattern(uint8_t *rgb, int width, int height, uint32_t frame)
+{
+    static const uint8_t BARS[8][3] = {{235, 235, 235}, {235, 235, 16}, {16, 235, 235}, {16, 235, 16},
+                                       {235, 16, 235}, {235, 16, 16}, {16, 16, 235}, {16, 16, 16}};
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const uint8_t *c = BARS[((x + (int)frame) * 8 / width) % 8];
+            uint8_t *p = rgb + ((size_t)y * width + x) * 3;
+            p[0] = c[0];
+            p[1] = c[1];
+            p[2] = c[2];
+        }
+    }
+}
+
+/**
+ * @brief Renders and compresses one frame into cam.jpeg.
+ */
+static void encodeFrame(int width, int height, int quality, uint32_t frame)
+{
+    cam.rgb.resize((size_t)width * height * 3);
+    (EmuHw::scene ? EmuHw::scene : testPattern)(cam.rgb.data(), width, height, frame);
+
+    jpeg_compress_struct c;
+    jpeg_error_mgr err;
+    c.err = jpeg_std_error(&err);
+    jpeg_create_compress(&c);
+    unsigned char *out = NULL;
+    unsigned long outLen = 0;
+    jpeg_mem_dest(&c, &out, &outLen);
+
+    c.image_width = width;
+    c.image_height = height;
+    c.input_components = 3;
+    c.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&c);
+    // OV2640 scale: 0 (best) .. 63 (worst)
+    jpeg_set_quality(&c, std::max(5, 100 - quality * 95 / 63), TRUE);
+    jpeg_start_compress(&c, TRUE);
+    while (c.next_scanline < c.image_height)
+    {
+        JSAMPROW row = cam.rgb.data() + (size_t)c.next_scanline * width * 3;
+        jpeg_write_scanlines(&c, &row, 1);
+    }
+    jpeg_finish_compress(&c);
+    jpeg_destroy_compress(&c);
+
+    cam.jpeg.assign(out, out + outLen);
+    free(out);
+}
+
+/**
+ * @brief Size of a recorded JPEG (from its header).
+ */
+static bool jpegSize(const std::vector<uint8_t> &data, int &width, int &height)
+{
+    jpeg_decompress_struct d;
+    jpeg_error_mgr err;
+    d.err = jpeg_std_error(&err);
+    jpeg_create_decompress(&d);
+    jpeg_mem_src(&d, data.data(), data.size());
+    bool ok = jpeg_read_header(&d, TRUE) == JPEG_HEADER_OK;
+    width = d.image_width;
+    height = d.image_height;
+    jpeg_destroy_decompress(&d);
+    return ok;
+}
+
+/**
+ * @brief Loads every *.jpg / *.jpeg of EmuHw::framesDir, in name order.
+ */
+static void loadRecorded(const char *dir)
+{
+    DIR *d = opendir(dir);
+    if (!d)
+    {
+        fprintf(stderr, "[EMU] camera: cannot open %s\n", dir);
+        return;
+    }
+
+    std::vector<std::string> names;
+    while (struct dirent *e = readdir(d))
+    {
+        std::string n = e->d_name;
+        size_t dot = n.rfind('.');
+        std::string ext = dot == std::string::npos ? "" : n.substr(dot);
+        if (ext == ".jpg" || ext == ".jpeg" || ext == ".JPG")
+            names.push_back(std::string(dir) + "/" + n);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string &path : names)
+    {
+        FILE *f = fopen(path.c_str(), "rb");
+        if (!f)
+            continue;
+        std::vector<uint8_t> data;
+        uint8_t buf[65536];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+            data.insert(data.end(), buf, buf + n);
+        fclose(f);
+        cam.recorded.push_back(data);
+    }
+    printf("[EMU] camera: %zu recorded frames from %s\n", cam.recorded.size(), dir);
+}
+
+// =============================================================================
+// DRIVER API
+// =============================================================================
+
+esp_err_t esp_camera_init(const camera_config_t *config)
+{
+    if (config->pixel_format != PIXFORMAT_JPEG)
+        return ESP_ERR_INVALID_ARG;
+
+    sensor_t &s = cam.sensor;
+    memset(&s, 0, sizeof(s));
+    s.set_framesize = setFramesize;
+    s.set_quality = setQuality;
+    s.set_xclk = setXclk;
+    s.set_res_raw = setResRaw;
+    s.set_gainceiling = setGainceiling;
+    s.set_gain_ctrl = setFlag;
+    s.set_exposure_ctrl = setFlag;
+    s.set_aec2 = setFlag;
+    s.set_ae_level = setFlag;
+
+    setXclk(&s, 0, config->xclk_freq_hz / 1000000);
+    setFramesize(&s, config->frame_size);
+    setQuality(&s, config->jpeg_quality);
+
+    if (EmuHw::framesDir)
+    {
+        loadRecorded(EmuHw::framesDir);
+        if (cam.recorded.empty())
+            return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+sensor_t *esp_camera_sensor_get()
+{
+    return &cam.sensor;
+}
+
+camera_fb_t *esp_camera_fb_get()
+{
+    // 1. SINGLE BUFFER: wait until the application returned it
+    std::unique_lock<std::mutex> lk(cam.lock);
+    cam.freed.wait(lk, []()
+                   { return !cam.held; });
+    cam.held = true;
+    int width = cam.width, height = cam.height, quality = cam.quality;
+    int64_t period = MODE_PERIOD_US[cam.mode] * 20 / cam.xclkMhz;
+    uint32_t frame = cam.frames++;
+    lk.unlock();
+
+    // 2. TIMING: capture starts at the next VSYNC, ends one period later
+    int64_t now = esp_timer_get_time();
+    int64_t ready = (now / period + 1) * period + period;
+
+    // 3. CONTENT (produced while the "sensor" is still reading out)
+    if (!cam.recorded.empty())
+    {
+        cam.jpeg = cam.recorded[frame % cam.recorded.size()];
+        jpegSize(cam.jpeg, width, height);
+    }
+    else
+    {
+        encodeFrame(width, height, quality, frame);
+    }
+
+    int64_t wait = ready - esp_timer_get_time();
+    if (wait > 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(wait));
+
+    camera_fb_t &fb = cam.fb;
+    fb.buf = cam.jpeg.data();
+    fb.len = cam.jpeg.size();
+    fb.width = width;
+    fb.height = height;
+    fb.format = PIXFORMAT_JPEG;
+    fb.timestamp.tv_sec = ready / 1000000;
+    fb.timestamp.tv_usec = ready % 1000000;
+    return &fb;
+}
+
+void esp_camera_fb_return(camera_fb_t *fb)
+{
+    {
+        std::lock_guard<std::mutex> lk(cam.lock);
+        cam.held = false;
+    }
+    cam.freed.notify_one();
+}
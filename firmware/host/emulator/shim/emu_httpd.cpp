@@ -0,0 +1,354 @@
+/**
+ * @file emu_httpd.cpp
+ * @brief Host Shim - esp_http_server Worker, Routing and Response Helpers.
+ * @author Alejandro Moyano (@AleSMC)
+ * @details
+ * Each accepted connection carries one request: parse the request line and
+ * headers, match a route (config.uri_match_fn or exact path), run the
+ * handler on the worker thread, then close through config.close_fn. A
+ * handler that keeps the socket (the stream/still hand-off) is therefore
+ * honoured exactly as on the rover.
+ */
+
+#include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "EmuHw.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/** @brief One running server. */
+struct EmuServer
+{
+    httpd_config_t config;
+    int listenFd;
+    std::vector<httpd_uri_t> routes;
+};
+
+/** @brief Per-request state behind httpd_req_t::aux. */
+struct EmuReq
+{
+    int fd;
+    std::string headers;      ///< Raw request header block
+    std::string status;       ///< "200 OK" unless set
+    std::string type;         ///< Content-Type
+    std::string extraHeaders; ///< "Name: value\r\n" lines from httpd_resp_set_hdr
+    bool headSent;
+    bool chunked;
+};
+
+static bool sendAll(int fd, const char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = send(fd, buf, len, 0);
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static EmuReq *state(httpd_req_t *r)
+{
+    return (EmuReq *)r->aux;
+}
+
+/**
+ * @brief Status line + headers (once per response).
+ */
+static bool sendHead(httpd_req_t *r, bool chunked, ssize_t length)
+{
+    EmuReq *s = state(r);
+    if (s->headSent)
+        return true;
+
+    std::string head = "HTTP/1.1 " + s->status + "\r\nContent-Type: " + s->type + "\r\n" + s->extraHeaders;
+    if (chunked)
+        head += "Transfer-Encoding: chunked\r\n";
+    else
+        head += "Content-Length: " + std::to_string(length) + "\r\n";
+    head += "Connection: close\r\n\r\n";
+
+    s->headSent = true;
+    s->chunked = chunked;
+    return sendAll(s->fd, head.data(), head.size());
+}
+
+// =============================================================================
+// SERVER
+// =============================================================================
+
+/**
+ * @brief Reads the request header block (up to the blank line).
+ */
+static bool readHead(int fd, std::string &head)
+{
+    char buf[512];
+    while (head.find("\r\n\r\n") == std::string::npos)
+    {
+        if (head.size() > 8192)
+            return false;
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+            return false;
+        head.append(buf, (size_t)n);
+    }
+    return true;
+}
+
+/**
+ * @brief Parses, routes and answers one connection.
+ */
+static void serve(EmuServer *srv, int fd)
+{
+    struct timeval tv = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    std::string head;
+    if (!readHead(fd, head))
+        return;
+
+    // 1. REQUEST LINE: METHOD URI VERSION
+    size_t sp1 = head.find(' ');
+    size_t sp2 = (sp1 == std::string::npos) ? sp1 : head.find(' ', sp1 + 1);
+    if (sp2 == std::string::npos || sp2 - sp1 - 1 > HTTPD_MAX_URI_LEN)
+        return;
+    std::string method = head.substr(0, sp1);
+    std::string uri = head.substr(sp1 + 1, sp2 - sp1 - 1);
+    int m = method == "GET" ? HTTP_GET : method == "POST" ? HTTP_POST : method == "PUT" ? HTTP_PUT : method == "HEAD" ? HTTP_HEAD : method == "DELETE" ? HTTP_DELETE : -1;
+
+    EmuReq s = {fd, head.substr(head.find("\r\n") + 2), "200 OK", "text/html", "", false, false};
+    httpd_req_t req;
+    memset(&req, 0, sizeof(req));
+    req.handle = srv;
+    req.method = m;
+    strcpy(req.uri, uri.c_str());
+    req.aux = &s;
+
+    // 2. ROUTE (the matcher only sees the path, like the IDF)
+    size_t pathLen = uri.find('?');
+    if (pathLen == std::string::npos)
+        pathLen = uri.size();
+    for (const httpd_uri_t &route : srv->routes)
+    {
+        if ((int)route.method != m)
+            continue;
+        bool match = srv->config.uri_match_fn
+                         ? srv->config.uri_match_fn(route.uri, req.uri, pathLen)
+                         : strlen(route.uri) == pathLen && strncmp(route.uri, req.uri, pathLen) == 0;
+        if (!match)
+            continue;
+
+        req.user_ctx = route.user_ctx;
+        route.handler(&req);
+        if (s.headSent && s.chunked)
+            httpd_resp_send_chunk(&req, NULL, 0); // Unterminated chunked reply
+        return;
+    }
+    httpd_resp_send_err(&req, HTTPD_404_NOT_FOUND, "This URI does not exist");
+}
+
+/**
+ * @brief Single worker (the IDF's httpd task).
+ */
+static void workerTask(void *arg)
+{
+    EmuServer *srv = (EmuServer *)arg;
+    while (true)
+    {
+        int fd = accept(srv->listenFd, NULL, NULL);
+        if (fd < 0)
+            continue;
+
+        serve(srv, fd);
+
+        // Session over: the firmware's close_fn decides whether the fd dies
+        if (srv->config.close_fn)
+            srv->config.close_fn(srv, fd);
+        else
+            close(fd);
+    }
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    // lwIP reports a dead peer as an error, not as a signal
+    signal(SIGPIPE, SIG_IGN);
+
+    EmuServer *srv = new EmuServer();
+    srv->config = *config;
+    if (EmuHw::httpPort)
+        srv->config.server_port = EmuHw::httpPort;
+
+    srv->listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(srv->listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(srv->config.server_port);
+    if (bind(srv->listenFd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(srv->listenFd, 8) < 0)
+    {
+        fprintf(stderr, "[EMU] httpd: cannot listen on port %u: %s\n", srv->config.server_port, strerror(errno));
+        close(srv->listenFd);
+        delete srv;
+        return ESP_FAIL;
+    }
+
+    xTaskCreatePinnedToCore(workerTask, "httpd", config->stack_size, srv, config->task_priority,
+                            NULL, config->core_id);
+    *handle = srv;
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    // Registration happens before clients are served (startServer/setup)
+    EmuServer *srv = (EmuServer *)handle;
+    if (srv->routes.size() >= srv->config.max_uri_handlers)
+        return ESP_ERR_NO_MEM;
+    srv->routes.push_back(*uri_handler);
+    return ESP_OK;
+}
+
+bool httpd_uri_match_wildcard(const char *uri_template, const char *uri_to_match, size_t match_upto)
+{
+    // Same rules as the IDF: trailing '*' = any suffix, '?' = preceding char optional
+    size_t tplLen = strlen(uri_template);
+    if (tplLen > 0 && uri_template[tplLen - 1] == '*')
+        return match_upto >= tplLen - 1 && strncmp(uri_template, uri_to_match, tplLen - 1) == 0;
+    if (tplLen > 1 && uri_template[tplLen - 1] == '?')
+    {
+        tplLen--;
+        if (match_upto == tplLen - 1)
+            tplLen--;
+    }
+    return match_upto == tplLen && strncmp(uri_template, uri_to_match, tplLen) == 0;
+}
+
+// =============================================================================
+// REQUEST
+// =============================================================================
+
+int httpd_req_to_sockfd(httpd_req_t *r)
+{
+    return state(r)->fd;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    const char *q = strchr(r->uri, '?');
+    if (!q)
+        return ESP_ERR_NOT_FOUND;
+    snprintf(buf, buf_len, "%s", q + 1);
+    return ESP_OK;
+}
+
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size)
+{
+    size_t keyLen = strlen(key);
+    const char *p = qry;
+    while (p && *p)
+    {
+        const char *end = strchr(p, '&');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        if (len > keyLen && strncmp(p, key, keyLen) == 0 && p[keyLen] == '=')
+        {
+            size_t n = len - keyLen - 1;
+            if (n >= val_size)
+                n = val_size - 1;
+            memcpy(val, p + keyLen + 1, n);
+            val[n] = '\0';
+            return ESP_OK;
+        }
+        p = end ? end + 1 : NULL;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size)
+{
+    const std::string &h = state(r)->headers;
+    size_t fieldLen = strlen(field);
+    for (size_t pos = 0; pos < h.size();)
+    {
+        size_t eol = h.find("\r\n", pos);
+        if (eol == std::string::npos || eol == pos)
+            break;
+        if (eol - pos > fieldLen && h[pos + fieldLen] == ':' && strncasecmp(h.c_str() + pos, field, fieldLen) == 0)
+        {
+            size_t v = h.find_first_not_of(' ', pos + fieldLen + 1);
+            snprintf(val, val_size, "%s", h.substr(v, eol - v).c_str());
+            return ESP_OK;
+        }
+        pos = eol + 2;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+// =============================================================================
+// RESPONSE
+// =============================================================================
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    state(r)->status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    state(r)->type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    state(r)->extraHeaders += std::string(field) + ": " + value + "\r\n";
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    if (buf_len == HTTPD_RESP_USE_STRLEN)
+        buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    if (!sendHead(r, false, buf_len) || !sendAll(state(r)->fd, buf, (size_t)buf_len))
+        return ESP_FAIL;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    if (buf_len == HTTPD_RESP_USE_STRLEN)
+        buf_len = buf ? (ssize_t)strlen(buf) : 0;
+    if (!sendHead(r, true, 0))
+        return ESP_FAIL;
+
+    EmuReq *s = state(r);
+    if (!s->chunked)
+        return ESP_FAIL; // Not a chunked response (or already terminated)
+
+    char size[16];
+    int n = snprintf(size, sizeof(size), "%zx\r\n", (size_t)buf_len);
+    if (!sendAll(s->fd, size, n) || !sendAll(s->fd, buf, (size_t)buf_len) || !sendAll(s->fd, "\r\n", 2))
+        return ESP_FAIL;
+    if (buf_len == 0)
+        s->chunked = false; // Terminating chunk sent
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    static const char *const STATUS[] = {"400 Bad Request", "404 Not Found", "500 Internal Server Error"};
+    httpd_resp_set_status(req, STATUS[error]);
+    httpd_resp_set_type(req, "text/html");
+    return httpd_resp_send(req, msg, HTTPD_RESP_USE_STRLEN);
+}
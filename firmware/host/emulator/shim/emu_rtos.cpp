@@ -0,0 +1,307 @@
+/**
+ * @file emu_rtos.cpp
+ * @brief Host Shim - FreeRTOS Tasks, Notifications, Semaphores and Event Groups.
+ * @author Alejandro Moyano (@AleSMC)
+ * @details
+ * One detached std::thread per task. Ticks are milliseconds
+ * (configTICK_RATE_HZ = 1000, as on the rover). Threads not created through
+ * xTaskCreatePinnedToCore() (main, the httpd worker) get a task record on
+ * first use so they can take notifications too.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/** @brief Boot instant: tick 0. */
+static const Clock::time_point bootTime = Clock::now();
+
+struct EmuTask
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    uint32_t notify = 0;
+    BaseType_t core = 0;
+};
+
+struct EmuSemaphore
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    uint32_t count = 0;
+    uint32_t max = 1;
+    std::thread::id owner; ///< Recursive mutex holder
+    uint32_t depth = 0;
+};
+
+struct EmuEventGroup
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    EventBits_t bits = 0;
+};
+
+/** @brief Record of the calling thread (owned by the thread, never freed). */
+static thread_local EmuTask *self = NULL;
+
+static EmuTask *currentTask()
+{
+    if (!self)
+        self = new EmuTask();
+    return self;
+}
+
+/**
+ * @brief Absolute deadline for a timeout in ticks (portMAX_DELAY = none).
+ */
+static bool deadlineFor(TickType_t ticks, Clock::time_point &deadline)
+{
+    if (ticks == portMAX_DELAY)
+        return false;
+    deadline = Clock::now() + std::chrono::milliseconds(ticks);
+    return true;
+}
+
+/**
+ * @brief cv.wait until pred() or the timeout; returns pred().
+ */
+template <typename Pred>
+static bool waitFor(std::condition_variable &cv, std::unique_lock<std::mutex> &lk, TickType_t ticks, Pred pred)
+{
+    Clock::time_point deadline;
+    if (!deadlineFor(ticks, deadline))
+    {
+        cv.wait(lk, pred);
+        return true;
+    }
+    return cv.wait_until(lk, deadline, pred);
+}
+
+// =============================================================================
+// CRITICAL SECTIONS
+// =============================================================================
+
+void vPortEnterCritical(portMUX_TYPE *mux)
+{
+    while (__atomic_exchange_n(&mux->owner, 1, __ATOMIC_ACQUIRE))
+        sched_yield();
+}
+
+void vPortExitCritical(portMUX_TYPE *mux)
+{
+    __atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+}
+
+BaseType_t xPortGetCoreID()
+{
+    return currentTask()->core;
+}
+
+// =============================================================================
+// TASKS
+// =============================================================================
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    EmuTask *task = new EmuTask();
+    task->core = (core == tskNO_AFFINITY) ? 0 : core;
+    if (handle)
+        *handle = task;
+
+    std::thread t([fn, arg, task, name]()
+                  {
+                      self = task;
+                      pthread_setname_np(pthread_self(), std::string(name).substr(0, 15).c_str());
+                      fn(arg);
+                  });
+    t.detach();
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // Only self-deletion is used by the firmware
+    if (task == NULL || task == self)
+        pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t increment)
+{
+    *previousWake += increment;
+    std::this_thread::sleep_until(bootTime + std::chrono::milliseconds(*previousWake));
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - bootTime).count();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return currentTask();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks)
+{
+    EmuTask *t = currentTask();
+    std::unique_lock<std::mutex> lk(t->lock);
+    if (!waitFor(t->cv, lk, ticks, [t]()
+                 { return t->notify > 0; }))
+        return 0;
+
+    uint32_t value = t->notify;
+    t->notify = clearOnExit ? 0 : value - 1;
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    {
+        std::lock_guard<std::mutex> lk(task->lock);
+        task->notify++;
+    }
+    task->cv.notify_one();
+    return pdPASS;
+}
+
+// =============================================================================
+// SEMAPHORES
+// =============================================================================
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return new EmuSemaphore(); // Created empty, like FreeRTOS
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    EmuSemaphore *s = new EmuSemaphore();
+    s->count = 1;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()
+{
+    return xSemaphoreCreateMutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lk(sem->lock);
+    if (!waitFor(sem->cv, lk, ticks, [sem]()
+                 { return sem->count > 0; }))
+        return pdFALSE;
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    {
+        std::lock_guard<std::mutex> lk(sem->lock);
+        if (sem->count >= sem->max)
+            return pdFALSE;
+        sem->count++;
+    }
+    sem->cv.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    std::thread::id me = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lk(sem->lock);
+    if (sem->depth > 0 && sem->owner == me)
+    {
+        sem->depth++;
+        return pdTRUE;
+    }
+    if (!waitFor(sem->cv, lk, ticks, [sem]()
+                 { return sem->depth == 0; }))
+        return pdFALSE;
+    sem->owner = me;
+    sem->depth = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem)
+{
+    {
+        std::lock_guard<std::mutex> lk(sem->lock);
+        if (sem->depth == 0 || sem->owner != std::this_thread::get_id())
+            return pdFALSE;
+        if (--sem->depth > 0)
+            return pdTRUE;
+    }
+    sem->cv.notify_one();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    delete sem;
+}
+
+// =============================================================================
+// EVENT GROUPS
+// =============================================================================
+
+EventGroupHandle_t xEventGroupCreate()
+{
+    return new EmuEventGroup();
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    EventBits_t value;
+    {
+        std::lock_guard<std::mutex> lk(group->lock);
+        group->bits |= bits;
+        value = group->bits;
+    }
+    group->cv.notify_all();
+    return value;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    std::lock_guard<std::mutex> lk(group->lock);
+    EventBits_t before = group->bits;
+    group->bits &= ~bits;
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    std::lock_guard<std::mutex> lk(group->lock);
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit,
+                                BaseType_t waitForAll, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lk(group->lock);
+    bool met = waitFor(group->cv, lk, ticks, [group, bits, waitForAll]()
+                       { return waitForAll ? (group->bits & bits) == bits : (group->bits & bits) != 0; });
+    EventBits_t value = group->bits;
+    if (met && clearOnExit)
+        group->bits &= ~bits;
+    return value;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file esp_camera.h
+ * @brief Host Shim - Camera Driver Serving Synthetic or Recorded JPEG Frames.
+ * @author Alejandro Moyano (@AleSMC)
+ * @details
+ * Single frame buffer, CAMERA_GRAB_WHEN_EMPTY semantics (the firmware's PSRAM
+ * setting): a capture starts at the first VSYNC after the buffer is returned
+ * and completes one frame period later. The period follows the sensor mode
+ * (output size) and XCLK like the OV2640. Frames are rendered by
+ * EmuHw::scene at the current output size and JPEG-encoded with libjpeg, or
+ * read in a loop from EmuHw::framesDir.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include "esp_err.h"
+#include "sensor.h"
+
+typedef enum
+{
+    LEDC_CHANNEL_0,
+    LEDC_CHANNEL_1,
+    LEDC_CHANNEL_2,
+    LEDC_CHANNEL_3,
+} ledc_channel_t;
+
+typedef enum
+{
+    LEDC_TIMER_0,
+    LEDC_TIMER_1,
+    LEDC_TIMER_2,
+    LEDC_TIMER_3,
+} ledc_timer_t;
+
+typedef enum
+{
+    CAMERA_GRAB_WHEN_EMPTY,
+    CAMERA_GRAB_LATEST
+} camera_grab_mode_t;
+
+typedef struct
+{
+    int pin_pwdn, pin_reset, pin_xclk;
+    int pin_sccb_sda, pin_sccb_scl;
+    int pin_d7, pin_d6, pin_d5, pin_d4, pin_d3, pin_d2, pin_d1, pin_d0;
+    int pin_vsync, pin_href, pin_pclk;
+    int xclk_freq_hz;
+    ledc_timer_t ledc_timer;
+    ledc_channel_t ledc_channel;
+    pixformat_t pixel_format;
+    framesize_t frame_size;
+    int jpeg_quality;
+    size_t fb_count;
+    camera_grab_mode_t grab_mode;
+} camera_config_t;
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t len;
+    size_t width;
+    size_t height;
+    pixformat_t format;
+    struct timeval timestamp;
+} camera_fb_t;
+
+esp_err_t esp_camera_init(const camera_config_t *config);
+camera_fb_t *esp_camera_fb_get();
+void esp_camera_fb_return(camera_fb_t *fb);
+sensor_t *esp_camera_sensor_get();
@@ -0,0 +1,16 @@
+/**
+ * @file esp_err.h
+ * @brief Host Shim - ESP-IDF Error Codes.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_NOT_FOUND 0x105
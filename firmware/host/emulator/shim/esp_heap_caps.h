@@ -0,0 +1,19 @@
+/**
+ * @file esp_heap_caps.h
+ * @brief Host Shim - Capability Heaps Mapped to malloc().
+ * @author Alejandro Moyano (@AleSMC)
+ * @details The host has one heap: the size queries report 0 (not modelled).
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
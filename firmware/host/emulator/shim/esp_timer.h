@@ -0,0 +1,10 @@
+/**
+ * @file esp_timer.h
+ * @brief Host Shim - Microseconds Since Emulator Start (monotonic).
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
@@ -0,0 +1,43 @@
+/**
+ * @file FreeRTOS.h
+ * @brief Host Shim - FreeRTOS Types, Critical Sections and Core IDs on pthreads.
+ * @author Alejandro Moyano (@AleSMC)
+ * @details
+ * Tasks are threads and priorities/affinity are ignored: the host scheduler
+ * decides. portMUX_TYPE keeps its semantics (a spinlock held for a few
+ * instructions), so the firmware's critical sections stay correct.
+ */
+
+#pragma once
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+/**
+ * @brief Spinlock (critical sections are a few instructions long).
+ */
+typedef struct
+{
+    volatile int owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+
+/** @brief Core the calling task was "pinned" to (0 for foreign threads). */
+BaseType_t xPortGetCoreID();
@@ -0,0 +1,20 @@
+/**
+ * @file event_groups.h
+ * @brief Host Shim - Event Groups (bits + condition variable).
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+#include "FreeRTOS.h"
+
+#define BIT0 0x00000001
+
+typedef struct EmuEventGroup *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate();
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit,
+                                BaseType_t waitForAll, TickType_t ticks);
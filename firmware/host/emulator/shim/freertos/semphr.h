@@ -0,0 +1,19 @@
+/**
+ * @file semphr.h
+ * @brief Host Shim - Binary/Counting Semaphores and (Recursive) Mutexes.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+#include "FreeRTOS.h"
+
+typedef struct EmuSemaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
@@ -0,0 +1,15 @@
+/**
+ * @file sockets.h
+ * @brief Host Shim - lwIP's BSD Socket API Is the POSIX One.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
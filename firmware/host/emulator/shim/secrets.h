@@ -0,0 +1,12 @@
+/**
+ * @file secrets.h
+ * @brief Host Shim - Placeholder Credentials (the emulated radio ignores them).
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+#include "secrets_example.h"
+
+#ifndef WIFI_PASS
+#define WIFI_PASS WIFI_PASSWORD
+#endif
@@ -0,0 +1,79 @@
+/**
+ * @file sensor.h
+ * @brief Host Shim - OV2640 Sensor Interface (esp32-camera layout subset).
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+    PIXFORMAT_RGB565,
+    PIXFORMAT_YUV422,
+    PIXFORMAT_GRAYSCALE,
+    PIXFORMAT_JPEG,
+} pixformat_t;
+
+typedef enum
+{
+    FRAMESIZE_96X96,   // 96x96
+    FRAMESIZE_QQVGA,   // 160x120
+    FRAMESIZE_QCIF,    // 176x144
+    FRAMESIZE_HQVGA,   // 240x176
+    FRAMESIZE_240X240, // 240x240
+    FRAMESIZE_QVGA,    // 320x240
+    FRAMESIZE_CIF,     // 400x296
+    FRAMESIZE_HVGA,    // 480x320
+    FRAMESIZE_VGA,     // 640x480
+    FRAMESIZE_SVGA,    // 800x600
+    FRAMESIZE_XGA,     // 1024x768
+    FRAMESIZE_HD,      // 1280x720
+    FRAMESIZE_SXGA,    // 1280x1024
+    FRAMESIZE_UXGA,    // 1600x1200
+    FRAMESIZE_INVALID
+} framesize_t;
+
+typedef enum
+{
+    GAINCEILING_2X,
+    GAINCEILING_4X,
+    GAINCEILING_8X,
+    GAINCEILING_16X,
+    GAINCEILING_32X,
+    GAINCEILING_64X,
+    GAINCEILING_128X,
+} gainceiling_t;
+
+typedef struct
+{
+    const uint16_t width;
+    const uint16_t height;
+} resolution_info_t;
+
+extern const resolution_info_t resolution[];
+
+typedef struct
+{
+    framesize_t framesize;
+    uint8_t quality;
+} camera_status_t;
+
+typedef struct _sensor sensor_t;
+struct _sensor
+{
+    camera_status_t status;
+    int xclk_freq_hz;
+
+    int (*set_framesize)(sensor_t *sensor, framesize_t framesize);
+    int (*set_quality)(sensor_t *sensor, int quality);
+    int (*set_gainceiling)(sensor_t *sensor, gainceiling_t gainceiling);
+    int (*set_gain_ctrl)(sensor_t *sensor, int enable);
+    int (*set_exposure_ctrl)(sensor_t *sensor, int enable);
+    int (*set_aec2)(sensor_t *sensor, int enable);
+    int (*set_ae_level)(sensor_t *sensor, int level);
+    int (*set_xclk)(sensor_t *sensor, int timer, int xclk);
+    int (*set_res_raw)(sensor_t *sensor, int startX, int startY, int endX, int endY, int offsetX, int offsetY,
+                       int totalX, int totalY, int outputX, int outputY, bool scale, bool binning);
+};
@@ -12,6 +12,12 @@
  * - Pin Mapping (GPIO).
  * - Mechanical Calibration (Servo).
  * - Protocol Constants (Ports and Timings).
+ * - Task Layout (Core Affinity and Priority).
+ * - Obstacle Detection (Vision Throttle Limit).
+ * - Runtime Parameters (NVS-backed knobs; constants here are their defaults).
+ * - Link Governor (Adaptive Failsafe, Throttle vs. Link Quality).
+ * - Web Pilot UI (Gzipped Static Files in LittleFS).
+ * - Power Governor (CPU Clock, TX Power and Frame Rate vs. Temperature/Supply).
  *
  * @warning DO NOT include WiFi credentials here. Use 'secrets.h'.
  * @author Alejandro Moyano (@AleSMC)
@@ -19,6 +25,7 @@
 
 #pragma once
 #include <Arduino.h>
+#include "control_protocol.h" // Control packet layout (shared with host tools)
 
 // =============================================================================
 // 1. TRACTION CONFIGURATION (SOLID AXLE TOPOLOGY)
@@ -53,6 +60,29 @@
  */
 #define PIN_RESERVED_12 12
 
+// --- LEDC (PWM PERIPHERAL) ALLOCATION ---
+// The camera XCLK owns LEDC timer 0 / channel 0 (CameraServer::init).
+// Arduino's ledcSetup() drives channel N from timer (N / 2) % 4, so the motor
+// and the servo must stay off channels 0-1 and timer 0.
+
+/** * @brief LEDC channel of the traction PWM (timer 2 in Arduino's mapping). */
+const int MOTOR_PWM_CHANNEL = 4;
+
+/** * @brief Traction PWM frequency at boot (Hz). Runtime knob: 'motor_pwm_hz'.
+ * @details 1kHz is optimal for generic DC motors; higher values move the
+ * whine out of the audible range at the cost of L298N switching losses.
+ */
+const int MOTOR_PWM_FREQ = 1000;
+
+/** * @brief Traction PWM resolution at boot (bits). Runtime knob: 'motor_pwm_bits'.
+ * @details Speed commands stay 0-255 and are scaled to the resolution.
+ * Limit: frequency x 2^bits <= 80MHz (APB clock).
+ */
+const int MOTOR_PWM_RESOLUTION = 8;
+
+/** * @brief LEDC timer reserved for the steering servo (ESP32Servo allocation). */
+const int SERVO_LEDC_TIMER = 1;
+
 // =============================================================================
 // 2. STEERING CONFIGURATION (ACKERMANN SERVO)
 // =============================================================================
@@ -66,16 +96,16 @@
 // --- ANGLE CALIBRATION (DEGREES 0-180) ---
 // ADJUST THESE VALUES GRADUALLY TO AVOID FORCING THE MECHANISM
 
-/** @brief Center Angle (Straight wheels). Ideal theoretical value: 90. */
+/** @brief Center Angle (Straight wheels). Ideal theoretical value: 90. Runtime knob: 'steer_center'. */
 #define STEERING_CENTER 90
 
-/** * @brief Max Left Limit.
+/** * @brief Max Left Limit. Runtime knob: 'steer_left'.
  * Start with a value near 90 (e.g., 75) and decrease slowly towards 0.
  * If you hear buzzing, you have hit the physical stop: back off 5 degrees immediately.
  */
 #define STEERING_LEFT_MAX 40
 
-/** * @brief Max Right Limit.
+/** * @brief Max Right Limit. Runtime knob: 'steer_right'.
  * Start with a value near 90 (e.g., 105) and increase slowly towards 180.
  */
 #define STEERING_RIGHT_MAX 140
@@ -86,6 +116,7 @@
 
 /** * @brief UDP Listening Port for Commands.
  * @details The Rover will listen for control packets (e.g., binary throttle/steering) on this port.
+ * Packet layout, probe token size and protocol revision: 'control_protocol.h'.
  * @note Must match the sending port in the Python client.
  */
 const int UDP_PORT = 9999;
@@ -95,10 +126,492 @@ const int UDP_PORT = 9999;
  */
 const int HTTP_PORT = 80;
 
+/** * @brief DNS-SD service type carrying the control endpoint ('_rover._udp').
+ * @details Clients browse for it to find the Rover without knowing its IP.
+ */
+#define MDNS_ROVER_SERVICE "_rover"
+
+/** * @brief Max number of routes on the HTTP server.
+ * @details Each slot costs a few bytes of RAM. Raise it when adding endpoints.
+ */
+const int HTTP_MAX_URI_HANDLERS = 16;
+
+/** * @brief Pause between MJPEG frames on the stream socket (ms). Runtime knob: 'stream_gap_ms'.
+ * @details Historic workaround ("let WiFi breathe") from before QoS marking.
+ * With DSCP/WMM marking the control traffic no longer queues behind video,
+ * so this now only acts as an FPS/heat limiter. 0 = no pause.
+ */
+const int STREAM_FRAME_GAP_MS = 20;
+
+/** * @brief Max simultaneous MJPEG clients on '/stream'.
+ * @details Each client owns one sender task (TASK_STREAM) and captures its own
+ * frames: 2 clients = roughly half the FPS each. When full, a new client
+ * purges the least recently served one (LRU).
+ */
+const int STREAM_MAX_CLIENTS = 2;
+
+/** * @brief Send timeout on a stream socket (ms).
+ * @details A client that accepts no data for this long (walked out of range,
+ * tab suspended, half-open TCP) is dropped and its slot freed.
+ */
+const int STREAM_SEND_TIMEOUT_MS = 2000;
+
+/** * @brief Max wait for a purged stream client to release its slot (ms).
+ * @details Blocks the httpd task: kept short, the new client gets a 500 if the
+ * victim is still finishing its frame.
+ */
+const int STREAM_PURGE_WAIT_MS = 200;
+
+/** * @brief Max browser clients receiving video over the WebSocket ('/ws').
+ * @details Each client gets every captured frame; more clients = lower FPS for all.
+ */
+const int WS_MAX_VIDEO_CLIENTS = 2;
+
+// --- Quality of Service (WMM / DSCP) ---
+// The 802.11e (WMM) access category of a frame is derived from the IP
+// precedence bits (DSCP >> 3 = 802.1D User Priority):
+// - UP 6-7 -> AC_VO (Voice): shortest contention window, highest priority.
+// - UP 4-5 -> AC_VI (Video).
+// - UP 0,3 -> AC_BE (Best Effort).
+// The router applies it to the downlink (PC -> Rover control), the ESP32
+// driver to the uplink (Rover -> PC video/telemetry).
+
+/** * @brief DSCP for control and telemetry datagrams.
+ * @details CS6 (48) -> UP 6 -> AC_VO. Must match CONTROL_DSCP in the Python client.
+ */
+const uint8_t DSCP_CONTROL = 48;
+
+/** * @brief DSCP for the MJPEG stream (TCP).
+ * @details CS0 (0) -> AC_BE. Use CS4 (32) for AC_VI if the link is otherwise idle.
+ */
+const uint8_t DSCP_VIDEO = 0;
+
+// --- Main Loop Scheduling ---
+
+/** * @brief Serial heartbeat ([ALIVE]/[STATUS]) period (ms). */
+const int TELEMETRY_PERIOD_MS = 5000;
+
+/** * @brief NetworkManager::update() period (ms). */
+const int NETWORK_UPDATE_MS = 1000;
+
 // --- Safety ---
 
 /** * @brief Max time without receiving UDP packets before activating Failsafe.
+ * Runtime knob: 'failsafe_ms'.
  * @details If 1000ms pass without valid commands, the software Watchdog
  * will stop the motors to prevent the robot from running away if WiFi is lost.
+ * With the link governor (section 10) this is the CEILING: the effective
+ * timeout follows the pilot's measured send interval.
  */
 const int UDP_FAILSAFE_MS = 1000;
+
+// =============================================================================
+// 4. NETWORK FAST-RECONNECT (STA BOOT OPTIMIZATION)
+// =============================================================================
+// After a successful association, the BSSID, channel and IP lease are stored in
+// NVS. The next boot performs a directed connect (no channel scan, no DHCP)
+// and only falls back to the full scan + DHCP path if it fails.
+
+/** * @brief Max wait for the directed (cached BSSID/channel) connection attempt.
+ * @details A directed connect normally completes in a few hundred ms.
+ * If the AP moved channel or was replaced, we give up quickly and rescan.
+ */
+const int WIFI_FAST_CONNECT_TIMEOUT_MS = 3000;
+
+/** * @brief Max wait for the full scan + DHCP connection attempt before AP failover.
+ */
+const int WIFI_CONNECT_TIMEOUT_MS = 10000;
+
+/** * @brief Reuse the cached DHCP lease as a static address on the fast path.
+ * @details Skips the DHCP handshake entirely (~0.5-2s saved).
+ * @warning Reserve the rover's MAC in the router's DHCP table, otherwise the
+ * cached address could be handed to another device while the rover was off.
+ */
+#define WIFI_FAST_CONNECT_REUSE_LEASE 1
+
+/** * @brief Fixed STA address (0 = use DHCP).
+ * @details When enabled, the static configuration below is used on both paths
+ * and the cached lease is ignored.
+ */
+#define WIFI_USE_STATIC_IP 0
+#define WIFI_STATIC_IP 192, 168, 1, 50
+#define WIFI_STATIC_GATEWAY 192, 168, 1, 1
+#define WIFI_STATIC_SUBNET 255, 255, 255, 0
+#define WIFI_STATIC_DNS 192, 168, 1, 1
+
+// =============================================================================
+// 5. DIAGNOSTICS (COMPILE-TIME SWITCHES)
+// =============================================================================
+
+/** * @brief Event tracing (Chrome/Perfetto JSON at '/trace').
+ * @details 0 = compiled out: every TRACE_* macro expands to nothing (zero overhead).
+ * Enable from platformio.ini: build_flags = -D ROVER_TRACE=1
+ */
+#ifndef ROVER_TRACE
+#define ROVER_TRACE 0
+#endif
+
+/** * @brief Heap audit: count every allocation made after boot ('/heap').
+ * @details 0 = '/heap' only reports free/largest blocks and fragmentation.
+ * 1 = the allocator is wrapped at link time and post-boot allocations are
+ * attributed to the watched tasks. Build with: pio run -e esp32cam_heapaudit
+ * @warning Setting it to 1 without the --wrap linker flags of that environment
+ * has no effect (the wrappers are never called).
+ */
+#ifndef ROVER_HEAP_AUDIT
+#define ROVER_HEAP_AUDIT 0
+#endif
+
+/** * @brief Abort (with backtrace) when a 'strict' watched task allocates after boot.
+ * @details Only meaningful with ROVER_HEAP_AUDIT=1. Use it to hunt the call site,
+ * never on a rover that is driving.
+ */
+#ifndef HEAP_AUDIT_ASSERT
+#define HEAP_AUDIT_ASSERT 0
+#endif
+
+/** * @brief Task monitor sampling period (ms).
+ * @details Each sample diffs the FreeRTOS run-time counters of every task.
+ * Per-task CPU % is meaningful only over a window: 2s smooths out frame bursts.
+ */
+const int TASKMON_PERIOD_MS = 2000;
+
+/** * @brief Serial baud rate (text boot logs + binary event log).
+ * @details The binary log is decoded on the PC: python -m tools.log_decoder
+ * At 921600 a 20-byte record takes ~0.2ms on the wire (vs ~1.7ms at 115200).
+ * @note Must match monitor_speed in platformio.ini.
+ */
+const unsigned long LOG_BAUD = 921600;
+
+/** * @brief Binary event log ring capacity (records, power of 2).
+ * @details 24 bytes per record. When full, new events are dropped and counted.
+ */
+#define LOG_RING_SIZE 64
+
+/** * @brief Max delay between an event and its transmission by the log task (ms). */
+const int LOG_FLUSH_MS = 20;
+
+/** * @brief Trace ring capacity per core (events, power of 2).
+ * @details 12 bytes per event. 512 -> 6KB per core of internal RAM.
+ */
+#define TRACE_EVENTS_PER_CORE 512
+
+// =============================================================================
+// 6. TASK LAYOUT (CORE AFFINITY AND PRIORITY)
+// =============================================================================
+// Core 0 (PRO) already hosts the IDF-internal tasks: WiFi driver (prio 23),
+// esp_timer (22), lwIP tcpip (18) and the camera DMA task 'cam_task'. Their
+// placement is fixed in sdkconfig (CONFIG_ESP32_WIFI_TASK_CORE_ID,
+// CONFIG_LWIP_TCPIP_TASK_AFFINITY, CONFIG_CAMERA_CORE*) and is NOT set here.
+// Core 1 (APP) is where Arduino normally puts everything else.
+//
+// Default layout: the control task owns Core 1 at a priority above every
+// application task, so a UDP command is applied as soon as lwIP delivers it.
+// Video (capture + send) lives next to the network stack it feeds on Core 0.
+// Compare layouts with 'examples/bench_control_jitter.cpp' before editing.
+
+/** * @brief Placement of one application task.
+ * @details core: 0, 1 or tskNO_AFFINITY (scheduler picks any free core).
+ * priority: FreeRTOS priority, 1 (lowest) to configMAX_PRIORITIES-1 (24).
+ * stack: stack depth in bytes.
+ */
+struct TaskPlacement
+{
+    BaseType_t core;
+    UBaseType_t priority;
+    uint32_t stack;
+};
+
+/** * @brief Control receiver: UDP/WebSocket commands, failsafe, network upkeep.
+ * @details Runs the event-driven Scheduler. Must preempt the video senders.
+ */
+const TaskPlacement TASK_CONTROL = {1, 10, 4096};
+
+/** * @brief HTTP server ('httpd'): request routing and WebSocket receive path.
+ * @details '/stream' only passes through here: the socket is handed to a
+ * stream sender, so this single worker stays free for the other endpoints.
+ * @note The IDF default is priority 5, no affinity, 4096 bytes of stack.
+ */
+const TaskPlacement TASK_HTTPD = {0, 5, 4096};
+
+/** * @brief MJPEG senders ('stream0'..): one per STREAM_MAX_CLIENTS, capture + send. */
+const TaskPlacement TASK_STREAM = {0, 5, 4096};
+
+/** * @brief WebSocket video pusher ('ws_video'): frame capture; the send is queued to httpd. */
+const TaskPlacement TASK_WS_VIDEO = {0, 5, 4096};
+
+/** * @brief High-resolution still ('still'): sensor switch, capture, upload.
+ * @details Same priority as the senders it pauses: it must win the frame buffer.
+ */
+const TaskPlacement TASK_STILL = {0, 5, 4096};
+
+/** * @brief One-shot camera probe at boot ('cam_init'), parallel to WiFi. */
+const TaskPlacement TASK_CAMERA_INIT = {0, 5, 4096};
+
+/** * @brief Serial heartbeat ([ALIVE]/[STATUS]).
+ * @details Even at LOG_BAUD (921600) a status line blocks ~1ms: kept off the control task.
+ */
+const TaskPlacement TASK_TELEMETRY = {1, 1, 3072};
+
+/** * @brief Binary event log encoder/writer ('eventlog').
+ * @details Lowest priority: a slow UART only delays the log, never its callers.
+ */
+const TaskPlacement TASK_EVENTLOG = {tskNO_AFFINITY, 1, 3072};
+
+/** * @brief Task monitor sampler ('taskmon'). */
+const TaskPlacement TASK_TASKMON = {tskNO_AFFINITY, 1, 3072};
+
+/** * @brief Parameter access over UDP ('params'): text requests + NVS writes.
+ * @details Lowest priority: a flash write must never delay control.
+ */
+const TaskPlacement TASK_PARAMS = {tskNO_AFFINITY, 1, 3072};
+
+/** * @brief Obstacle detector ('vision'): 1/8 JPEG decode + kernels.
+ * @details Core 1 is idle between control packets; priority 2 keeps it below
+ * control and away from the video senders on Core 0.
+ */
+const TaskPlacement TASK_VISION = {1, 2, 4096};
+
+// =============================================================================
+// 7. CAMERA SENSOR PROFILES
+// =============================================================================
+// Named OV2640 settings switchable at runtime ('/profile?name=...', table in
+// lib/CameraProfiles). In JPEG mode the frame buffers are sized for the frame
+// size given at init, so the driver starts at the LARGEST size it will ever
+// deliver (the still size) and the default profile shrinks it immediately.
+
+/** * @brief Largest stream profile size (PSRAM only).
+ * @details Profiles above it are rejected. Without PSRAM the limit is QVGA.
+ * Also sizes the obstacle detector buffers (1/8 of it, internal RAM).
+ */
+#define CAMERA_MAX_FRAMESIZE FRAMESIZE_SVGA
+
+/** * @brief Largest '/still' size; the frame buffers are allocated for it (PSRAM only).
+ * @details UXGA: ~375 KB per buffer (width x height / 5, the driver's JPEG
+ * bound), plus the same again for the still copy. A larger buffer costs the
+ * stream nothing: DMA only moves the bytes of each frame.
+ */
+#define CAMERA_STILL_MAX_FRAMESIZE FRAMESIZE_UXGA
+
+/** * @brief JPEG quality of a still when the request gives none (0-63, lower = better). */
+const uint8_t CAMERA_STILL_QUALITY = 10;
+
+/** * @brief Frames at the still size discarded before the capture.
+ * @details The first frame after a mode change (binned -> full UXGA) can be
+ * off in exposure while AEC adapts. Each extra frame costs one UXGA frame
+ * period (~150-250 ms) of stream pause: raise it only if stills come out dark.
+ */
+const int CAMERA_STILL_SETTLE_FRAMES = 1;
+
+/** * @brief Max frames waited for the sensor to deliver the still size (then 503). */
+const int CAMERA_STILL_MAX_FRAMES = 8;
+
+/** * @brief Profile applied at boot. */
+#define CAMERA_DEFAULT_PROFILE "fpv"
+
+// =============================================================================
+// 8. OBSTACLE DETECTION (VISION THROTTLE LIMIT)
+// =============================================================================
+// Optional vision stage (lib/ObstacleDetector). Every VISION_PERIOD_MS one
+// JPEG frame is decoded at 1/8 scale (QVGA -> 40x30 luma) and the lower part
+// of the image is scored:
+// - Edge density: share of pixels with a strong gradient (something close
+//   fills the bottom of the frame with texture/contours).
+// - Motion: share of pixels that changed since the previous decode.
+// Edges alone limit throttle to VISION_SLOW_PWM; edges AND motion (the scene
+// is looming while we drive) stop forward traction. Reverse is never limited.
+// Ratios are Q8 (256 = 100%). Tune live with 'http://rover.local/vision'.
+
+/** * @brief Compile-time switch. 0 = not built (no tap in the video path).
+ * Enable from platformio.ini: build_flags = -D ROVER_VISION=1
+ */
+#ifndef ROVER_VISION
+#define ROVER_VISION 0
+#endif
+
+/** * @brief Decode period (10 Hz). */
+const int VISION_PERIOD_MS = 100;
+
+/** * @brief First row of the scored region, in % of the height (60 = lower 40%). */
+const int VISION_ROI_START_PCT = 60;
+
+/** * @brief Luma step (0-255) counted as motion for one pixel. */
+const int VISION_DIFF_THRESHOLD = 24;
+
+/** * @brief Gradient |dx|+|dy| counted as an edge for one pixel. */
+const int VISION_EDGE_THRESHOLD = 40;
+
+/** * @brief Edge density (Q8) that limits throttle to VISION_SLOW_PWM (25%). */
+const uint16_t VISION_EDGE_SLOW_Q8 = 64;
+
+/** * @brief Edge density (Q8) that, with motion, stops forward traction (45%). */
+const uint16_t VISION_EDGE_STOP_Q8 = 115;
+
+/** * @brief Motion share (Q8) that marks the scene as looming (20%). */
+const uint16_t VISION_MOTION_LOOM_Q8 = 51;
+
+/** * @brief Throttle cap (PWM) while an obstacle is near. */
+const uint8_t VISION_SLOW_PWM = 120;
+
+/** * @brief Consecutive clear decodes before the limit is released (hysteresis). */
+const int VISION_CLEAR_FRAMES = 3;
+
+/** * @brief Without video consumers for this long, the stage captures its own frames. */
+const uint32_t VISION_IDLE_CAPTURE_MS = 1000;
+
+/** * @brief Largest JPEG copied for analysis (PSRAM buffer). Bigger frames are skipped. */
+const size_t VISION_JPEG_MAX = 32768;
+
+// =============================================================================
+// 9. RUNTIME PARAMETERS (NVS, LIVE APPLY)
+// =============================================================================
+// Tuning knobs registered in lib/ParamRegistry at boot. The constants in this
+// file are the DEFAULTS: a value set over HTTP ('/params') or UDP is applied
+// immediately and stored in NVS, so it survives reboots until reset.
+
+/** * @brief UDP port of the text parameter protocol (list/get/set/reset).
+ * @note Separate from UDP_PORT: control datagrams stay a fixed binary layout.
+ */
+const int PARAM_UDP_PORT = 9998;
+
+/** * @brief Max registered parameters (fixed table). */
+const int PARAM_MAX = 24;
+
+/** * @brief Max wait for the control task to apply an actuator knob (ms).
+ * @note Steering and motor PWM knobs are applied by the control task between
+ * two commands; the setter fails if the loop does not take them in time.
+ */
+const uint32_t PARAM_APPLY_TIMEOUT_MS = 200;
+
+// =============================================================================
+// 10. LINK GOVERNOR (THROTTLE VS. LINK QUALITY)
+// =============================================================================
+// RemoteControl tracks the command inter-arrival time (smoothed mean and
+// deviation, like TCP's RTO estimator) and the pilot's RSSI. The failsafe
+// timeout is derived from the observed interval, and the forward throttle
+// is capped progressively as packets go late or the signal weakens.
+// Runtime knob: 'link_governor' (0 = fixed UDP_FAILSAFE_MS, no throttle cap).
+
+/** * @brief Period of the RSSI sample / quality re-evaluation (ms). */
+const uint32_t LINK_UPDATE_MS = 100;
+
+/** * @brief Consecutive send intervals that may be lost before the failsafe trips.
+ * @details Timeout = LINK_MISS_TOLERANCE * mean + 4 * deviation
+ * (client at 200 ms: ~600 ms instead of 1000 ms, i.e. 3 lost packets, not 5).
+ */
+const int LINK_MISS_TOLERANCE = 3;
+
+/** * @brief Floor of the adaptive failsafe timeout (ms).
+ * @details Keeps a fast client (e.g. 20 ms) from tripping on one WiFi retry burst.
+ */
+const uint32_t LINK_FAILSAFE_MIN_MS = 150;
+
+/** * @brief Intervals observed before the adaptive timeout replaces the ceiling.
+ * @details Until then (new pilot, after a failsafe) UDP_FAILSAFE_MS applies.
+ */
+const int LINK_MIN_SAMPLES = 8;
+
+/** * @brief RSSI at or above which the signal does not limit throttle (dBm). */
+const int LINK_RSSI_GOOD = -65;
+
+/** * @brief RSSI at or below which throttle is held at LINK_MIN_THROTTLE (dBm). */
+const int LINK_RSSI_BAD = -85;
+
+/** * @brief Forward PWM cap at zero link quality (last moments before the failsafe).
+ * @details Low enough to stop quickly, high enough to keep crawling out of a dead spot.
+ */
+const uint8_t LINK_MIN_THROTTLE = 70;
+
+// =============================================================================
+// 11. WEB PILOT UI (LITTLEFS, PRE-COMPRESSED)
+// =============================================================================
+// Static files built by 'python -m tools.build_webui' (gzip -9, from
+// 'firmware/web/') into 'firmware/data/', flashed with 'pio run -t uploadfs'.
+// Served by the existing httpd with 'Content-Encoding: gzip' and strong ETags.
+
+/** * @brief Bytes read from flash and sent per HTTP chunk (static buffer, no heap).
+ * @details One buffer is enough: httpd runs its handlers on a single task.
+ */
+const size_t WEBUI_CHUNK_SIZE = 2048;
+
+/** * @brief Max files indexed at boot (root 'index.html.gz' + '/ui/' assets). */
+const int WEBUI_MAX_FILES = 8;
+
+/** * @brief Browser cache lifetime of '/ui/' assets (s).
+ * @details The page itself ('/') is always revalidated (ETag -> 304), so a
+ * reflashed UI shows up on the next load; assets are reused without a request.
+ */
+const uint32_t WEBUI_ASSET_MAX_AGE_S = 604800; // 7 days
+
+// =============================================================================
+// 12. POWER GOVERNOR (TEMPERATURE, SUPPLY DROOP, RSSI)
+// =============================================================================
+// Replaces the fixed cool-down workarounds (commented-out 11 dBm TX power,
+// hand-picked frame gap). Every POWER_UPDATE_MS lib/PowerGovernor reads the
+// die temperature and the brown-out comparator, and picks a step of
+// POWER_STEPS. The step bounds the CPU clock, the WiFi TX power and adds a
+// pause between video frames. Within those bounds:
+// - CPU: ceiling while streaming or piloted, POWER_CPU_IDLE_MHZ otherwise.
+// - TX power: lowest level that keeps the estimated uplink at POWER_RSSI_TARGET.
+// Runtime knobs: 'power_governor' (0 = max performance, fixed) and
+// 'power_temp_offset' (sensor calibration, degC added to the reading).
+
+/** * @brief One thermal step: entered at 'tempC', left below tempC - POWER_TEMP_HYST_C.
+ * @details cpuMhz: 240, 160 or 80 (WiFi needs >= 80).
+ * txMaxQdbm: TX power ceiling in 0.25 dBm (78 = 19.5 dBm, the driver maximum).
+ * frameGapMs: pause added to 'stream_gap_ms' between video frames.
+ */
+struct PowerStep
+{
+    int8_t tempC;
+    uint16_t cpuMhz;
+    int8_t txMaxQdbm;
+    uint16_t frameGapMs;
+};
+
+/** * @brief Steps in rising temperature order (index = reported level).
+ * @note The ESP32 sensor is uncalibrated (up to +/-10 degC between chips):
+ * measure the idle reading once and set 'power_temp_offset' instead of
+ * editing these thresholds.
+ */
+const PowerStep POWER_STEPS[] = {
+    {-128, 240, 78, 0}, // 0 NORMAL:   full clock, 19.5 dBm
+    {65, 240, 60, 20},  // 1 WARM:     15 dBm, ~-30% frames
+    {75, 160, 52, 60},  // 2 HOT:      13 dBm, ~half the frames
+    {85, 80, 44, 150},  // 3 CRITICAL: 11 dBm (the old cool-down value), a few fps
+};
+
+/** * @brief Temperature drop needed to leave a step (degC). */
+const int POWER_TEMP_HYST_C = 4;
+
+/** * @brief Governor period (ms). Temperature moves in seconds: 1 Hz is plenty. */
+const uint32_t POWER_UPDATE_MS = 1000;
+
+/** * @brief CPU clock while nobody streams or pilots (MHz). */
+const uint16_t POWER_CPU_IDLE_MHZ = 80;
+
+/** * @brief Lowest TX power the governor may select (0.25 dBm; 34 = 8.5 dBm). */
+const int8_t POWER_TX_MIN_QDBM = 34;
+
+/** * @brief Estimated uplink RSSI to keep when lowering TX power (dBm).
+ * @details Uplink ~= pilot RSSI - (19.5 dBm - TX power): assumes a symmetric
+ * path. -67 dBm still carries the high 802.11n rates the video needs.
+ */
+const int POWER_RSSI_TARGET = -67;
+
+/** * @brief Extra margin required before stepping TX power down (dB, hysteresis). */
+const int POWER_RSSI_HYST = 3;
+
+/** * @brief Brown-out comparator level used as droop indicator (0..7, 7 = ~2.74 V).
+ * @details The detector runs without reset or interrupt: PowerGovernor::begin()
+ * masks the core's brown-out ISR (it restarts the chip) and arms the comparator
+ * with the reset bit off, so WiFi and motor spikes only latch a raw flag the
+ * governor polls.
+ */
+const uint8_t POWER_DROOP_THRESHOLD = 7;
+
+/** * @brief Time a supply droop keeps the governor at POWER_DROOP_STEP or above (ms). */
+const uint32_t POWER_DROOP_HOLD_MS = 10000;
+
+/** * @brief Minimum step while a droop is recent (1 = WARM: TX peaks cut to 15 dBm). */
+const int POWER_DROOP_STEP = 1;
@@ -0,0 +1,132 @@
+/**
+ * @file control_protocol.h
+ * @brief Control Datagram Codec (Firmware + Host Tools).
+ * @details Single Source of Truth for the control packet layout. Header-only,
+ * no Arduino dependency: the firmware (RemoteControl, WebSocket path) and host
+ * C++ tools compile the same definitions, and 'software/tools/gen_protocol.py'
+ * generates the Python client module ('software/modules/Protocol.py') from the
+ * constants below.
+ *
+ * --- WIRE LAYOUT (UDP datagram or WebSocket binary frame) ---
+ * | Offset | Size    | Field    | Values                                        |
+ * | 0      | 1       | Traction | 0 = Coast, 1 = Brake, 2-255 = PWM forward     |
+ * | 1      | 1       | Steering | 0-180 = Servo angle                           |
+ * | 2      | 0..16   | Probe    | Opaque token, echoed once the command applied |
+ *
+ * --- RULES ---
+ * - Changing the layout means bumping VERSION (advertised over mDNS, TXT 'proto').
+ * - Constants are 'constexpr <type> NAME = <integer>;' on one line: the Python
+ *   generator parses exactly that form.
+ * - Regenerate after editing: 'python -m tools.gen_protocol' (from 'software/').
+ *
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ControlProtocol
+{
+    // =========================================================================
+    // 1. LAYOUT (constexpr: usable for buffer sizes and static_assert)
+    // =========================================================================
+
+    /** @brief Protocol revision. Clients refuse a rover speaking a newer one. */
+    constexpr int VERSION = 1;
+
+    constexpr size_t TRACTION_OFFSET = 0; ///< Byte offset of the traction code
+    constexpr size_t STEERING_OFFSET = 1; ///< Byte offset of the steering angle
+    constexpr size_t COMMAND_SIZE = 2;    ///< Mandatory part of every packet
+    constexpr size_t PROBE_OFFSET = 2;    ///< Optional probe token starts here
+    constexpr size_t PROBE_MAX = 16;      ///< Longest probe token accepted
+    constexpr size_t PACKET_MAX = 18;     ///< COMMAND_SIZE + PROBE_MAX (receive buffers)
+
+    // =========================================================================
+    // 2. FIELD VALUES
+    // =========================================================================
+
+    constexpr uint8_t TRACTION_COAST = 0;   ///< Release throttle (inertia)
+    constexpr uint8_t TRACTION_BRAKE = 1;   ///< Active brake
+    constexpr uint8_t TRACTION_PWM_MIN = 2; ///< Lowest forward PWM code
+    constexpr uint8_t STEERING_MAX = 180;   ///< Highest servo angle
+    constexpr uint8_t STEERING_STRAIGHT = 90; ///< Nominal straight-ahead angle (before calibration)
+
+    static_assert(PROBE_OFFSET == COMMAND_SIZE, "Probe must follow the command bytes");
+    static_assert(PACKET_MAX == COMMAND_SIZE + PROBE_MAX, "PACKET_MAX out of sync");
+    static_assert(TRACTION_OFFSET < COMMAND_SIZE && STEERING_OFFSET < COMMAND_SIZE,
+                  "Command fields must lie inside COMMAND_SIZE");
+
+    // =========================================================================
+    // 3. DECODE (zero-copy view over received bytes)
+    // =========================================================================
+
+    /**
+     * @brief Read-only view of one received packet. Never copies the bytes.
+     * @details The view is only valid while the underlying buffer is.
+     * Accessors assume valid() (checked once by the caller).
+     */
+    class PacketView
+    {
+    private:
+        const uint8_t *_data; ///< First byte of the packet
+        size_t _size;         ///< Received length
+
+    public:
+        constexpr PacketView(const uint8_t *data, size_t size) : _data(data), _size(size) {}
+
+        /** @brief true if the packet carries a command (probe length is not checked). */
+        constexpr bool valid() const { return _data != nullptr && _size >= COMMAND_SIZE; }
+
+        /** @brief Byte[0]: 0=Coast, 1=Brake, 2-255=PWM. */
+        constexpr uint8_t traction() const { return _data[TRACTION_OFFSET]; }
+
+        /** @brief Byte[1]: servo angle (range enforced by SteeringServo). */
+        constexpr uint8_t steering() const { return _data[STEERING_OFFSET]; }
+
+        /** @brief Probe token bytes (nullptr if none). */
+        constexpr const uint8_t *probe() const { return probeSize() ? _data + PROBE_OFFSET : nullptr; }
+
+        /** @brief Probe token length (0 = plain command, no reply expected). */
+        constexpr size_t probeSize() const { return _size > COMMAND_SIZE ? _size - COMMAND_SIZE : 0; }
+    };
+
+    // =========================================================================
+    // 4. ENCODE
+    // =========================================================================
+
+    /**
+     * @brief Writes a packet into a caller-owned buffer.
+     * @param out Destination (at least COMMAND_SIZE + probeLen bytes).
+     * @param capacity Size of 'out'.
+     * @param traction Byte[0] value.
+     * @param steering Byte[1] value.
+     * @param probe Optional token (nullptr = none).
+     * @param probeLen Token length (max PROBE_MAX).
+     * @return Bytes written, or 0 if the packet does not fit / token too long.
+     */
+    inline size_t encode(uint8_t *out, size_t capacity, uint8_t traction, uint8_t steering,
+                         const uint8_t *probe = nullptr, size_t probeLen = 0)
+    {
+        if (probeLen > PROBE_MAX || (probeLen && !probe) || capacity < COMMAND_SIZE + probeLen)
+        {
+            return 0;
+        }
+
+        out[TRACTION_OFFSET] = traction;
+        out[STEERING_OFFSET] = steering;
+        for (size_t i = 0; i < probeLen; i++)
+        {
+            out[PROBE_OFFSET + i] = probe[i];
+        }
+        return COMMAND_SIZE + probeLen;
+    }
+
+    // Compile-time round trip of the decoder against a literal packet
+    constexpr uint8_t SELF_TEST[] = {TRACTION_BRAKE, STEERING_STRAIGHT, 0xAA};
+    static_assert(PacketView(SELF_TEST, 3).valid() && PacketView(SELF_TEST, 3).traction() == TRACTION_BRAKE &&
+                      PacketView(SELF_TEST, 3).steering() == STEERING_STRAIGHT &&
+                      PacketView(SELF_TEST, 3).probeSize() == 1,
+                  "PacketView does not decode the documented layout");
+    static_assert(!PacketView(SELF_TEST, 1).valid(), "Short packets must be rejected");
+}
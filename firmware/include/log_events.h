@@ -0,0 +1,38 @@
+/**
+ * @file log_events.h
+ * @brief Structured Log Event Table (Firmware + Host Decoder).
+ * @details Single Source of Truth for the binary log: each entry becomes a
+ * LogEvent ID (its position in the table) and the format string the host
+ * rebuilds the text with ('software/tools/log_decoder.py' parses this file).
+ *
+ * --- RULES ---
+ * - APPEND ONLY: IDs are positions. Reordering breaks old captures.
+ * - Up to 3 integer arguments per event (%d/%i signed, %u/%x unsigned).
+ * - No strings (%s): only the raw 32-bit arguments travel over the wire.
+ *
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#pragma once
+#include <stdint.h>
+
+// X(NAME, "format")
+#define ROVER_LOG_EVENTS(X)                                                                       \
+    X(LOG_DROPPED, "[LOG] %u events dropped (ring full)")                                         \
+    X(LOG_MOTOR_RANGE, "[ERROR] Motor: Speed %d out of range. Ignored.")                          \
+    X(LOG_MOTOR_REVERSE, "[WARN] Reverse requested. Blocked for safety.")                         \
+    X(LOG_FAILSAFE_TRIP, "[FAILSAFE] Signal Lost (%u ms silent, timeout %u ms). EMERGENCY STOP.") \
+    X(LOG_SIGNAL_RECOVERED, "[UDP] Signal recovered. Control reactivated.")                       \
+    X(LOG_VISION_LIMIT, "[VISION] Throttle limit %u (edges %u/256, motion %u/256)")               \
+    X(LOG_POWER_STEP, "[POWER] Step %u (temp %d C, droops %u)")                                   \
+    X(LOG_POWER_CPU, "[POWER] CPU %u MHz (ceiling %u MHz, busy %u)")                              \
+    X(LOG_POWER_TX, "[POWER] TX power %u/4 dBm (RSSI %d dBm)")
+
+/** @brief Log event identifiers (wire value = position in ROVER_LOG_EVENTS). */
+enum LogEvent : uint16_t
+{
+#define LOG_EVENT_ENUM(name, fmt) name,
+    ROVER_LOG_EVENTS(LOG_EVENT_ENUM)
+#undef LOG_EVENT_ENUM
+        LOG_EVENT_COUNT
+};
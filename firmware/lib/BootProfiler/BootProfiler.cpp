@@ -0,0 +1,115 @@
+/**
+ * @file BootProfiler.cpp
+ * @brief Boot Timeline Recorder Implementation.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "BootProfiler.h"
+
+BootProfiler::BootProfiler()
+{
+    _count = 0;
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+int BootProfiler::begin(const char *name)
+{
+    int64_t now = esp_timer_get_time();
+    int id = -1;
+
+    portENTER_CRITICAL(&_lock);
+    if (_count < MAX_PHASES)
+    {
+        id = _count++;
+        _phases[id].name = name;
+        _phases[id].startUs = now;
+        _phases[id].endUs = -1;
+        _phases[id].core = (uint8_t)xPortGetCoreID();
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    return id;
+}
+
+void BootProfiler::end(int id)
+{
+    if (id < 0 || id >= MAX_PHASES)
+    {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&_lock);
+    _phases[id].endUs = now;
+    portEXIT_CRITICAL(&_lock);
+}
+
+void BootProfiler::mark(const char *name)
+{
+    end(begin(name));
+}
+
+int64_t BootProfiler::getTime(const char *name)
+{
+    int64_t t = -1;
+
+    portENTER_CRITICAL(&_lock);
+    for (int i = 0; i < _count; i++)
+    {
+        if (strcmp(_phases[i].name, name) == 0)
+        {
+            t = _phases[i].endUs;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    return t;
+}
+
+void BootProfiler::printReport()
+{
+    Serial.println("------------------------------------------------");
+    Serial.println("[BOOT] Timeline (ms since timer start)");
+    Serial.println("[BOOT] PHASE              CORE   START     END   DURATION");
+
+    for (int i = 0; i < _count; i++)
+    {
+        const Phase &p = _phases[i];
+        if (p.endUs < 0)
+        {
+            Serial.printf("[BOOT] %-18s %4u %7lu   (running)\n",
+                          p.name, p.core, (unsigned long)(p.startUs / 1000));
+            continue;
+        }
+        Serial.printf("[BOOT] %-18s %4u %7lu %7lu %8lu\n",
+                      p.name, p.core,
+                      (unsigned long)(p.startUs / 1000),
+                      (unsigned long)(p.endUs / 1000),
+                      (unsigned long)((p.endUs - p.startUs) / 1000));
+    }
+    Serial.println("------------------------------------------------");
+}
+
+esp_err_t BootProfiler::httpHandler(httpd_req_t *req)
+{
+    BootProfiler *self = (BootProfiler *)req->user_ctx;
+    char line[128];
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send_chunk(req, "{\"unit\":\"us\",\"phases\":[", HTTPD_RESP_USE_STRLEN);
+
+    // Entries are append-only, so a racy read of _count only hides the newest one.
+    int count = self->_count;
+    for (int i = 0; i < count; i++)
+    {
+        const Phase &p = self->_phases[i];
+        int len = snprintf(line, sizeof(line),
+                           "%s{\"name\":\"%s\",\"core\":%u,\"start\":%lld,\"end\":%lld}",
+                           (i > 0) ? "," : "", p.name, p.core, (long long)p.startUs, (long long)p.endUs);
+        httpd_resp_send_chunk(req, line, len);
+    }
+
+    httpd_resp_send_chunk(req, "]}", HTTPD_RESP_USE_STRLEN);
+    return httpd_resp_send_chunk(req, NULL, 0); // End of chunked response
+}
@@ -0,0 +1,86 @@
+/**
+ * @file BootProfiler.h
+ * @brief Boot Timeline Recorder (Phase Timestamps + Report).
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * Records the start/end of each boot phase with 'esp_timer_get_time()' (us since
+ * the high-resolution timer started, i.e. shortly after the 2nd stage bootloader).
+ * Phases can be opened from different tasks/cores, which makes parallel
+ * initialization visible: overlapping intervals are expected.
+ * The report is printed to Serial and served as JSON via HTTP ('/boot').
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "esp_http_server.h"
+
+class BootProfiler
+{
+public:
+    /** @brief Max number of recorded phases (fixed table, no heap). */
+    static const int MAX_PHASES = 16;
+
+private:
+    /**
+     * @brief One timeline entry.
+     * @note endUs == startUs for instantaneous milestones (mark()).
+     */
+    struct Phase
+    {
+        const char *name; ///< Static string (not copied)
+        int64_t startUs;  ///< Start timestamp (us)
+        int64_t endUs;    ///< End timestamp (us), -1 while running
+        uint8_t core;     ///< CPU that opened the phase
+    };
+
+    Phase _phases[MAX_PHASES];
+    int _count;
+    portMUX_TYPE _lock; ///< Spinlock: phases are opened from both cores
+
+public:
+    /**
+     * @brief Constructor. Starts with an empty timeline.
+     */
+    BootProfiler();
+
+    /**
+     * @brief Opens a timed phase.
+     * @param name Static label (must outlive the profiler, e.g. a literal).
+     * @return Phase handle for end(), or -1 if the table is full.
+     */
+    int begin(const char *name);
+
+    /**
+     * @brief Closes a phase opened with begin().
+     * @param id Handle returned by begin(). Negative values are ignored.
+     */
+    void end(int id);
+
+    /**
+     * @brief Records an instantaneous milestone (e.g. "drivable").
+     * @param name Static label.
+     */
+    void mark(const char *name);
+
+    /**
+     * @brief Returns the timestamp of a milestone or phase end.
+     * @param name Label used in begin()/mark().
+     * @return Timestamp in us, or -1 if not found / still running.
+     */
+    int64_t getTime(const char *name);
+
+    /**
+     * @brief Prints the timeline as a table to Serial.
+     */
+    void printReport();
+
+    /**
+     * @brief HTTP handler serving the timeline as JSON.
+     * @details Register with 'user_ctx' pointing to the BootProfiler instance.
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t Operation status.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+};
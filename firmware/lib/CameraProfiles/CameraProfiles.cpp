@@ -0,0 +1,265 @@
+/**
+ * @file CameraProfiles.cpp
+ * @brief Sensor Profile Table, Live Apply and '/profile' Endpoint.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "CameraProfiles.h"
+#include "esp_timer.h"
+#include "Metrics.h"
+
+// =============================================================================
+// PROFILE TABLE
+// =============================================================================
+// XCLK: the OV2640 frame period scales with 1/XCLK. 20MHz is the datasheet
+// nominal, 15MHz was the historic "cool-down" value, 10MHz doubles the maximum
+// exposure time (night). Windowed profiles crop the CIF (400x296, 2x
+// sub-sampled) sensor mode 1:1: no downscaler and fewer bytes per frame.
+
+static const SensorProfile PROFILES[] = {
+    // name       framesize       q   xclk gain             aec2   ae  win    x   y   w    h    out
+    {"fpv",       FRAMESIZE_QVGA, 60, 15, GAINCEILING_2X,  false, 0, false, 0,  0,  0,   0,   0,   0},
+    {"fpv_fast",  FRAMESIZE_QVGA, 50, 20, GAINCEILING_2X,  false, 0, true,  40, 68, 320, 160, 320, 160},
+    {"balanced",  FRAMESIZE_VGA,  30, 20, GAINCEILING_4X,  false, 0, false, 0,  0,  0,   0,   0,   0},
+    {"detail",    FRAMESIZE_SVGA, 12, 20, GAINCEILING_4X,  false, 0, false, 0,  0,  0,   0,   0,   0},
+    {"night",     FRAMESIZE_CIF,  25, 10, GAINCEILING_32X, true,  2, false, 0,  0,  0,   0,   0,   0},
+};
+static const int PROFILE_COUNT = sizeof(PROFILES) / sizeof(PROFILES[0]);
+
+/** @brief Last measured capture FPS (x10) per profile. 0 = never measured. */
+static uint16_t measuredFpsX10[PROFILE_COUNT];
+
+/** @brief LEDC timer driving XCLK (must match camera_config_t in CameraServer::init). */
+static const int XCLK_LEDC_TIMER = LEDC_TIMER_0;
+
+/**
+ * @brief set_res_raw() 'startX' value selecting the CIF readout.
+ * @details esp32-camera's ov2640_sensor_mode_t: UXGA = 0, SVGA = 1, CIF = 2.
+ */
+static const int OV2640_MODE_CIF = 2;
+
+/**
+ * @brief Window rules of the CIF readout: inside 400x296, sizes in multiples
+ * of 4 (the DSP registers hold size / 4), output not larger than the window.
+ */
+static bool windowValid(const SensorProfile &p)
+{
+    const resolution_info_t &cif = resolution[FRAMESIZE_CIF];
+    return p.winW > 0 && p.winH > 0 && p.winX + p.winW <= cif.width && p.winY + p.winH <= cif.height &&
+           p.winW % 4 == 0 && p.winH % 4 == 0 && p.outW % 4 == 0 && p.outH % 4 == 0 &&
+           p.outW <= p.winW && p.outH <= p.winH;
+}
+
+framesize_t CameraProfiles::_maxFramesize = FRAMESIZE_QVGA;
+framesize_t CameraProfiles::_bufferFramesize = FRAMESIZE_QVGA;
+int CameraProfiles::_active = -1;
+uint8_t CameraProfiles::_xclkMhz = 0;
+uint32_t CameraProfiles::_framesAtApply = 0;
+int64_t CameraProfiles::_appliedUs = 0;
+int CameraProfiles::_overrides[OVERRIDE_COUNT] = {-1, -1, -1};
+SemaphoreHandle_t CameraProfiles::_lock = NULL;
+
+void CameraProfiles::begin(framesize_t maxFramesize, framesize_t bufferFramesize)
+{
+    _maxFramesize = maxFramesize;
+    _bufferFramesize = bufferFramesize;
+    _lock = xSemaphoreCreateRecursiveMutex();
+    sensor_t *s = esp_camera_sensor_get();
+    _xclkMhz = s ? (uint8_t)(s->xclk_freq_hz / 1000000) : 0;
+}
+
+uint16_t CameraProfiles::liveFpsX10()
+{
+    int64_t elapsed = esp_timer_get_time() - _appliedUs;
+    if (_active < 0 || elapsed <= 0)
+        return 0;
+    uint32_t frames = Metrics::framesCaptured.get() - _framesAtApply;
+    return (uint16_t)((uint64_t)frames * 10000000ULL / elapsed);
+}
+
+void CameraProfiles::closeWindow()
+{
+    // Keep the previous figure if the profile was active while nobody watched
+    uint16_t fps = liveFpsX10();
+    if (_active >= 0 && fps > 0)
+        measuredFpsX10[_active] = fps;
+}
+
+bool CameraProfiles::apply(const char *name)
+{
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    bool ok = applyLocked(name);
+    xSemaphoreGiveRecursive(_lock);
+    return ok;
+}
+
+bool CameraProfiles::enterStill(framesize_t framesize, uint8_t quality)
+{
+    // Lock first: '/profile' or setOverride() may change _active otherwise
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    sensor_t *s = esp_camera_sensor_get();
+    if (!s || framesize > _bufferFramesize || _active < 0)
+    {
+        xSemaphoreGiveRecursive(_lock);
+        return false;
+    }
+
+    // Geometry and compression only: XCLK and exposure stay as the profile set them
+    if (s->set_framesize(s, framesize) != 0 || s->set_quality(s, quality) != 0)
+    {
+        applyLocked(PROFILES[_active].name);
+        xSemaphoreGiveRecursive(_lock);
+        return false;
+    }
+    return true;
+}
+
+void CameraProfiles::exitStill()
+{
+    applyLocked(PROFILES[_active].name);
+    xSemaphoreGiveRecursive(_lock);
+}
+
+bool CameraProfiles::applyLocked(const char *name)
+{
+    // 1. LOOKUP AND VALIDATION
+    int idx = -1;
+    for (int i = 0; i < PROFILE_COUNT; i++)
+    {
+        if (strcmp(PROFILES[i].name, name) == 0)
+            idx = i;
+    }
+    if (idx < 0)
+        return false;
+
+    // Effective settings: the profile, unless a runtime parameter pins them
+    const SensorProfile &p = PROFILES[idx];
+    framesize_t framesize = _overrides[OVERRIDE_FRAMESIZE] >= 0 ? (framesize_t)_overrides[OVERRIDE_FRAMESIZE] : p.framesize;
+    bool windowed = p.windowed && _overrides[OVERRIDE_FRAMESIZE] < 0;
+    uint8_t quality = _overrides[OVERRIDE_QUALITY] >= 0 ? _overrides[OVERRIDE_QUALITY] : p.quality;
+    uint8_t xclkMhz = _overrides[OVERRIDE_XCLK] > 0 ? _overrides[OVERRIDE_XCLK] : p.xclkMhz;
+
+    if (windowed && !windowValid(p))
+    {
+        Serial.printf("[CAM] Profile '%s': window outside the CIF sensor area.\n", p.name);
+        return false;
+    }
+
+    const resolution_info_t &max = resolution[_maxFramesize];
+    bool fits = windowed ? (uint32_t)p.outW * p.outH <= (uint32_t)max.width * max.height
+                         : framesize <= _maxFramesize;
+    if (!fits)
+    {
+        Serial.printf("[CAM] Profile '%s' exceeds frame buffers.\n", p.name);
+        return false;
+    }
+
+    sensor_t *s = esp_camera_sensor_get();
+    if (!s)
+        return false;
+
+    // 2. TIMING (XCLK): only touched when it changes (re-programs the LEDC timer)
+    int err = 0;
+    if (xclkMhz != _xclkMhz)
+    {
+        err |= s->set_xclk(s, XCLK_LEDC_TIMER, xclkMhz);
+        _xclkMhz = xclkMhz;
+    }
+
+    // 3. GEOMETRY: standard frame size, or raw window of the CIF readout cropped 1:1
+    if (windowed)
+    {
+        err |= s->set_res_raw(s, OV2640_MODE_CIF, 0, 0, 0, p.winX, p.winY, p.winW, p.winH, p.outW, p.outH, false, false);
+    }
+    else
+    {
+        err |= s->set_framesize(s, framesize);
+    }
+
+    // 4. COMPRESSION AND EXPOSURE
+    err |= s->set_quality(s, quality);
+    err |= s->set_gain_ctrl(s, 1);
+    err |= s->set_gainceiling(s, p.gainCeiling);
+    err |= s->set_exposure_ctrl(s, 1);
+    err |= s->set_aec2(s, p.aec2 ? 1 : 0);
+    err |= s->set_ae_level(s, p.aeLevel);
+
+    // 5. FPS ACCOUNTING (new window starts now)
+    closeWindow();
+    _active = idx;
+    _framesAtApply = Metrics::framesCaptured.get();
+    _appliedUs = esp_timer_get_time();
+
+    Serial.printf("[CAM] Profile: %s (q%u, %uMHz)%s\n", p.name, quality, xclkMhz,
+                  err ? " SENSOR ERROR" : "");
+    return err == 0;
+}
+
+bool CameraProfiles::setOverride(ProfileOverride what, int value)
+{
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    int previous = _overrides[what];
+    bool ok = true;
+
+    // Not applied yet (boot): the value is picked up by the first apply()
+    _overrides[what] = value;
+    if (value != previous && _active >= 0 && !applyLocked(PROFILES[_active].name))
+    {
+        _overrides[what] = previous;
+        applyLocked(PROFILES[_active].name);
+        ok = false;
+    }
+    xSemaphoreGiveRecursive(_lock);
+    return ok;
+}
+
+const char *CameraProfiles::active()
+{
+    return _active >= 0 ? PROFILES[_active].name : "none";
+}
+
+esp_err_t CameraProfiles::httpHandler(httpd_req_t *req)
+{
+    char query[48];
+    char name[16];
+    char line[192];
+    bool switched = false;
+    bool ok = true;
+
+    // 1. OPTIONAL SWITCH ('?name=<key>')
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "name", name, sizeof(name)) == ESP_OK)
+    {
+        switched = true;
+        ok = apply(name);
+    }
+
+    // 2. REPORT
+    httpd_resp_set_type(req, "application/json");
+    if (switched && !ok)
+        httpd_resp_set_status(req, "400 Bad Request");
+
+    uint16_t live = liveFpsX10();
+    int len = snprintf(line, sizeof(line), "{\"active\":\"%s\",\"switched\":%s,\"live_fps\":%u.%u,"
+                       "\"overrides\":{\"quality\":%d,\"framesize\":%d,\"xclk_mhz\":%d},\"profiles\":[",
+                       active(), (switched && ok) ? "true" : "false", live / 10, live % 10,
+                       _overrides[OVERRIDE_QUALITY], _overrides[OVERRIDE_FRAMESIZE], _overrides[OVERRIDE_XCLK]);
+    httpd_resp_send_chunk(req, line, len);
+
+    for (int i = 0; i < PROFILE_COUNT; i++)
+    {
+        const SensorProfile &p = PROFILES[i];
+        uint16_t fps = (i == _active && live > 0) ? live : measuredFpsX10[i];
+        unsigned w = p.windowed ? p.outW : resolution[p.framesize].width;
+        unsigned h = p.windowed ? p.outH : resolution[p.framesize].height;
+        len = snprintf(line, sizeof(line),
+                       "%s{\"name\":\"%s\",\"width\":%u,\"height\":%u,\"quality\":%u,\"xclk_mhz\":%u,"
+                       "\"windowed\":%s,\"fps\":%u.%u}",
+                       i ? "," : "", p.name, w, h, p.quality, p.xclkMhz,
+                       p.windowed ? "true" : "false", fps / 10, fps % 10);
+        httpd_resp_send_chunk(req, line, len);
+    }
+
+    httpd_resp_send_chunk(req, "]}", HTTPD_RESP_USE_STRLEN);
+    return httpd_resp_send_chunk(req, NULL, 0); // End of chunked response
+}
@@ -0,0 +1,135 @@
+/**
+ * @file CameraProfiles.h
+ * @brief Runtime OV2640 Sensor Profiles (FPV / Balanced / Detail / Night / Windowed).
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * Replaces the hand-tuned constants of CameraServer::init() with a table of
+ * named profiles applied through the 'sensor_t' interface while streaming:
+ * frame size, JPEG quality, XCLK, gain ceiling, AEC mode/level and optional
+ * sensor windowing (CIF sub-sampled mode + crop via set_res_raw).
+ *
+ * The stream is not restarted: clients simply receive differently sized JPEGs
+ * from the next frame on. Capture FPS is measured per profile (frames delivered
+ * by the driver while the profile was active) and reported at '/profile'.
+ *
+ * @note FPS is only measured while someone consumes frames (/stream or /ws).
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "esp_camera.h"
+#include "esp_http_server.h"
+#include "config.h"
+
+/**
+ * @brief One named sensor configuration.
+ */
+struct SensorProfile
+{
+    const char *name;          ///< Key used in '/profile?name='
+    framesize_t framesize;     ///< Output size (ignored when windowed)
+    uint8_t quality;           ///< JPEG quality 0-63 (lower = better, bigger)
+    uint8_t xclkMhz;           ///< Sensor clock: frame timing scales with it
+    gainceiling_t gainCeiling; ///< AGC limit: higher = brighter but noisier
+    bool aec2;                 ///< DSP night-mode AEC (allows exposure > 1 frame)
+    int8_t aeLevel;            ///< Exposure bias -2..+2
+    bool windowed;             ///< Use the raw window below instead of 'framesize'
+    uint16_t winX, winY;       ///< Window offset inside the CIF sensor area (400x296)
+    uint16_t winW, winH;       ///< Window size (multiple of 4, inside 400x296)
+    uint16_t outW, outH;       ///< JPEG output size (== window: 1:1, no scaler)
+};
+
+/**
+ * @brief Profile settings that a runtime parameter can pin (ParamRegistry).
+ */
+enum ProfileOverride : uint8_t
+{
+    OVERRIDE_QUALITY = 0,   ///< JPEG quality 0-63
+    OVERRIDE_FRAMESIZE = 1, ///< framesize_t (disables windowing)
+    OVERRIDE_XCLK = 2,      ///< Sensor clock in MHz
+    OVERRIDE_COUNT = 3
+};
+
+class CameraProfiles
+{
+public:
+    /**
+     * @brief Records the size limits of the running driver.
+     * @param maxFramesize Largest size a profile may use.
+     * @param bufferFramesize Size the frame buffers were allocated for (still limit).
+     */
+    static void begin(framesize_t maxFramesize, framesize_t bufferFramesize);
+
+    /**
+     * @brief Applies a profile to the running sensor.
+     * @param name Profile key (e.g. "fpv").
+     * @return false if unknown, too large for the buffers, or the sensor rejected it.
+     * @note Serialized internally ('/profile' on httpd vs parameter writes).
+     */
+    static bool apply(const char *name);
+
+    /**
+     * @brief Name of the active profile.
+     */
+    static const char *active();
+
+    /**
+     * @brief Pins one setting on top of every profile (runtime tuning).
+     * @details Re-applies the active profile with the override, so it also
+     * survives later profile switches. Unchanged values are a no-op.
+     * @param what Setting to pin.
+     * @param value New value, or -1 to follow the profile again.
+     * @return false if the sensor/buffers reject it (previous value restored).
+     */
+    static bool setOverride(ProfileOverride what, int value);
+
+    /**
+     * @brief Switches the sensor to a still size/quality (CameraServer '/still').
+     * @details Keeps the profile lock until exitStill(): profile switches and
+     * parameter writes wait for the still instead of interleaving with it.
+     * @param framesize Still size (up to the buffer size given to begin()).
+     * @param quality JPEG quality (0-63).
+     * @return false if too large or rejected (lock released, nothing changed).
+     */
+    static bool enterStill(framesize_t framesize, uint8_t quality);
+
+    /**
+     * @brief Restores the active profile (overrides included) and releases the lock.
+     * @note Only after a successful enterStill().
+     */
+    static void exitStill();
+
+    /**
+     * @brief HTTP handler: GET '/profile' lists profiles and measured FPS,
+     * GET '/profile?name=<key>' switches and then lists.
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t Operation status.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+
+private:
+    /**
+     * @brief apply() body. Caller holds _lock.
+     */
+    static bool applyLocked(const char *name);
+
+    /**
+     * @brief Closes the FPS window of the active profile.
+     */
+    static void closeWindow();
+
+    /**
+     * @brief Live FPS (x10) of the active profile since it was applied.
+     */
+    static uint16_t liveFpsX10();
+
+    static framesize_t _maxFramesize;
+    static framesize_t _bufferFramesize; ///< Frame buffers allocated for this size
+    static int _active;            ///< Index in the table (-1 = none)
+    static uint8_t _xclkMhz;       ///< Current sensor clock
+    static uint32_t _framesAtApply; ///< Metrics::framesCaptured when applied
+    static int64_t _appliedUs;     ///< esp_timer_get_time() when applied
+    static int _overrides[OVERRIDE_COUNT]; ///< Pinned settings (-1 = from the profile)
+    static SemaphoreHandle_t _lock;        ///< Recursive: setOverride() re-enters apply()
+};
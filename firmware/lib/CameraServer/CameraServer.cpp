@@ -8,6 +8,14 @@
  */
 
 #include "CameraServer.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "esp_heap_caps.h"
+#include "freertos/event_groups.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "CameraProfiles.h"
+#include "ObstacleDetector.h"
 
 // =============================================================================
 // PIN DEFINITIONS (AI THINKER ESP32-CAM MODEL)
@@ -37,14 +45,166 @@
 // The "Boundary" is an arbitrary string that serves as a separator between photos.
 #define PART_BOUNDARY "123456789000000000000987654321"
 
-// Precalculated HTTP headers for efficiency
-static const char *_STREAM_CONTENT_TYPE = "multipart/x-mixed-replace;boundary=" PART_BOUNDARY;
+// Precalculated HTTP headers for efficiency. The sender tasks write to the raw
+// socket, so the status line and headers are sent by hand.
+static const char *_STREAM_HEADER = "HTTP/1.1 200 OK\r\n"
+                                    "Content-Type: multipart/x-mixed-replace;boundary=" PART_BOUNDARY "\r\n"
+                                    "Cache-Control: no-cache\r\n"
+                                    "Connection: close\r\n\r\n";
 static const char *_STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
-static const char *_STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+
+// Boot KPI: Reported once, when the first complete frame leaves the socket.
+static bool _firstFrameReported = false;
+
+// Pause between frames (STREAM_FRAME_GAP_MS by default, runtime parameter)
+static volatile uint32_t _frameGapMs = STREAM_FRAME_GAP_MS;
+static volatile uint32_t _governorGapMs = 0; ///< PowerGovernor share of the pause
+static CameraServer *_instance = NULL;        ///< close_fn has no user context (WebSocket state)
+
+// =============================================================================
+// STREAM CLIENT SLOTS (Socket hand-off)
+// =============================================================================
+// streamHandler() does not run the infinite loop any more: it sends the HTTP
+// header, hands the socket to a sender task from a fixed pool and returns, so
+// the single httpd worker is free for the other endpoints.
+
+/**
+ * @brief One '/stream' client, served by its own sender task.
+ */
+struct StreamSlot
+{
+    int fd;                       ///< Owned socket (-1 = free). httpd no longer tracks it
+    TaskHandle_t task;            ///< Sender task (created once at startServer)
+    volatile uint32_t lastSendMs; ///< Last completed frame (LRU purge key)
+    bool pending;                 ///< Handed off, task not started until httpd drops the session
+    StreamClientStats stats;      ///< Per-connection counters
+};
+
+static StreamSlot _streamSlots[STREAM_MAX_CLIENTS];
+static portMUX_TYPE _streamLock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t _slotFreed = NULL; ///< Given by a sender task when it releases its slot
+
+// =============================================================================
+// HIGH-RESOLUTION STILL ('/still')
+// =============================================================================
+// The frame buffers are allocated for CAMERA_STILL_MAX_FRAMESIZE at init, so a
+// still is a sensor reconfiguration, not a driver restart. While it runs the
+// video gate is closed: the senders park before their next capture and keep
+// their sockets, instead of streaming UXGA frames or being disconnected.
+
+#define VIDEO_GATE_OPEN BIT0
+
+static EventGroupHandle_t _videoGate = NULL; ///< VIDEO_GATE_OPEN clear = still in progress
+static uint8_t *_stillBuf = NULL;            ///< Dedicated PSRAM copy of the still JPEG
+static size_t _stillCap = 0;
+static TaskHandle_t _stillTaskHandle = NULL;
+static volatile int _stillFd = -1;           ///< Socket owned by the still task (-1 = idle)
+static bool _stillPending = false;           ///< Handed off, task not started until httpd drops the session
+static framesize_t _stillSize = CAMERA_STILL_MAX_FRAMESIZE;
+static uint8_t _stillQuality = CAMERA_STILL_QUALITY;
+
+/**
+ * @brief '/still?size=' keys (sizes above CAMERA_STILL_MAX_FRAMESIZE are rejected).
+ */
+static const struct
+{
+    const char *name;
+    framesize_t size;
+} STILL_SIZES[] = {
+    {"QVGA", FRAMESIZE_QVGA}, {"VGA", FRAMESIZE_VGA}, {"SVGA", FRAMESIZE_SVGA},
+    {"XGA", FRAMESIZE_XGA}, {"HD", FRAMESIZE_HD}, {"SXGA", FRAMESIZE_SXGA},
+    {"UXGA", FRAMESIZE_UXGA},
+};
+
+/**
+ * @brief True if 'fd' belongs to a stream sender or the still task (httpd must not close it).
+ */
+static bool isStreamSocket(int fd)
+{
+    bool owned = false;
+    portENTER_CRITICAL(&_streamLock);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++)
+    {
+        if (_streamSlots[i].fd == fd)
+            owned = true;
+    }
+    if (_stillFd == fd)
+        owned = true;
+    portEXIT_CRITICAL(&_streamLock);
+    return owned;
+}
+
+/**
+ * @brief Claims the pending hand-off of 'fd' (httpd just released its session).
+ * @return Task that now owns the socket, or NULL if 'fd' was not handed off.
+ */
+static TaskHandle_t takeHandOff(int fd)
+{
+    TaskHandle_t owner = NULL;
+    portENTER_CRITICAL(&_streamLock);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++)
+    {
+        if (_streamSlots[i].fd == fd && _streamSlots[i].pending)
+        {
+            _streamSlots[i].pending = false;
+            owner = _streamSlots[i].task;
+        }
+    }
+    if (_stillFd == fd && _stillPending)
+    {
+        _stillPending = false;
+        owner = _stillTaskHandle;
+    }
+    portEXIT_CRITICAL(&_streamLock);
+    return owner;
+}
+
+/**
+ * @brief esp_camera_fb_get() for the video senders: waits while a still is in progress.
+ * @details A frame captured across the switch is returned to the driver (it
+ * may be the still's size) and the sender parks until the gate reopens.
+ */
+static camera_fb_t *grabFrame()
+{
+    while (true)
+    {
+        xEventGroupWaitBits(_videoGate, VIDEO_GATE_OPEN, pdFALSE, pdTRUE, portMAX_DELAY);
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (!fb || (xEventGroupGetBits(_videoGate) & VIDEO_GATE_OPEN))
+            return fb;
+        esp_camera_fb_return(fb);
+    }
+}
+
+/**
+ * @brief Writes the whole buffer (send() may accept less than asked).
+ * @return false on error or SO_SNDTIMEO expiry (client dead or stalled).
+ */
+static bool sendAll(int fd, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    while (len > 0)
+    {
+        int n = send(fd, p, len, 0);
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
 
 CameraServer::CameraServer()
 {
     _httpServer = NULL;
+    _controlSink = NULL;
+    _wsTask = NULL;
+    _wsLock = portMUX_INITIALIZER_UNLOCKED;
+    for (int i = 0; i < WS_MAX_VIDEO_CLIENTS; i++)
+    {
+        _wsVideoFds[i] = -1;
+    }
+    _wsPushDone = NULL;
 }
 
 bool CameraServer::init()
@@ -70,18 +230,17 @@ bool CameraServer::init()
     config.pin_pwdn = PWDN_GPIO_NUM;
     config.pin_reset = RESET_GPIO_NUM;
 
-    // LOWER CLOCK SPEED (CRITICAL)
-    // Default is 20000000 (20MHz).
-    // Lowering it to 15MHz forces the camera to process slower physically.
-    // This limits FPS to stable 10-15, freeing up CPU and WiFi bandwidth.
+    // BOOT CLOCK: 15MHz (historic cool-down value, limits FPS to a stable 10-15).
+    // Runtime XCLK, quality and exposure come from the active sensor profile
+    // (lib/CameraProfiles), applied right after the driver starts.
     config.xclk_freq_hz = 15000000;       // 15MHz
     config.pixel_format = PIXFORMAT_JPEG; // Hardware compresses to JPEG natively
 
-    // --- 2. OPTIMIZATION FOR SMOOTH STREAMING (RC) ---
-    // We use QVGA (320x240) to guarantee >25 FPS and low latency (<100ms),
-    // offering the best balance of quality/speed for FPV.
-    // Higher resolutions (SVGA/HD) introduce unacceptable lag for driving.
-    config.frame_size = FRAMESIZE_QVGA;
+    // --- 2. FRAME BUFFER SIZING ---
+    // JPEG buffers are sized for this frame size and cannot grow later, so we
+    // start at the largest size ever delivered (the '/still' size) and let the
+    // default profile (QVGA FPV) shrink the output immediately.
+    config.frame_size = psramFound() ? CAMERA_STILL_MAX_FRAMESIZE : FRAMESIZE_QVGA;
     config.jpeg_quality = 60; // Range 0-63 (60 is very low quality -> high compression -> fast)
 
     // 3. External Memory Verification (PSRAM)
@@ -112,91 +271,761 @@ bool CameraServer::init()
         return false;
     }
 
+    // 5. Runtime Profile (FPV by default, switchable at '/profile')
+    CameraProfiles::begin(psramFound() ? CAMERA_MAX_FRAMESIZE : FRAMESIZE_QVGA, config.frame_size);
+    CameraProfiles::apply(CAMERA_DEFAULT_PROFILE);
+
     return true;
 }
 
 esp_err_t CameraServer::streamHandler(httpd_req_t *req)
 {
-    camera_fb_t *fb = NULL;
-    esp_err_t res = ESP_OK;
-    size_t _jpg_buf_len = 0;
-    uint8_t *_jpg_buf = NULL;
-    char *part_buf[64];
+    int fd = httpd_req_to_sockfd(req);
 
-    // Initial stream header
-    res = httpd_resp_set_type(req, _STREAM_CONTENT_TYPE);
-    if (res != ESP_OK)
-        return res;
+    // 1. PICK A SLOT: a free one, else purge the least recently served client
+    // (a half-dead client stops completing frames and becomes the LRU first)
+    int idx = -1;
+    int victim = -1;
+    portENTER_CRITICAL(&_streamLock);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++)
+    {
+        if (_streamSlots[i].fd < 0)
+        {
+            idx = i;
+            break;
+        }
+        if (victim < 0 || (int32_t)(_streamSlots[i].lastSendMs - _streamSlots[victim].lastSendMs) < 0)
+            victim = i;
+    }
+    int victimFd = (idx < 0) ? _streamSlots[victim].fd : -1;
+    portEXIT_CRITICAL(&_streamLock);
 
-    // Infinite transmission loop
-    while (true)
+    if (idx < 0)
     {
-        // A. Capture Frame (Blocking)
-        fb = esp_camera_fb_get();
-        if (!fb)
+        // Unblocks the victim's send() at once; its task frees the slot and
+        // signals _slotFreed. Drop a stale signal first so we wait for this one.
+        Serial.printf("[CAM] Stream clients full: purging LRU client (fd %d)\n", victimFd);
+        Metrics::streamEvictions.inc();
+        xSemaphoreTake(_slotFreed, 0);
+        shutdown(victimFd, SHUT_RDWR);
+
+        // Bounded wait on the httpd task: any slot released in time is taken
+        TickType_t start = xTaskGetTickCount();
+        TickType_t budget = pdMS_TO_TICKS(STREAM_PURGE_WAIT_MS);
+        while (idx < 0)
         {
-            Serial.println("[ERROR] Corrupt frame or camera disconnected");
-            res = ESP_FAIL;
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= budget || xSemaphoreTake(_slotFreed, budget - elapsed) != pdTRUE)
+                break;
+            portENTER_CRITICAL(&_streamLock);
+            for (int i = 0; i < STREAM_MAX_CLIENTS && idx < 0; i++)
+            {
+                if (_streamSlots[i].fd < 0)
+                    idx = i;
+            }
+            portEXIT_CRITICAL(&_streamLock);
         }
-        else
+        if (idx < 0)
         {
-            // B. Send Boundary and Frame Headers
-            if (res == ESP_OK)
+            httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Stream clients busy");
+            return ESP_OK;
+        }
+    }
+
+    // 2. SOCKET SETUP
+    // QoS: Video travels in its own WMM queue (DSCP_VIDEO, config.h) so
+    // control datagrams (AC_VO) are not stuck behind large JPEG bursts.
+    int tos = DSCP_VIDEO << 2;
+    setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+
+    // Dead-client detection: a send that cannot progress for this long fails
+    struct timeval tv;
+    tv.tv_sec = STREAM_SEND_TIMEOUT_MS / 1000;
+    tv.tv_usec = (STREAM_SEND_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    // 3. RESPONSE HEADER (raw: the multipart body is not chunk-encoded any more)
+    if (!sendAll(fd, _STREAM_HEADER, strlen(_STREAM_HEADER)))
+        return ESP_FAIL;
+
+    // 4. HAND-OFF: the slot owns the socket from here on. Returning ESP_FAIL
+    // makes httpd drop the session; closeSocket() then leaves the fd open and
+    // starts the sender, which may close it only once httpd has let go.
+    portENTER_CRITICAL(&_streamLock);
+    StreamSlot &slot = _streamSlots[idx];
+    slot.fd = fd;
+    slot.pending = true;
+    slot.lastSendMs = millis();
+    slot.stats.fd = fd;
+    slot.stats.frames = 0;
+    slot.stats.bytes = 0;
+    portEXIT_CRITICAL(&_streamLock);
+
+    return ESP_FAIL;
+}
+
+void CameraServer::streamSenderTask(void *arg)
+{
+    StreamSlot &slot = _streamSlots[(int)(intptr_t)arg];
+    char part_buf[96]; // Boundary + per-frame header text
+
+    while (true)
+    {
+        // 1. IDLE UNTIL A CLIENT IS HANDED OVER
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int fd = slot.fd;
+        if (fd < 0)
+            continue;
+
+        // 2. TRANSMISSION LOOP (runs until the client fails a send)
+        bool ok = true;
+        while (ok)
+        {
+            // A. Capture Frame (Blocking)
+            int64_t t0 = esp_timer_get_time();
+            TRACE_BEGIN(TRACE_FB_GET);
+            camera_fb_t *fb = grabFrame();
+            TRACE_END(TRACE_FB_GET);
+            if (!fb)
             {
-                res = httpd_resp_send_chunk(req, _STREAM_BOUNDARY, strlen(_STREAM_BOUNDARY));
+                Serial.println("[ERROR] Corrupt frame or camera disconnected");
+                Metrics::captureFailures.inc();
+                delay(10);
+                continue;
             }
-            // C. Send Current Image Header (Content-Type and Length)
-            if (res == ESP_OK)
+            Metrics::framesCaptured.inc();
+
+            // B. Boundary + Image Header (one segment), then C. Payload
+            size_t hlen = snprintf(part_buf, sizeof(part_buf), "%s" "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
+                                   _STREAM_BOUNDARY, (unsigned)fb->len);
+            TRACE_BEGIN(TRACE_STREAM_SEND);
+            ok = sendAll(fd, part_buf, hlen) && sendAll(fd, fb->buf, fb->len);
+            TRACE_END(TRACE_STREAM_SEND);
+
+            // METRICS (Lock-free, hot path)
+            Metrics::captureUs.observe((uint32_t)(esp_timer_get_time() - t0));
+            if (ok)
             {
-                size_t hlen = snprintf((char *)part_buf, 64, _STREAM_PART, fb->len);
-                res = httpd_resp_send_chunk(req, (const char *)part_buf, hlen);
+                Metrics::framesSent.inc();
+                Metrics::bytesSent.inc(fb->len);
+                Metrics::frameBytes.observe(fb->len);
+                slot.stats.frames++;
+                slot.stats.bytes += fb->len;
+                slot.lastSendMs = millis();
             }
-            // D. Send Payload (JPEG Image)
-            if (res == ESP_OK)
+            else
             {
-                res = httpd_resp_send_chunk(req, (const char *)fb->buf, fb->len);
+                Metrics::sendFailures.inc();
             }
 
-            // E. Free buffer for next capture
+            // BOOT KPI: Boot-to-First-Frame (compare Fast vs Full WiFi paths)
+            if (ok && !_firstFrameReported)
+            {
+                _firstFrameReported = true;
+                Serial.printf("[BOOT] Boot-to-First-Frame: %lu ms\n",
+                              (unsigned long)(esp_timer_get_time() / 1000));
+            }
+
+#if ROVER_VISION
+            // Obstacle detector tap: copies ~1 frame per VISION_PERIOD_MS, after the send
+            ObstacleDetector::offer(fb);
+#endif
+
+            // D. Free buffer for next capture
             esp_camera_fb_return(fb);
-            fb = NULL;
+
+            // --- STABILITY (THROTTLING) ---
+            // Pause between frames (STREAM_FRAME_GAP_MS, default 20ms, plus the
+            // power governor's share when hot). Control priority is handled by
+            // WMM marking; this only caps FPS/heat.
+            uint32_t gap = _frameGapMs + _governorGapMs;
+            if (ok && gap > 0)
+                delay(gap);
         }
 
-        // If client closes connection, break loop
-        if (res != ESP_OK)
-            break;
+        // 3. RELEASE: free the slot BEFORE closing, so a recycled fd number
+        // is never mistaken for this stream by closeSocket()
+        portENTER_CRITICAL(&_streamLock);
+        slot.fd = -1;
+        portEXIT_CRITICAL(&_streamLock);
+        close(fd);
+        xSemaphoreGive(_slotFreed); // Wakes a purging streamHandler, if any
+    }
+}
+
+esp_err_t CameraServer::stillHandler(httpd_req_t *req)
+{
+    char query[48];
+    char value[8];
+    framesize_t size = CAMERA_STILL_MAX_FRAMESIZE;
+    int quality = CAMERA_STILL_QUALITY;
+
+    // 1. AVAILABILITY (the still buffer exists only with PSRAM)
+    if (_stillBuf == NULL)
+    {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_sendstr(req, "Stills need PSRAM");
+    }
 
-        // --- STABILITY (THROTTLING) ---
-        // Pause for 20ms to let WiFi breathe.
-        // This allows UDP packets to enter without colliding with video.
-        // Mathematically: Transmission + 20ms pause = approx 15-20 stable FPS.
-        delay(20);
+    // 2. PARAMETERS ('?size=UXGA&quality=10', both optional)
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        if (httpd_query_key_value(query, "size", value, sizeof(value)) == ESP_OK)
+        {
+            size = FRAMESIZE_INVALID;
+            for (size_t i = 0; i < sizeof(STILL_SIZES) / sizeof(STILL_SIZES[0]); i++)
+            {
+                if (strcasecmp(value, STILL_SIZES[i].name) == 0)
+                    size = STILL_SIZES[i].size;
+            }
+        }
+        if (httpd_query_key_value(query, "quality", value, sizeof(value)) == ESP_OK)
+            quality = atoi(value);
     }
-    return res;
+    if (size == FRAMESIZE_INVALID || size > CAMERA_STILL_MAX_FRAMESIZE || quality < 4 || quality > 63)
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "size: QVGA..UXGA, quality: 4-63");
+        return ESP_OK;
+    }
+
+    // 3. CLAIM (one still at a time; the video is paused while it runs)
+    int fd = httpd_req_to_sockfd(req);
+    portENTER_CRITICAL(&_streamLock);
+    bool busy = _stillFd >= 0;
+    if (!busy)
+    {
+        _stillFd = fd;
+        _stillPending = true;
+        _stillSize = size;
+        _stillQuality = (uint8_t)quality;
+    }
+    portEXIT_CRITICAL(&_streamLock);
+    if (busy)
+    {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_sendstr(req, "Still in progress");
+    }
+
+    // 4. SOCKET SETUP + HAND-OFF (same rules as streamHandler)
+    int tos = DSCP_VIDEO << 2;
+    setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+    struct timeval tv;
+    tv.tv_sec = STREAM_SEND_TIMEOUT_MS / 1000;
+    tv.tv_usec = (STREAM_SEND_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    // closeSocket() starts the still task once httpd has let go of the session
+    return ESP_FAIL;
+}
+
+void CameraServer::stillTask(void *arg)
+{
+    char header[256];
+
+    while (true)
+    {
+        // 1. IDLE UNTIL A CLIENT IS HANDED OVER
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int fd = _stillFd;
+        if (fd < 0)
+            continue;
+        uint16_t width = resolution[_stillSize].width;
+        uint16_t height = resolution[_stillSize].height;
+        size_t len = 0;
+
+        // 2. PAUSE THE VIDEO: senders finish the frame in hand and park at the gate
+        int64_t t0 = esp_timer_get_time();
+        int64_t t1 = t0;
+        int64_t t2 = t0;
+        xEventGroupClearBits(_videoGate, VIDEO_GATE_OPEN);
+
+        if (CameraProfiles::enterStill(_stillSize, _stillQuality))
+        {
+            // 3. CAPTURE: frames at the old size may still be in flight, and
+            // the first ones at the new size are skipped while AEC settles
+            int settle = CAMERA_STILL_SETTLE_FRAMES;
+            for (int i = 0; i < CAMERA_STILL_MAX_FRAMES && len == 0; i++)
+            {
+                camera_fb_t *fb = esp_camera_fb_get();
+                if (!fb)
+                    continue;
+                if (fb->width == width && settle-- <= 0 && fb->len <= _stillCap)
+                {
+                    memcpy(_stillBuf, fb->buf, fb->len);
+                    len = fb->len;
+                }
+                esp_camera_fb_return(fb);
+            }
+            t1 = esp_timer_get_time();
+
+            // 4. RESTORE the profile, then drop the frame exposed before it
+            // took effect (at most one in flight with a single frame buffer)
+            CameraProfiles::exitStill();
+            for (int i = 0; i < 2; i++)
+            {
+                camera_fb_t *fb = esp_camera_fb_get();
+                if (!fb)
+                    continue;
+                bool restored = fb->width != width;
+                esp_camera_fb_return(fb);
+                if (restored)
+                    break;
+            }
+            t2 = esp_timer_get_time();
+        }
+
+        // 5. RESUME THE VIDEO (before sending: the still leaves from its own buffer)
+        xEventGroupSetBits(_videoGate, VIDEO_GATE_OPEN);
+        unsigned switchMs = (unsigned)((t1 - t0) / 1000);
+        unsigned restoreMs = (unsigned)((t2 - t1) / 1000);
+        unsigned gapMs = (unsigned)((t2 - t0) / 1000);
+
+        // 6. RESPONSE (raw, like '/stream'; latency breakdown in the headers)
+        if (len > 0)
+        {
+            int hlen = snprintf(header, sizeof(header),
+                                "HTTP/1.1 200 OK\r\n"
+                                "Content-Type: image/jpeg\r\n"
+                                "Content-Length: %u\r\n"
+                                "X-Still-Switch-Ms: %u\r\n"
+                                "X-Still-Restore-Ms: %u\r\n"
+                                "X-Stream-Gap-Ms: %u\r\n"
+                                "Cache-Control: no-cache\r\n"
+                                "Connection: close\r\n\r\n",
+                                (unsigned)len, switchMs, restoreMs, gapMs);
+            bool sent = sendAll(fd, header, hlen) && sendAll(fd, _stillBuf, len);
+
+            Metrics::stillCaptures.inc();
+            Metrics::stillSwitchMs.set(switchMs);
+            Metrics::stillGapMs.set(gapMs);
+            Serial.printf("[CAM] Still %ux%u: %u bytes, switch %u ms, stream gap %u ms%s\n",
+                          width, height, (unsigned)len, switchMs, gapMs, sent ? "" : " (client gone)");
+        }
+        else
+        {
+            static const char *FAILED = "HTTP/1.1 503 Service Unavailable\r\n"
+                                        "Content-Type: text/plain\r\n"
+                                        "Connection: close\r\n\r\n"
+                                        "Still capture failed";
+            sendAll(fd, FAILED, strlen(FAILED));
+            Metrics::captureFailures.inc();
+            Serial.printf("[CAM] Still %ux%u failed (stream gap %u ms)\n", width, height, gapMs);
+        }
+
+        // 7. RELEASE: free the claim BEFORE closing (recycled fd numbers)
+        portENTER_CRITICAL(&_streamLock);
+        _stillFd = -1;
+        portEXIT_CRITICAL(&_streamLock);
+        close(fd);
+    }
+}
+
+void CameraServer::closeSocket(httpd_handle_t hd, int fd)
+{
+    // A closed WebSocket must not stay subscribed: the fd number gets recycled
+    if (_instance != NULL)
+        _instance->removeWsVideoClient(fd);
+
+    // Handed-off stream/still sockets are closed by their task. A fresh
+    // hand-off starts here, after httpd's last use of the session.
+    TaskHandle_t owner = takeHandOff(fd);
+    if (owner != NULL)
+        xTaskNotifyGive(owner);
+    else if (!isStreamSocket(fd))
+        close(fd);
+}
+
+void CameraServer::setFrameGapMs(uint32_t ms)
+{
+    _frameGapMs = ms;
+}
+
+void CameraServer::setGovernorGapMs(uint32_t ms)
+{
+    _governorGapMs = ms;
+}
+
+int CameraServer::getStreamStats(StreamClientStats *out, int max)
+{
+    int n = 0;
+    portENTER_CRITICAL(&_streamLock);
+    for (int i = 0; i < STREAM_MAX_CLIENTS && n < max; i++)
+    {
+        if (_streamSlots[i].fd >= 0)
+            out[n++] = _streamSlots[i].stats;
+    }
+    portEXIT_CRITICAL(&_streamLock);
+    return n;
 }
 
 void CameraServer::startServer()
 {
+    _instance = this;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = HTTP_PORT; // Port 80 (defined in config.h)
+    config.max_uri_handlers = HTTP_MAX_URI_HANDLERS; // Default (8) is too small for diagnostics
+
+    // Task placement (config.h, TASK LAYOUT). The /stream loop runs in the
+    // sender tasks below, not here: httpd only routes requests.
+    config.core_id = TASK_HTTPD.core;
+    config.task_priority = TASK_HTTPD.priority;
+    config.stack_size = TASK_HTTPD.stack;
+
+    // Socket hygiene: stream sockets leave httpd (closeSocket keeps them open),
+    // and idle sessions are recycled when the socket table is full.
+    // Handed-off streams still use lwIP sockets: keep the total budget unchanged.
+    config.close_fn = closeSocket;
+    config.lru_purge_enable = true;
+    config.max_open_sockets -= STREAM_MAX_CLIENTS;
+
+    // Wildcard routes ('/ui/*', web UI assets). Exact URIs still match exactly.
+    config.uri_match_fn = httpd_uri_match_wildcard;
+
+    // Video gate: open except while a '/still' reconfigures the sensor
+    _videoGate = xEventGroupCreate();
+    xEventGroupSetBits(_videoGate, VIDEO_GATE_OPEN);
+
+    // Still buffer + task (PSRAM only: the frame buffers are UXGA-sized too)
+    if (psramFound())
+    {
+        _stillCap = (size_t)resolution[CAMERA_STILL_MAX_FRAMESIZE].width *
+                    resolution[CAMERA_STILL_MAX_FRAMESIZE].height / 5; // Driver's JPEG bound
+        _stillBuf = (uint8_t *)heap_caps_malloc(_stillCap, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (_stillBuf != NULL)
+            xTaskCreatePinnedToCore(stillTask, "still", TASK_STILL.stack, NULL,
+                                    TASK_STILL.priority, &_stillTaskHandle, TASK_STILL.core);
+    }
+
+    // Stream sender pool: created once (zero-heap-after-boot), idle until handed a client
+    _slotFreed = xSemaphoreCreateBinary();
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++)
+    {
+        char name[12];
+        snprintf(name, sizeof(name), "stream%d", i);
+        _streamSlots[i].fd = -1;
+        _streamSlots[i].pending = false;
+        _streamSlots[i].stats.fd = -1;
+        xTaskCreatePinnedToCore(streamSenderTask, name, TASK_STREAM.stack, (void *)(intptr_t)i,
+                                TASK_STREAM.priority, &_streamSlots[i].task, TASK_STREAM.core);
+    }
 
     // URI Route Definition
     httpd_uri_t stream_uri = {
         .uri = "/stream", // URL: http://ip/stream
         .method = HTTP_GET,
-        .handler = streamHandler, // Static function managing the loop
+        .handler = streamHandler, // Static function: hands the socket to a sender task
         .user_ctx = NULL};
 
-    Serial.printf("[CAM] HTTP Server listening on port %d\n", config.server_port);
+    Serial.printf("[CAM] HTTP Server listening on port %d (core %d, prio %u)\n",
+                  config.server_port, (int)config.core_id, (unsigned)config.task_priority);
 
     // Start Espressif lightweight httpd server
     if (httpd_start(&_httpServer, &config) == ESP_OK)
     {
         httpd_register_uri_handler(_httpServer, &stream_uri);
-        Serial.println("[CAM] Endpoint registered: /stream");
+        Serial.printf("[CAM] Endpoint registered: /stream (max %d clients)\n", STREAM_MAX_CLIENTS);
+
+        httpd_uri_t still_uri = {
+            .uri = "/still",
+            .method = HTTP_GET,
+            .handler = stillHandler, // Hands the socket to the still task
+            .user_ctx = NULL};
+        httpd_register_uri_handler(_httpServer, &still_uri);
+        Serial.printf("[CAM] Endpoint registered: /still (%s)\n", _stillBuf ? "up to UXGA" : "no PSRAM");
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+        // WebSocket route: Browser piloting (control in, optional JPEG out)
+        httpd_uri_t ws_uri = {
+            .uri = "/ws",
+            .method = HTTP_GET,
+            .handler = wsHandler,
+            .user_ctx = this,
+            .is_websocket = true};
+        httpd_register_uri_handler(_httpServer, &ws_uri);
+        _wsPushDone = xSemaphoreCreateBinary();
+        xTaskCreatePinnedToCore(wsVideoTask, "ws_video", TASK_WS_VIDEO.stack, this,
+                                TASK_WS_VIDEO.priority, &_wsTask, TASK_WS_VIDEO.core);
+        Serial.println("[CAM] Endpoint registered: /ws (WebSocket)");
+#else
+        Serial.println("[CAM] WARNING: WebSocket support disabled in sdkconfig (/ws unavailable)");
+#endif
     }
     else
     {
         Serial.println("[ERROR] Failed to start HTTP Server");
     }
 }
+
+bool CameraServer::addEndpoint(const char *uri, httpd_method_t method,
+                               esp_err_t (*handler)(httpd_req_t *req), void *ctx)
+{
+    if (_httpServer == NULL)
+    {
+        Serial.printf("[ERROR] Cannot register %s: HTTP Server not running\n", uri);
+        return false;
+    }
+
+    httpd_uri_t route = {
+        .uri = uri,
+        .method = method,
+        .handler = handler,
+        .user_ctx = ctx};
+
+    if (httpd_register_uri_handler(_httpServer, &route) != ESP_OK)
+    {
+        Serial.printf("[ERROR] Failed to register endpoint: %s\n", uri);
+        return false;
+    }
+
+    Serial.printf("[CAM] Endpoint registered: %s\n", uri);
+    return true;
+}
+
+void CameraServer::setControlSink(ControlSink sink)
+{
+    _controlSink = sink;
+}
+
+// =============================================================================
+// WEBSOCKET (BROWSER PILOTING)
+// =============================================================================
+
+bool CameraServer::addWsVideoClient(int fd)
+{
+    bool added = false;
+
+    portENTER_CRITICAL(&_wsLock);
+    for (int i = 0; i < WS_MAX_VIDEO_CLIENTS && !added; i++)
+    {
+        if (_wsVideoFds[i] == fd)
+        {
+            added = true; // Already subscribed
+        }
+    }
+    for (int i = 0; i < WS_MAX_VIDEO_CLIENTS && !added; i++)
+    {
+        if (_wsVideoFds[i] < 0)
+        {
+            _wsVideoFds[i] = fd;
+            added = true;
+        }
+    }
+    portEXIT_CRITICAL(&_wsLock);
+
+    return added;
+}
+
+void CameraServer::removeWsVideoClient(int fd)
+{
+    portENTER_CRITICAL(&_wsLock);
+    for (int i = 0; i < WS_MAX_VIDEO_CLIENTS; i++)
+    {
+        if (_wsVideoFds[i] == fd)
+        {
+            _wsVideoFds[i] = -1;
+        }
+    }
+    portEXIT_CRITICAL(&_wsLock);
+}
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+
+esp_err_t CameraServer::wsHandler(httpd_req_t *req)
+{
+    CameraServer *self = (CameraServer *)req->user_ctx;
+    int fd = httpd_req_to_sockfd(req);
+
+    // 1. HANDSHAKE (HTTP GET + Upgrade)
+    if (req->method == HTTP_GET)
+    {
+        // Small control frames must leave immediately (no Nagle coalescing)
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        int tos = DSCP_CONTROL << 2;
+        setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+
+        Serial.printf("[WS] Client connected (fd %d)\n", fd);
+        return ESP_OK;
+    }
+
+    // 2. READ FRAME HEADER (len = 0 -> only fills type/length)
+    uint8_t buf[ControlProtocol::PACKET_MAX];
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+
+    esp_err_t res = httpd_ws_recv_frame(req, &frame, 0);
+    if (res != ESP_OK)
+    {
+        return res;
+    }
+    if (frame.len > sizeof(buf))
+    {
+        // Not part of the protocol: drop the connection instead of buffering it
+        return ESP_FAIL;
+    }
+
+    // 3. READ PAYLOAD (Fixed stack buffer, no heap)
+    frame.payload = buf;
+    res = httpd_ws_recv_frame(req, &frame, sizeof(buf));
+    if (res != ESP_OK)
+    {
+        return res;
+    }
+
+    // 4. DISPATCH
+    ControlProtocol::PacketView packet(buf, frame.len);
+    if (frame.type == HTTPD_WS_TYPE_BINARY && packet.valid())
+    {
+        // Same layout as the UDP path: [Traction, Steering, Probe...]
+        Metrics::wsCommands.inc();
+        if (self->_controlSink != NULL)
+        {
+            self->_controlSink(buf, frame.len);
+        }
+
+        // LATENCY PROBE: Echo the token (same semantics as UDP)
+        if (packet.probeSize() > 0)
+        {
+            httpd_ws_frame_t echo;
+            memset(&echo, 0, sizeof(echo));
+            echo.final = true;
+            echo.type = HTTPD_WS_TYPE_BINARY;
+            echo.payload = (uint8_t *)packet.probe();
+            echo.len = packet.probeSize();
+            // JPEG pushes also run on this task (wsPushWork): no interleaving
+            httpd_ws_send_frame(req, &echo);
+        }
+    }
+    else if (frame.type == HTTPD_WS_TYPE_TEXT)
+    {
+        if (frame.len == 8 && memcmp(buf, "video:on", 8) == 0)
+        {
+            if (self->addWsVideoClient(fd))
+            {
+                // Socket now carries bulk video: move it out of the Voice queue
+                int tos = DSCP_VIDEO << 2;
+                setsockopt(fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+                xTaskNotifyGive(self->_wsTask);
+                Serial.printf("[WS] Video push ON (fd %d)\n", fd);
+            }
+            else
+            {
+                Serial.printf("[WS] Video push rejected (fd %d): max %d clients\n", fd, WS_MAX_VIDEO_CLIENTS);
+            }
+        }
+        else if (frame.len == 9 && memcmp(buf, "video:off", 9) == 0)
+        {
+            self->removeWsVideoClient(fd);
+            Serial.printf("[WS] Video push OFF (fd %d)\n", fd);
+        }
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief One frame handed from wsVideoTask to the httpd task.
+ */
+struct WsPushJob
+{
+    CameraServer *self;
+    camera_fb_t *fb;
+};
+
+void CameraServer::wsVideoTask(void *arg)
+{
+    CameraServer *self = (CameraServer *)arg;
+
+    while (true)
+    {
+        // A. Count subscribers (short critical section, no I/O inside)
+        int active = 0;
+        portENTER_CRITICAL(&self->_wsLock);
+        for (int i = 0; i < WS_MAX_VIDEO_CLIENTS; i++)
+        {
+            if (self->_wsVideoFds[i] >= 0)
+                active++;
+        }
+        portEXIT_CRITICAL(&self->_wsLock);
+
+        // B. Idle: Do not touch the sensor if nobody is watching
+        if (active == 0)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        // C. Capture Frame (Blocking)
+        TRACE_BEGIN(TRACE_FB_GET);
+        camera_fb_t *fb = grabFrame();
+        TRACE_END(TRACE_FB_GET);
+        if (!fb)
+        {
+            delay(10);
+            continue;
+        }
+        Metrics::framesCaptured.inc();
+
+        // D. Send on the httpd task: httpd may close and free a session at any
+        // time on its own task, so only there is a send safe. The buffer stays
+        // ours until wsPushWork has finished with it.
+        WsPushJob job = {self, fb};
+        if (httpd_queue_work(self->_httpServer, wsPushWork, &job) == ESP_OK)
+            xSemaphoreTake(self->_wsPushDone, portMAX_DELAY);
+
+#if ROVER_VISION
+        ObstacleDetector::offer(fb);
+#endif
+
+        // E. Free buffer for next capture
+        esp_camera_fb_return(fb);
+
+        // --- STABILITY (THROTTLING) --- Same cadence as the MJPEG stream
+        uint32_t gap = _frameGapMs + _governorGapMs;
+        if (gap > 0)
+            delay(gap);
+    }
+}
+
+void CameraServer::wsPushWork(void *arg)
+{
+    WsPushJob *job = (WsPushJob *)arg;
+    CameraServer *self = job->self;
+
+    // One binary message per JPEG
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.final = true;
+    frame.type = HTTPD_WS_TYPE_BINARY;
+    frame.payload = job->fb->buf;
+    frame.len = job->fb->len;
+
+    // Subscriptions only change on this task (wsHandler, closeSocket, here)
+    for (int i = 0; i < WS_MAX_VIDEO_CLIENTS; i++)
+    {
+        int fd = self->_wsVideoFds[i];
+        if (fd < 0)
+            continue;
+
+        // Failed sends are released here (closeSocket unsubscribes closed sessions)
+        TRACE_BEGIN(TRACE_WS_SEND);
+        bool sent = httpd_ws_get_fd_info(self->_httpServer, fd) == HTTPD_WS_CLIENT_WEBSOCKET &&
+                    httpd_ws_send_frame_async(self->_httpServer, fd, &frame) == ESP_OK;
+        TRACE_END(TRACE_WS_SEND);
+
+        if (!sent)
+        {
+            self->removeWsVideoClient(fd);
+            Metrics::sendFailures.inc();
+            Serial.printf("[WS] Client gone (fd %d)\n", fd);
+        }
+        else
+        {
+            Metrics::wsFramesSent.inc();
+        }
+    }
+
+    xSemaphoreGive(self->_wsPushDone);
+}
+
+#endif // CONFIG_HTTPD_WS_SUPPORT
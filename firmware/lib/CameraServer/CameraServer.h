@@ -7,6 +7,9 @@
  * Encapsulates low-level management of 'esp_camera' and 'esp_http_server'.
  * Implements buffering strategies for smooth streaming and automatically adapts
  * to the presence of PSRAM.
+ * Also exposes a WebSocket endpoint ('/ws') for browser piloting: binary control
+ * frames (same layout as UDP) in, optional binary JPEG frames out, and
+ * '/still' for one high-resolution JPEG without dropping the video clients.
  */
 
 #pragma once
@@ -15,11 +18,84 @@
 #include "esp_http_server.h"
 #include "config.h"
 
+/**
+ * @brief Receiver of control frames arriving over the WebSocket.
+ * @param frame Raw bytes (same layout as the UDP protocol).
+ * @param len Frame length (>= 2).
+ */
+typedef void (*ControlSink)(const uint8_t *frame, size_t len);
+
+/**
+ * @brief Per-connection MJPEG counters (one entry per active '/stream' client).
+ */
+struct StreamClientStats
+{
+    int fd;          ///< Client socket (-1 = free slot)
+    uint32_t frames; ///< Frames fully sent to this client
+    uint32_t bytes;  ///< JPEG payload bytes sent to this client
+};
+
 class CameraServer
 {
 private:
     httpd_handle_t _httpServer; // Web server handler (C-Style pointer)
 
+    // --- WEBSOCKET STATE ---
+    ControlSink _controlSink;              ///< Control frame consumer (RemoteControl)
+    int _wsVideoFds[WS_MAX_VIDEO_CLIENTS]; ///< Sockets subscribed to JPEG push (-1 = free)
+    portMUX_TYPE _wsLock;                  ///< Guards _wsVideoFds (httpd task vs push task)
+    TaskHandle_t _wsTask;                  ///< JPEG push task
+    SemaphoreHandle_t _wsPushDone;         ///< Given by wsPushWork once the frame is sent
+
+    /**
+     * @brief Subscribes a WebSocket to the JPEG push.
+     * @param fd Client socket.
+     * @return false if all WS_MAX_VIDEO_CLIENTS slots are taken.
+     */
+    bool addWsVideoClient(int fd);
+
+    /**
+     * @brief Unsubscribes a WebSocket from the JPEG push (no-op if absent).
+     * @param fd Client socket.
+     */
+    void removeWsVideoClient(int fd);
+
+    /**
+     * @brief Background task pushing each captured frame to subscribed WebSockets.
+     * @details Sleeps (task notification) while nobody is subscribed.
+     * @param arg CameraServer instance.
+     */
+    static void wsVideoTask(void *arg);
+
+    /**
+     * @brief httpd work item: sends one captured frame to every subscribed WebSocket.
+     * @details Queued by wsVideoTask (httpd_queue_work): sessions are only touched
+     * on the httpd task, where they cannot be closed mid-send.
+     * @param arg WsPushJob of the waiting wsVideoTask.
+     */
+    static void wsPushWork(void *arg);
+
+    /**
+     * @brief Stream sender task: capture + send loop for one '/stream' client.
+     * @details Sleeps (task notification) until streamHandler hands it a socket;
+     * closes the socket when a send fails or times out (STREAM_SEND_TIMEOUT_MS).
+     * @param arg Slot index.
+     */
+    static void streamSenderTask(void *arg);
+
+    /**
+     * @brief Still capture task: pauses the video, switches the sensor, grabs
+     * one frame, restores the profile and answers the '/still' client.
+     * @details Sleeps (task notification) until stillHandler hands it a socket.
+     * @param arg Unused.
+     */
+    static void stillTask(void *arg);
+
+    /**
+     * @brief httpd close callback: closes every socket except handed-off streams/stills.
+     */
+    static void closeSocket(httpd_handle_t hd, int fd);
+
 public:
     /**
      * @brief Default Constructor.
@@ -42,13 +118,89 @@ public:
      */
     void startServer();
 
+    /**
+     * @brief Registers an additional route on the running HTTP server.
+     * @details Lets other services (diagnostics, control) share the single httpd
+     * instance instead of opening more sockets/tasks.
+     * @param uri Route path (static string, e.g. "/boot").
+     * @param method HTTP method (HTTP_GET, HTTP_POST...).
+     * @param handler C-style callback.
+     * @param ctx Opaque pointer exposed to the handler as 'req->user_ctx'.
+     * @return true if registered, false if the server is not running or the table is full.
+     * @note Must be called after startServer(). Capacity: HTTP_MAX_URI_HANDLERS (config.h).
+     */
+    bool addEndpoint(const char *uri, httpd_method_t method,
+                     esp_err_t (*handler)(httpd_req_t *req), void *ctx = NULL);
+
     /**
      * @brief Static callback to serve the video stream.
      * @details
      * Must be static because the ESP-IDF API (pure C) does not support
      * instance methods (C++).
+     * Sends the multipart header and hands the socket to a stream sender task
+     * (purging the LRU client when all STREAM_MAX_CLIENTS are busy), then
+     * returns: the httpd worker never runs the infinite frame loop.
      * @param req Incoming HTTP request structure.
-     * @return esp_err_t Operation status (ESP_OK or Error).
+     * @return esp_err_t ESP_FAIL once handed off (httpd forgets the session,
+     * closeSocket() keeps the socket open for the sender).
      */
     static esp_err_t streamHandler(httpd_req_t *req);
+
+    /**
+     * @brief Static callback for '/still?size=UXGA&quality=10' (PSRAM only).
+     * @details
+     * Hands the socket to the still task and returns. The task closes the
+     * video gate (stream/WS senders wait, their sockets stay open), switches
+     * the sensor, copies one settled frame to a dedicated PSRAM buffer,
+     * restores the active profile and reopens the gate. The JPEG response
+     * carries the measured latency: X-Still-Switch-Ms (switch to captured
+     * frame), X-Still-Restore-Ms and X-Stream-Gap-Ms (total video pause).
+     * - size: QVGA, VGA, SVGA, XGA, HD, SXGA, UXGA (default/limit: CAMERA_STILL_MAX_FRAMESIZE).
+     * - quality: 4-63, lower = better (default CAMERA_STILL_QUALITY).
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t ESP_FAIL once handed off (like streamHandler);
+     * 400 bad parameters, 503 no PSRAM or a still already in progress.
+     */
+    static esp_err_t stillHandler(httpd_req_t *req);
+
+    /**
+     * @brief Snapshot of the clients currently served by the stream senders.
+     * @details Counters are per connection (reset when the client reconnects).
+     * @param out Destination array.
+     * @param max Capacity of 'out'.
+     * @return Number of entries written.
+     */
+    static int getStreamStats(StreamClientStats *out, int max);
+
+    /**
+     * @brief Sets the pause between frames on '/stream' and '/ws' (runtime
+     * parameter 'stream_gap_ms'). Applies from the next frame.
+     * @param ms Pause in milliseconds (0 = none).
+     */
+    static void setFrameGapMs(uint32_t ms);
+
+    /**
+     * @brief Extra pause added to 'stream_gap_ms' by the power governor
+     * (frame rate vs. temperature). Applies from the next frame.
+     * @param ms Pause in milliseconds (0 = none).
+     */
+    static void setGovernorGapMs(uint32_t ms);
+
+    /**
+     * @brief Sets the consumer of control frames received over '/ws'.
+     * @param sink Callback (called from the httpd task: must not block).
+     */
+    void setControlSink(ControlSink sink);
+
+    /**
+     * @brief Static callback for the '/ws' WebSocket endpoint.
+     * @details
+     * - Binary frame (>= 2 bytes): Control command, forwarded to the ControlSink.
+     *   Bytes beyond the 2nd (probe token) are echoed back immediately.
+     * - Text "video:on" / "video:off": Subscribes/unsubscribes to JPEG push.
+     *   Each JPEG is one binary message (2-4 bytes of framing vs ~100 for multipart).
+     * @param req Incoming HTTP request structure (user_ctx = CameraServer instance).
+     * @return esp_err_t Operation status (ESP_OK or Error).
+     */
+    static esp_err_t wsHandler(httpd_req_t *req);
 };
@@ -0,0 +1,186 @@
+/**
+ * @file EventLog.cpp
+ * @brief Event Ring Storage, COBS Framing and Writer Task.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "EventLog.h"
+#include "esp_timer.h"
+
+// Power of 2 required: the slot index is a mask, not a modulo.
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of 2");
+static_assert(LOG_EVENT_COUNT <= 0xFFFF, "LogEvent must fit in 16 bits");
+
+EventLog::Slot EventLog::_ring[LOG_RING_SIZE];
+std::atomic<uint32_t> EventLog::_head(0);
+uint32_t EventLog::_tail = 0;
+std::atomic<uint32_t> EventLog::_dropped(0);
+std::atomic<uint32_t> EventLog::_droppedTotal(0);
+
+/** @brief Set once the ring sequence numbers are initialized. */
+static std::atomic<bool> started(false);
+
+void EventLog::begin()
+{
+    // 1. RING INITIALIZATION (slot i is free for position i)
+    for (uint32_t i = 0; i < LOG_RING_SIZE; i++)
+    {
+        _ring[i].seq.store(i, std::memory_order_relaxed);
+    }
+    started.store(true, std::memory_order_release);
+
+    // 2. WRITER TASK
+    xTaskCreatePinnedToCore(writerTask, "eventlog", TASK_EVENTLOG.stack, NULL,
+                            TASK_EVENTLOG.priority, NULL, TASK_EVENTLOG.core);
+    Serial.printf("[LOG] Binary event log active (%d events, ring %d). Decode: python -m tools.log_decoder\n",
+                  (int)LOG_EVENT_COUNT, LOG_RING_SIZE);
+}
+
+void EventLog::push(LogEvent id, uint8_t nargs, uint32_t a0, uint32_t a1, uint32_t a2)
+{
+    if (!started.load(std::memory_order_acquire))
+        return; // Before begin(): nowhere to send it
+
+    // 1. RESERVE A SLOT (CAS on head; fails fast when the ring is full)
+    uint32_t pos = _head.load(std::memory_order_relaxed);
+    Slot *s;
+    while (true)
+    {
+        s = &_ring[pos & (LOG_RING_SIZE - 1)];
+        uint32_t seq = s->seq.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0)
+        {
+            if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // Writer task is behind: drop instead of waiting
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            _droppedTotal.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = _head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // 2. FILL AND PUBLISH
+    s->ts = (uint32_t)esp_timer_get_time();
+    s->id = (uint16_t)id;
+    s->meta = (uint8_t)((xPortGetCoreID() << 4) | nargs);
+    s->args[0] = a0;
+    s->args[1] = a1;
+    s->args[2] = a2;
+    s->seq.store(pos + 1, std::memory_order_release);
+}
+
+/**
+ * @brief CRC-8 (poly 0x07, init 0x00) over the raw record.
+ */
+static uint8_t crc8(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Consistent Overhead Byte Stuffing: removes every 0x00 from 'in'.
+ * @param out Buffer of at least len + len/254 + 1 bytes.
+ * @return Encoded length.
+ */
+static size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t codeIdx = 0; // Where the current block length byte goes
+    size_t o = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[codeIdx] = code;
+            codeIdx = o++;
+            code = 1;
+        }
+        else
+        {
+            out[o++] = in[i];
+            if (++code == 0xFF)
+            {
+                out[codeIdx] = code;
+                codeIdx = o++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIdx] = code;
+    return o;
+}
+
+void EventLog::emit(uint16_t id, uint32_t ts, uint8_t meta, const uint32_t *args)
+{
+    // 1. RAW RECORD (little-endian, native on Xtensa)
+    uint8_t raw[2 + 4 + 1 + 4 * MAX_ARGS + 1];
+    size_t n = 0;
+    uint8_t nargs = meta & 0x0F;
+    memcpy(raw + n, &id, 2);
+    n += 2;
+    memcpy(raw + n, &ts, 4);
+    n += 4;
+    raw[n++] = meta;
+    memcpy(raw + n, args, 4 * nargs);
+    n += 4 * nargs;
+    raw[n] = crc8(raw, n);
+    n++;
+
+    // 2. FRAME: delimiter + COBS + delimiter, written in ONE call so text
+    // lines printed by other tasks never land inside a record.
+    uint8_t frame[sizeof(raw) + 4];
+    frame[0] = 0x00;
+    size_t len = 1 + cobsEncode(raw, n, frame + 1);
+    frame[len++] = 0x00;
+    Serial.write(frame, len);
+}
+
+void EventLog::writerTask(void *arg)
+{
+    while (true)
+    {
+        vTaskDelay(pdMS_TO_TICKS(LOG_FLUSH_MS));
+
+        // 1. REPORT LOSSES FIRST (keeps the timeline honest)
+        uint32_t lost = _dropped.exchange(0, std::memory_order_relaxed);
+        if (lost > 0)
+        {
+            emit(LOG_DROPPED, (uint32_t)esp_timer_get_time(), (uint8_t)((xPortGetCoreID() << 4) | 1), &lost);
+        }
+
+        // 2. DRAIN (single reader: _tail is private to this task)
+        while (true)
+        {
+            Slot &s = _ring[_tail & (LOG_RING_SIZE - 1)];
+            if (s.seq.load(std::memory_order_acquire) != _tail + 1)
+                break; // Empty (or the writer at _tail has not published yet)
+
+            uint16_t id = s.id;
+            uint32_t ts = s.ts;
+            uint8_t meta = s.meta;
+            uint32_t args[MAX_ARGS] = {s.args[0], s.args[1], s.args[2]};
+            s.seq.store(_tail + LOG_RING_SIZE, std::memory_order_release); // Free the slot
+            _tail++;
+
+            emit(id, ts, meta, args); // May block on the UART: slot already released
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file EventLog.h
+ * @brief Deferred Binary Structured Logging (Lock-Free Ring + COBS over Serial).
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * Serial.printf() formats the text and then blocks until the UART has room:
+ * at 115200 baud a 50-char line holds the caller for ~4ms. On the control
+ * path that is a late brake.
+ *
+ * EventLog::log() instead stores {event ID, timestamp, raw arguments} in a
+ * bounded lock-free ring (no formatting, no heap, never blocks). A lowest
+ * priority task drains the ring and writes each record as one binary frame:
+ *
+ *   0x00 | COBS( id:u16 | ts_us:u32 | core:4 nargs:4 | args:u32 x nargs | crc8 ) | 0x00
+ *
+ * COBS guarantees no 0x00 inside a frame, so records can share the UART with
+ * the plain-text boot logs: the host decoder (tools.log_decoder) passes text
+ * through and rebuilds the binary records from the table in 'log_events.h'.
+ *
+ * @note When the ring is full the event is dropped and counted; the next
+ * drain emits LOG_DROPPED with the number lost.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "log_events.h"
+#include <atomic>
+
+class EventLog
+{
+public:
+    /** @brief Max raw arguments per event. */
+    static const int MAX_ARGS = 3;
+
+    /**
+     * @brief Starts the encoder task (TASK_EVENTLOG placement).
+     * @note Serial must already be running (at LOG_BAUD).
+     */
+    static void begin();
+
+    /**
+     * @brief Queues an event (lock-free, bounded: one CAS in the common case).
+     * @details Safe from any task on either core. Never formats, allocates or blocks.
+     * @param id Event from ROVER_LOG_EVENTS.
+     */
+    static inline void log(LogEvent id) { push(id, 0, 0, 0, 0); }
+    static inline void log(LogEvent id, uint32_t a0) { push(id, 1, a0, 0, 0); }
+    static inline void log(LogEvent id, uint32_t a0, uint32_t a1) { push(id, 2, a0, a1, 0); }
+    static inline void log(LogEvent id, uint32_t a0, uint32_t a1, uint32_t a2) { push(id, 3, a0, a1, a2); }
+
+    /**
+     * @brief Number of events lost because the ring was full (since boot).
+     */
+    static uint32_t dropped() { return _droppedTotal.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief One ring slot (24 bytes).
+     * @details 'seq' implements the bounded MPMC protocol (D. Vyukov):
+     * seq == pos     -> free for the writer that reserves 'pos'.
+     * seq == pos + 1 -> filled, ready for the reader at 'pos'.
+     */
+    struct Slot
+    {
+        std::atomic<uint32_t> seq;
+        uint32_t ts;            ///< esp_timer_get_time() low 32 bits
+        uint16_t id;            ///< LogEvent
+        uint8_t meta;           ///< core << 4 | nargs
+        uint8_t reserved;       ///< Padding (explicit)
+        uint32_t args[MAX_ARGS];
+    };
+
+    static void push(LogEvent id, uint8_t nargs, uint32_t a0, uint32_t a1, uint32_t a2);
+
+    /**
+     * @brief Encodes one record as a COBS frame and writes it to Serial.
+     */
+    static void emit(uint16_t id, uint32_t ts, uint8_t meta, const uint32_t *args);
+
+    /**
+     * @brief Encoder task body: drains the ring every LOG_FLUSH_MS.
+     */
+    static void writerTask(void *arg);
+
+    static Slot _ring[LOG_RING_SIZE];
+    static std::atomic<uint32_t> _head;         ///< Next position to reserve (writers)
+    static uint32_t _tail;                      ///< Next position to read (writer task only)
+    static std::atomic<uint32_t> _dropped;      ///< Lost since the last LOG_DROPPED
+    static std::atomic<uint32_t> _droppedTotal; ///< Lost since boot
+};
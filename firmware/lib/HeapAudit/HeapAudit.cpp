@@ -0,0 +1,221 @@
+/**
+ * @file HeapAudit.cpp
+ * @brief Heap Audit Counters, Allocator Wrappers and '/heap' Report.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "HeapAudit.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+
+std::atomic<bool> HeapAudit::_armed(false);
+std::atomic<uint32_t> HeapAudit::_allocs(0);
+std::atomic<uint32_t> HeapAudit::_bytes(0);
+HeapAudit::WatchSlot HeapAudit::_watch[MAX_WATCH];
+int HeapAudit::_watchCount = 0;
+HeapAudit::Offender HeapAudit::_offenders[MAX_OFFENDERS];
+std::atomic<uint32_t> HeapAudit::_offenderHead(0);
+uint32_t HeapAudit::_freeAtArm = 0;
+uint32_t HeapAudit::_largestAtArm = 0;
+
+void HeapAudit::arm()
+{
+    _freeAtArm = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    _largestAtArm = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    _armed.store(true, std::memory_order_release);
+
+#if ROVER_HEAP_AUDIT
+    Serial.printf("[HEAP] Audit armed: %u bytes free, largest block %u, %d task(s) watched%s\n",
+                  (unsigned)_freeAtArm, (unsigned)_largestAtArm, _watchCount,
+                  HEAP_AUDIT_ASSERT ? " (strict tasks abort)" : "");
+#else
+    Serial.println("[HEAP] Audit disabled (ROVER_HEAP_AUDIT=0): '/heap' reports fragmentation only.");
+#endif
+}
+
+bool HeapAudit::watch(const char *taskName, bool strict)
+{
+#if configUSE_TRACE_FACILITY
+    if (_watchCount >= MAX_WATCH || _armed.load(std::memory_order_relaxed))
+        return false;
+
+    // Resolve the name once (boot time: a static snapshot is fine here)
+    static TaskStatus_t tasks[32];
+    UBaseType_t n = uxTaskGetSystemState(tasks, 32, NULL);
+    for (UBaseType_t i = 0; i < n; i++)
+    {
+        if (strcmp(tasks[i].pcTaskName, taskName) == 0)
+        {
+            WatchSlot &s = _watch[_watchCount];
+            strncpy(s.name, taskName, sizeof(s.name) - 1);
+            s.name[sizeof(s.name) - 1] = '\0';
+            s.strict = strict;
+            s.allocs.store(0, std::memory_order_relaxed);
+            s.bytes.store(0, std::memory_order_relaxed);
+            s.task = tasks[i].xHandle;
+            _watchCount++;
+            return true;
+        }
+    }
+#endif
+    Serial.printf("[HEAP] WARNING: task '%s' not found, not watched.\n", taskName);
+    return false;
+}
+
+void HeapAudit::onAlloc(size_t size, void *caller)
+{
+    // 1. BOOT PHASE: everything is allowed
+    if (!_armed.load(std::memory_order_acquire))
+        return;
+
+    _allocs.fetch_add(1, std::memory_order_relaxed);
+    _bytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+
+    // 2. ATTRIBUTION (fixed table, linear scan: MAX_WATCH entries)
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < _watchCount; i++)
+    {
+        WatchSlot &s = _watch[i];
+        if (s.task != self)
+            continue;
+
+        s.allocs.fetch_add(1, std::memory_order_relaxed);
+        s.bytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+
+        uint32_t slot = _offenderHead.fetch_add(1, std::memory_order_relaxed) % MAX_OFFENDERS;
+        _offenders[slot].caller = (uint32_t)(uintptr_t)caller;
+        _offenders[slot].size = (uint32_t)size;
+        _offenders[slot].slot = (int8_t)i;
+
+#if HEAP_AUDIT_ASSERT
+        // 3. TRAP: ROM printf does not allocate; abort() prints the backtrace
+        if (s.strict)
+        {
+            esp_rom_printf("[HEAP] FATAL: '%s' allocated %u bytes after boot (caller 0x%08x)\n",
+                           s.name, (unsigned)size, (unsigned)(uintptr_t)caller);
+            abort();
+        }
+#endif
+        return;
+    }
+}
+
+esp_err_t HeapAudit::httpHandler(httpd_req_t *req)
+{
+    char line[192];
+
+    // 1. REGIONS: fragmentation = share of free memory NOT usable as one block
+    size_t freeInt = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    size_t largestInt = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    size_t freePs = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    size_t largestPs = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    unsigned fragInt = freeInt ? (unsigned)(1000 - (uint64_t)largestInt * 1000 / freeInt) : 0;
+    unsigned fragPs = freePs ? (unsigned)(1000 - (uint64_t)largestPs * 1000 / freePs) : 0;
+
+    httpd_resp_set_type(req, "application/json");
+
+    int len = snprintf(line, sizeof(line),
+                       "{\"audit\":%s,\"assert\":%s,\"armed\":%s,"
+                       "\"internal\":{\"free\":%u,\"largest\":%u,\"min_free\":%u,\"frag_pct\":%u.%u,",
+                       ROVER_HEAP_AUDIT ? "true" : "false", HEAP_AUDIT_ASSERT ? "true" : "false",
+                       _armed.load() ? "true" : "false",
+                       (unsigned)freeInt, (unsigned)largestInt,
+                       (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL),
+                       fragInt / 10, fragInt % 10);
+    httpd_resp_send_chunk(req, line, len);
+
+    len = snprintf(line, sizeof(line),
+                   "\"free_at_arm\":%u,\"largest_at_arm\":%u},"
+                   "\"psram\":{\"free\":%u,\"largest\":%u,\"frag_pct\":%u.%u},",
+                   (unsigned)_freeAtArm, (unsigned)_largestAtArm,
+                   (unsigned)freePs, (unsigned)largestPs, fragPs / 10, fragPs % 10);
+    httpd_resp_send_chunk(req, line, len);
+
+    // 2. POST-BOOT ALLOCATIONS (zero unless ROVER_HEAP_AUDIT=1)
+    len = snprintf(line, sizeof(line), "\"allocs_after_boot\":%u,\"bytes_after_boot\":%u,\"tasks\":[",
+                   (unsigned)_allocs.load(std::memory_order_relaxed),
+                   (unsigned)_bytes.load(std::memory_order_relaxed));
+    httpd_resp_send_chunk(req, line, len);
+
+    for (int i = 0; i < _watchCount; i++)
+    {
+        const WatchSlot &s = _watch[i];
+        len = snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"strict\":%s,\"allocs\":%u,\"bytes\":%u}",
+                       i ? "," : "", s.name, s.strict ? "true" : "false",
+                       (unsigned)s.allocs.load(std::memory_order_relaxed),
+                       (unsigned)s.bytes.load(std::memory_order_relaxed));
+        httpd_resp_send_chunk(req, line, len);
+    }
+
+    // 3. LAST OFFENDERS (newest first). Decode: xtensa-esp32-elf-addr2line -e firmware.elf <caller>
+    httpd_resp_send_chunk(req, "],\"offenders\":[", HTTPD_RESP_USE_STRLEN);
+    uint32_t head = _offenderHead.load(std::memory_order_relaxed);
+    uint32_t count = head > (uint32_t)MAX_OFFENDERS ? MAX_OFFENDERS : head;
+    for (uint32_t n = 0; n < count; n++)
+    {
+        const Offender &o = _offenders[(head - 1 - n) % MAX_OFFENDERS];
+        len = snprintf(line, sizeof(line), "%s{\"task\":\"%s\",\"size\":%u,\"caller\":\"0x%08x\"}",
+                       n ? "," : "", _watch[o.slot].name, (unsigned)o.size, (unsigned)o.caller);
+        httpd_resp_send_chunk(req, line, len);
+    }
+
+    httpd_resp_send_chunk(req, "]}", HTTPD_RESP_USE_STRLEN);
+    return httpd_resp_send_chunk(req, NULL, 0); // End of chunked response
+}
+
+// =============================================================================
+// ALLOCATOR WRAPPERS (-Wl,--wrap=<symbol>, see 'esp32cam_heapaudit' in platformio.ini)
+// =============================================================================
+// The linker redirects every call to <symbol> into __wrap_<symbol>; the
+// original stays reachable as __real_<symbol>. operator new and Arduino String
+// end up in malloc/realloc, so they are covered too.
+
+#if ROVER_HEAP_AUDIT
+
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t n, size_t size);
+    void *__real_realloc(void *ptr, size_t size);
+    void *__real_heap_caps_malloc(size_t size, uint32_t caps);
+    void *__real_heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+    void *__real_heap_caps_realloc(void *ptr, size_t size, uint32_t caps);
+
+    void *__wrap_malloc(size_t size)
+    {
+        HeapAudit::onAlloc(size, __builtin_return_address(0));
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t n, size_t size)
+    {
+        HeapAudit::onAlloc(n * size, __builtin_return_address(0));
+        return __real_calloc(n, size);
+    }
+
+    void *__wrap_realloc(void *ptr, size_t size)
+    {
+        HeapAudit::onAlloc(size, __builtin_return_address(0));
+        return __real_realloc(ptr, size);
+    }
+
+    void *__wrap_heap_caps_malloc(size_t size, uint32_t caps)
+    {
+        HeapAudit::onAlloc(size, __builtin_return_address(0));
+        return __real_heap_caps_malloc(size, caps);
+    }
+
+    void *__wrap_heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+    {
+        HeapAudit::onAlloc(n * size, __builtin_return_address(0));
+        return __real_heap_caps_calloc(n, size, caps);
+    }
+
+    void *__wrap_heap_caps_realloc(void *ptr, size_t size, uint32_t caps)
+    {
+        HeapAudit::onAlloc(size, __builtin_return_address(0));
+        return __real_heap_caps_realloc(ptr, size, caps);
+    }
+}
+
+#endif // ROVER_HEAP_AUDIT
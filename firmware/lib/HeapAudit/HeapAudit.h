@@ -0,0 +1,101 @@
+/**
+ * @file HeapAudit.h
+ * @brief Post-Boot Heap Allocation Audit and Fragmentation Report.
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * Long uptimes die of fragmentation: small allocations made while running
+ * split the free heap until a large block (frame buffer, TLS, pbuf chain)
+ * no longer fits, even though plenty of bytes are "free".
+ *
+ * Policy: every service buffer is allocated (statically or once) before
+ * setup() returns. arm() closes the boot phase; from then on:
+ * - '/heap' reports free/largest/minimum per region and a fragmentation %.
+ * - With ROVER_HEAP_AUDIT=1 the allocator is wrapped at link time
+ *   (-Wl,--wrap=malloc,...): every allocation after arm() is counted,
+ *   attributed to watched tasks and the last offenders (caller address,
+ *   size, task) are kept for '/heap'.
+ * - With HEAP_AUDIT_ASSERT=1 a 'strict' watched task that allocates aborts
+ *   with a backtrace pointing at the offending call.
+ *
+ * @note Allocations by the IDF tasks (WiFi, lwIP pbufs) are counted as "other":
+ * they use their own pools/caches and are expected.
+ * @warning The wrapper runs inside malloc(): it never allocates, logs or blocks.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "esp_http_server.h"
+#include "config.h"
+#include <atomic>
+
+class HeapAudit
+{
+public:
+    /** @brief Max watched tasks (fixed table, no heap): 10 fixed tasks + the stream senders. */
+    static const int MAX_WATCH = 10 + STREAM_MAX_CLIENTS;
+    /** @brief Offender ring capacity (last N allocations by watched tasks). */
+    static const int MAX_OFFENDERS = 16;
+
+    /**
+     * @brief Ends the boot phase: snapshots the heap and starts counting.
+     * @note Call at the very end of setup(), after every service is running.
+     */
+    static void arm();
+
+    /**
+     * @brief Attributes post-boot allocations of a task (by FreeRTOS name).
+     * @param taskName Name given at task creation (e.g. "control", "httpd").
+     * @param strict true = abort on allocation when HEAP_AUDIT_ASSERT is set.
+     * @return false if the task does not exist or the table is full.
+     * @note Call before arm() (resolves the name with uxTaskGetSystemState).
+     */
+    static bool watch(const char *taskName, bool strict);
+
+    /**
+     * @brief Allocation hook (called by the malloc wrappers).
+     * @param size Requested bytes.
+     * @param caller Return address of the allocating call.
+     */
+    static void onAlloc(size_t size, void *caller);
+
+    /**
+     * @brief HTTP handler serving the heap report as JSON ('/heap').
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t Operation status.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+
+private:
+    /**
+     * @brief Per-task attribution slot.
+     */
+    struct WatchSlot
+    {
+        TaskHandle_t task;             ///< Watched task (NULL = free slot)
+        char name[16];                 ///< Copy of the task name
+        bool strict;                   ///< Trap allocations (HEAP_AUDIT_ASSERT)
+        std::atomic<uint32_t> allocs;  ///< Allocations after arm()
+        std::atomic<uint32_t> bytes;   ///< Bytes requested after arm()
+    };
+
+    /**
+     * @brief One recorded offending allocation.
+     */
+    struct Offender
+    {
+        uint32_t caller;   ///< Return address (decode with addr2line)
+        uint32_t size;     ///< Requested bytes
+        int8_t slot;       ///< WatchSlot index
+    };
+
+    static std::atomic<bool> _armed;
+    static std::atomic<uint32_t> _allocs;     ///< All allocations after arm()
+    static std::atomic<uint32_t> _bytes;      ///< All bytes requested after arm()
+    static WatchSlot _watch[MAX_WATCH];
+    static int _watchCount;
+    static Offender _offenders[MAX_OFFENDERS];
+    static std::atomic<uint32_t> _offenderHead; ///< Total offenders recorded
+    static uint32_t _freeAtArm;                 ///< Internal free bytes at arm()
+    static uint32_t _largestAtArm;              ///< Internal largest block at arm()
+};
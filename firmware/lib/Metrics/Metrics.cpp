@@ -0,0 +1,253 @@
+/**
+ * @file Metrics.cpp
+ * @brief Metrics Registry Definition and Prometheus Renderer.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "Metrics.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+// =============================================================================
+// BUCKET LAYOUTS
+// =============================================================================
+// fb_get: ~66ms at 15 FPS (waiting for VSYNC) down to <1ms if a frame is ready.
+static const uint32_t CAPTURE_US_BOUNDS[] = {1000, 5000, 10000, 20000, 40000, 70000, 100000, 200000, 500000};
+// QVGA @ q60 is ~3-6KB; UXGA stills reach ~150KB.
+static const uint32_t FRAME_BYTES_BOUNDS[] = {2048, 4096, 8192, 16384, 32768, 65536, 131072};
+// loop() body: sub-ms normally; ms-range means something blocked the control path.
+static const uint32_t LOOP_US_BOUNDS[] = {50, 100, 250, 500, 1000, 2500, 5000, 10000, 50000};
+// recvfrom() -> PWM registers written: tens of us unless the control task is preempted.
+static const uint32_t APPLY_US_BOUNDS[] = {25, 50, 100, 200, 400, 800, 1600, 3200, 6400, 12800};
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+// =============================================================================
+// REGISTRY STORAGE (Static: zero heap)
+// =============================================================================
+Counter Metrics::framesCaptured;
+Counter Metrics::framesSent;
+Counter Metrics::bytesSent;
+Counter Metrics::sendFailures;
+Counter Metrics::streamEvictions;
+Counter Metrics::captureFailures;
+Counter Metrics::wsFramesSent;
+Counter Metrics::stillCaptures;
+Gauge Metrics::stillSwitchMs;
+Gauge Metrics::stillGapMs;
+Histogram Metrics::captureUs(CAPTURE_US_BOUNDS, COUNT_OF(CAPTURE_US_BOUNDS));
+Histogram Metrics::frameBytes(FRAME_BYTES_BOUNDS, COUNT_OF(FRAME_BYTES_BOUNDS));
+
+Counter Metrics::udpReceived;
+Counter Metrics::udpRejected;
+Counter Metrics::wsCommands;
+Counter Metrics::failsafeTrips;
+Histogram Metrics::controlApplyUs(APPLY_US_BOUNDS, COUNT_OF(APPLY_US_BOUNDS));
+
+Gauge Metrics::linkIntervalMs;
+Gauge Metrics::linkJitterMs;
+Gauge Metrics::linkTimeoutMs;
+Gauge Metrics::linkRssiDbm;
+Gauge Metrics::linkThrottle;
+
+Gauge Metrics::powerTempC;
+Gauge Metrics::powerStep;
+Gauge Metrics::powerCpuMhz;
+Gauge Metrics::powerTxQdbm;
+Counter Metrics::powerDroops;
+
+Counter Metrics::webServed;
+Counter Metrics::webNotModified;
+
+Counter Metrics::loopIterations;
+Histogram Metrics::loopUs(LOOP_US_BOUNDS, COUNT_OF(LOOP_US_BOUNDS));
+
+/**
+ * @brief Exposition table entry (one family per line group).
+ */
+struct CounterDesc
+{
+    const char *name;
+    const char *help;
+    const Counter *counter;
+};
+
+struct HistogramDesc
+{
+    const char *name;
+    const char *help;
+    const Histogram *histogram;
+};
+
+struct GaugeDesc
+{
+    const char *name;
+    const char *help;
+    const Gauge *gauge;
+};
+
+static const CounterDesc COUNTERS[] = {
+    {"rover_frames_captured_total", "Frames delivered by the camera driver", &Metrics::framesCaptured},
+    {"rover_frames_sent_total", "JPEG frames fully sent on /stream", &Metrics::framesSent},
+    {"rover_bytes_sent_total", "JPEG payload bytes sent on /stream", &Metrics::bytesSent},
+    {"rover_send_failures_total", "Stream chunk send errors", &Metrics::sendFailures},
+    {"rover_stream_evictions_total", "Stream clients purged to admit a new one", &Metrics::streamEvictions},
+    {"rover_capture_failures_total", "esp_camera_fb_get() failures", &Metrics::captureFailures},
+    {"rover_ws_frames_sent_total", "JPEG frames pushed over WebSocket", &Metrics::wsFramesSent},
+    {"rover_still_captures_total", "High-resolution stills served on /still", &Metrics::stillCaptures},
+    {"rover_udp_received_total", "Control datagrams received", &Metrics::udpReceived},
+    {"rover_udp_rejected_total", "Control datagrams rejected (malformed)", &Metrics::udpRejected},
+    {"rover_ws_commands_total", "Control commands received over WebSocket", &Metrics::wsCommands},
+    {"rover_failsafe_trips_total", "Failsafe activations (signal lost)", &Metrics::failsafeTrips},
+    {"rover_power_droops_total", "Supply droops (brown-out comparator, no reset)", &Metrics::powerDroops},
+    {"rover_web_served_total", "Web UI files sent in full", &Metrics::webServed},
+    {"rover_web_not_modified_total", "Web UI revalidations answered 304", &Metrics::webNotModified},
+    {"rover_loop_iterations_total", "Main loop iterations", &Metrics::loopIterations},
+};
+
+static const HistogramDesc HISTOGRAMS[] = {
+    {"rover_capture_latency_us", "esp_camera_fb_get() latency in microseconds", &Metrics::captureUs},
+    {"rover_frame_size_bytes", "JPEG frame size in bytes", &Metrics::frameBytes},
+    {"rover_loop_duration_us", "Main loop body duration in microseconds", &Metrics::loopUs},
+    {"rover_control_apply_us", "Control datagram read to PWM written in microseconds", &Metrics::controlApplyUs},
+};
+
+static const GaugeDesc GAUGES[] = {
+    {"rover_still_switch_ms", "Last still: sensor reconfiguration to captured frame", &Metrics::stillSwitchMs},
+    {"rover_still_stream_gap_ms", "Last still: stream pause including profile restore", &Metrics::stillGapMs},
+    {"rover_link_interval_ms", "Smoothed control command inter-arrival", &Metrics::linkIntervalMs},
+    {"rover_link_jitter_ms", "Smoothed control inter-arrival deviation", &Metrics::linkJitterMs},
+    {"rover_link_timeout_ms", "Adaptive failsafe timeout", &Metrics::linkTimeoutMs},
+    {"rover_link_rssi_dbm", "Smoothed pilot link RSSI (0 = unknown)", &Metrics::linkRssiDbm},
+    {"rover_link_throttle_limit", "Max forward PWM allowed by link quality", &Metrics::linkThrottle},
+    {"rover_power_temperature_celsius", "Die temperature (smoothed, calibrated)", &Metrics::powerTempC},
+    {"rover_power_step", "Power governor step (0 = full performance)", &Metrics::powerStep},
+    {"rover_power_cpu_mhz", "CPU clock", &Metrics::powerCpuMhz},
+    {"rover_power_tx_qdbm", "WiFi TX power ceiling in 0.25 dBm", &Metrics::powerTxQdbm},
+};
+
+// =============================================================================
+// HISTOGRAM
+// =============================================================================
+
+Histogram::Histogram(const uint32_t *bounds, int numBounds)
+    : _bounds(bounds), _numBounds(numBounds > MAX_BUCKETS ? MAX_BUCKETS : numBounds), _sum(0), _count(0)
+{
+    for (int i = 0; i <= MAX_BUCKETS; i++)
+    {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(uint32_t value)
+{
+    int i = 0;
+    while (i < _numBounds && value > _bounds[i])
+    {
+        i++;
+    }
+    _buckets[i].fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+}
+
+// =============================================================================
+// PROMETHEUS RENDERER
+// =============================================================================
+
+/**
+ * @brief Small write-combining buffer: batches lines into ~512B chunks
+ * to avoid one TCP segment per metric line.
+ */
+struct ChunkWriter
+{
+    httpd_req_t *req;
+    char buf[512];
+    size_t len;
+
+    void flush()
+    {
+        if (len > 0)
+        {
+            httpd_resp_send_chunk(req, buf, len);
+            len = 0;
+        }
+    }
+
+    void append(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char line[256];
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(line, sizeof(line), fmt, args);
+        va_end(args);
+        if (n <= 0)
+            return;
+        if ((size_t)n >= sizeof(line))
+            n = sizeof(line) - 1; // Truncated line (should not happen with our names)
+        if (len + n > sizeof(buf))
+            flush();
+        memcpy(buf + len, line, n);
+        len += n;
+    }
+};
+
+esp_err_t Metrics::httpHandler(httpd_req_t *req)
+{
+    ChunkWriter w;
+    w.req = req;
+    w.len = 0;
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+
+    // 1. COUNTERS
+    for (int i = 0; i < COUNT_OF(COUNTERS); i++)
+    {
+        const CounterDesc &d = COUNTERS[i];
+        w.append("# HELP %s %s\n# TYPE %s counter\n%s %u\n",
+                 d.name, d.help, d.name, d.name, d.counter->get());
+    }
+
+    // 2. HISTOGRAMS (Cumulative buckets)
+    for (int i = 0; i < COUNT_OF(HISTOGRAMS); i++)
+    {
+        const HistogramDesc &d = HISTOGRAMS[i];
+        const Histogram *h = d.histogram;
+        w.append("# HELP %s %s\n# TYPE %s histogram\n", d.name, d.help, d.name);
+
+        uint32_t cumulative = 0;
+        for (int b = 0; b < h->numBounds(); b++)
+        {
+            cumulative += h->bucket(b);
+            w.append("%s_bucket{le=\"%u\"} %u\n", d.name, h->bound(b), cumulative);
+        }
+        cumulative += h->bucket(h->numBounds());
+        w.append("%s_bucket{le=\"+Inf\"} %u\n", d.name, cumulative);
+        w.append("%s_sum %u\n%s_count %u\n", d.name, h->sum(), d.name, h->count());
+    }
+
+    // 3. GAUGES (Last value set by their owner)
+    for (int i = 0; i < COUNT_OF(GAUGES); i++)
+    {
+        const GaugeDesc &d = GAUGES[i];
+        w.append("# HELP %s %s\n# TYPE %s gauge\n%s %d\n",
+                 d.name, d.help, d.name, d.name, (int)d.gauge->get());
+    }
+
+    // 4. GAUGES (Sampled now: memory and uptime)
+    w.append("# TYPE rover_heap_free_bytes gauge\nrover_heap_free_bytes %u\n",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    w.append("# TYPE rover_heap_min_free_bytes gauge\nrover_heap_min_free_bytes %u\n",
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    w.append("# TYPE rover_heap_largest_block_bytes gauge\nrover_heap_largest_block_bytes %u\n",
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    w.append("# TYPE rover_psram_free_bytes gauge\nrover_psram_free_bytes %u\n",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    w.append("# TYPE rover_psram_min_free_bytes gauge\nrover_psram_min_free_bytes %u\n",
+             (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+    w.append("# TYPE rover_uptime_seconds gauge\nrover_uptime_seconds %lu\n",
+             (unsigned long)(esp_timer_get_time() / 1000000));
+
+    w.flush();
+    return httpd_resp_send_chunk(req, NULL, 0); // End of chunked response
+}
@@ -0,0 +1,157 @@
+/**
+ * @file Metrics.h
+ * @brief Lock-Free Runtime Metrics Registry (Prometheus Text Exposition).
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * Hot paths (stream loop, UDP listener, main loop) update counters and
+ * histograms with relaxed atomic adds: no locks, no heap, no blocking.
+ * The registry is a static table rendered on demand at '/metrics'.
+ *
+ * @note 32-bit atomics are native on the Xtensa core (S32C1I). 64-bit ones are
+ * not (libatomic falls back to a lock), so every value wraps at 2^32.
+ * Prometheus rate() handles counter wraps as resets.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "esp_http_server.h"
+
+/**
+ * @brief Monotonic event counter.
+ */
+class Counter
+{
+private:
+    std::atomic<uint32_t> _value;
+
+public:
+    constexpr Counter() : _value(0) {}
+
+    /** @brief Adds n (default 1). Safe from any task/core. */
+    inline void inc(uint32_t n = 1) { _value.fetch_add(n, std::memory_order_relaxed); }
+
+    /** @brief Current value (wraps at 2^32). */
+    inline uint32_t get() const { return _value.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Last-value gauge (signed: e.g. RSSI in dBm).
+ */
+class Gauge
+{
+private:
+    std::atomic<int32_t> _value;
+
+public:
+    constexpr Gauge() : _value(0) {}
+
+    /** @brief Replaces the value. Safe from any task/core. */
+    inline void set(int32_t v) { _value.store(v, std::memory_order_relaxed); }
+
+    /** @brief Current value. */
+    inline int32_t get() const { return _value.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Fixed-bucket histogram (cumulative rendering, Prometheus style).
+ * @details Bucket bounds are a static array provided at construction.
+ * observe() is a linear scan over <= MAX_BUCKETS bounds plus 3 atomic adds.
+ */
+class Histogram
+{
+public:
+    /** @brief Max number of finite bounds ("+Inf" is implicit). */
+    static const int MAX_BUCKETS = 12;
+
+private:
+    const uint32_t *_bounds;                         ///< Upper bounds (ascending, inclusive)
+    int _numBounds;                                  ///< Number of finite bounds
+    std::atomic<uint32_t> _buckets[MAX_BUCKETS + 1]; ///< Non-cumulative counts (+Inf last)
+    std::atomic<uint32_t> _sum;                      ///< Sum of observed values (wraps)
+    std::atomic<uint32_t> _count;                    ///< Number of observations
+
+public:
+    /**
+     * @brief Constructor.
+     * @param bounds Static array of ascending upper bounds.
+     * @param numBounds Number of entries (clamped to MAX_BUCKETS).
+     */
+    Histogram(const uint32_t *bounds, int numBounds);
+
+    /**
+     * @brief Records one value. Safe from any task/core.
+     * @param value Observation (unit defined by the metric, e.g. us or bytes).
+     */
+    void observe(uint32_t value);
+
+    /** @brief Number of finite bounds. */
+    inline int numBounds() const { return _numBounds; }
+    /** @brief Upper bound of bucket i. */
+    inline uint32_t bound(int i) const { return _bounds[i]; }
+    /** @brief Non-cumulative count of bucket i (i == numBounds() -> +Inf). */
+    inline uint32_t bucket(int i) const { return _buckets[i].load(std::memory_order_relaxed); }
+    /** @brief Sum of observations. */
+    inline uint32_t sum() const { return _sum.load(std::memory_order_relaxed); }
+    /** @brief Number of observations. */
+    inline uint32_t count() const { return _count.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @brief Global metrics registry (static members: reachable from C callbacks).
+ */
+class Metrics
+{
+public:
+    // --- VIDEO (CameraServer) ---
+    static Counter framesCaptured;  ///< Successful esp_camera_fb_get() (all consumers)
+    static Counter framesSent;      ///< JPEG frames fully sent (MJPEG stream)
+    static Counter bytesSent;       ///< Payload bytes sent (MJPEG stream)
+    static Counter sendFailures;    ///< Chunk send errors (client gone / timeout)
+    static Counter streamEvictions; ///< Stream clients purged to admit a new one (LRU)
+    static Counter captureFailures; ///< esp_camera_fb_get() returned NULL
+    static Counter wsFramesSent;    ///< JPEG frames pushed over WebSocket
+    static Counter stillCaptures;   ///< High-resolution stills served on '/still'
+    static Gauge stillSwitchMs;     ///< Last still: sensor switch to captured frame (ms)
+    static Gauge stillGapMs;        ///< Last still: total stream pause (ms)
+    static Histogram captureUs;     ///< esp_camera_fb_get() latency (us)
+    static Histogram frameBytes;    ///< JPEG size distribution (bytes)
+
+    // --- CONTROL (RemoteControl) ---
+    static Counter udpReceived;      ///< Datagrams read from the control socket
+    static Counter udpRejected;      ///< Datagrams dropped (malformed)
+    static Counter wsCommands;       ///< Commands received over WebSocket
+    static Counter failsafeTrips;    ///< Failsafe activations
+    static Histogram controlApplyUs; ///< Datagram read -> actuators written (us)
+
+    // --- LINK GOVERNOR (RemoteControl) ---
+    static Gauge linkIntervalMs; ///< Smoothed command inter-arrival (ms)
+    static Gauge linkJitterMs;   ///< Smoothed inter-arrival deviation (ms)
+    static Gauge linkTimeoutMs;  ///< Adaptive failsafe timeout (ms)
+    static Gauge linkRssiDbm;    ///< Smoothed pilot link RSSI (dBm, 0 = unknown)
+    static Gauge linkThrottle;   ///< Max forward PWM allowed by link quality
+
+    // --- POWER GOVERNOR (PowerGovernor) ---
+    static Gauge powerTempC;     ///< Smoothed, calibrated die temperature (degC)
+    static Gauge powerStep;      ///< POWER_STEPS index in force
+    static Gauge powerCpuMhz;    ///< CPU clock (MHz)
+    static Gauge powerTxQdbm;    ///< WiFi TX power ceiling (0.25 dBm)
+    static Counter powerDroops;  ///< Supply droops seen by the brown-out comparator
+
+    // --- WEB UI (WebUI) ---
+    static Counter webServed;      ///< Web UI files sent (200, full body)
+    static Counter webNotModified; ///< Web UI revalidations answered 304 (browser cache hit)
+
+    // --- SCHEDULING (main loop) ---
+    static Counter loopIterations; ///< Control loop (scheduler) wake-ups
+    static Histogram loopUs;       ///< Control loop body duration (us)
+
+    /**
+     * @brief HTTP handler serving all metrics in Prometheus text format 0.0.4.
+     * @details Also samples heap/PSRAM free and low-water marks at scrape time.
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t Operation status.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+};
@@ -2,46 +2,97 @@
  * @file NetworkManager.cpp
  * @brief Hybrid Network Manager Implementation (STA + AP).
  * @author Alejandro Moyano (@AleSMC)
- * @version 1.1.0
+ * @version 1.4.0
  */
 
 #include "NetworkManager.h"
 
+// NVS location of the association cache
+static const char *NVS_NAMESPACE = "netcache";
+static const char *NVS_KEY = "sta";
+static const uint32_t WIFI_CACHE_MAGIC = 0x52564331; // "RVC1"
+
 NetworkManager::NetworkManager()
 {
     _isAP = false; // Initial state: Assume Client role (STA)
+    _fastPath = false;
+    _connectMs = 0;
+    _ipCache = 0;
+    strcpy(_ipText, "0.0.0.0");
 }
 
 void NetworkManager::begin()
 {
     // 1. INITIAL CONFIGURATION
-    // Force Station mode to clean previous configurations
+    // Force Station mode to clean previous configurations.
+    // Persistence is disabled: we manage our own cache (the SDK one does not
+    // store the DHCP lease and rewrites flash on every begin()).
+    WiFi.persistent(false);
     WiFi.mode(WIFI_STA);
 
     Serial.println("\n[NET] Starting connectivity manager...");
     Serial.printf("[NET] Attempting to connect to SSID: %s\n", WIFI_SSID);
 
-    // 2. CONNECTION ATTEMPT (STA)
-    // Uses credentials defined in 'secrets.h'
-    WiFi.begin(WIFI_SSID, WIFI_PASS);
-
-    // 3. ACTIVE WAIT WITH TIMEOUT (10s)
-    // We block boot briefly to attempt connection.
-    // If it fails, we don't block the system eternally; we switch to Plan B.
     unsigned long startAttempt = millis();
     bool connected = false;
 
-    while (millis() - startAttempt < 10000)
+    // 2. FAST-RECONNECT ATTEMPT (Cached BSSID + Channel + Lease)
+    // A directed connect skips the ~13-channel active scan, and reusing the
+    // lease skips DHCP. Typical association drops from seconds to ~300ms.
+    WiFiCache cache;
+    memset(&cache, 0, sizeof(cache));
+    if (loadCache(cache))
     {
-        if (WiFi.status() == WL_CONNECTED)
+        Serial.printf("[NET] Fast-Reconnect: BSSID %02X:%02X:%02X:%02X:%02X:%02X | Channel %d\n",
+                      cache.bssid[0], cache.bssid[1], cache.bssid[2],
+                      cache.bssid[3], cache.bssid[4], cache.bssid[5], cache.channel);
+
+#if WIFI_USE_STATIC_IP
+        WiFi.config(IPAddress(WIFI_STATIC_IP), IPAddress(WIFI_STATIC_GATEWAY),
+                    IPAddress(WIFI_STATIC_SUBNET), IPAddress(WIFI_STATIC_DNS));
+#elif WIFI_FAST_CONNECT_REUSE_LEASE
+        if (cache.ip != 0)
         {
-            connected = true;
-            break;
+            WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway),
+                        IPAddress(cache.subnet), IPAddress(cache.dns));
+        }
+#endif
+
+        WiFi.begin(WIFI_SSID, WIFI_PASS, cache.channel, cache.bssid);
+        connected = waitForConnection(WIFI_FAST_CONNECT_TIMEOUT_MS);
+
+        if (connected)
+        {
+            _fastPath = true;
+        }
+        else
+        {
+            // AP replaced, moved channel or lease rejected: forget and rescan.
+            Serial.println("[NET] Fast-Reconnect failed. Falling back to full scan.");
+            WiFi.disconnect();
+            clearCache();
+            memset(&cache, 0, sizeof(cache)); // Force a rewrite after the full connect
         }
-        delay(500);
-        Serial.print(".");
     }
-    Serial.println();
+
+    // 3. FULL CONNECTION ATTEMPT (STA)
+    // Uses credentials defined in 'secrets.h'.
+    // We block boot briefly to attempt connection.
+    // If it fails, we don't block the system eternally; we switch to Plan B.
+    if (!connected)
+    {
+#if WIFI_USE_STATIC_IP
+        WiFi.config(IPAddress(WIFI_STATIC_IP), IPAddress(WIFI_STATIC_GATEWAY),
+                    IPAddress(WIFI_STATIC_SUBNET), IPAddress(WIFI_STATIC_DNS));
+#else
+        // Restore DHCP in case the fast path applied the cached lease
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+#endif
+        WiFi.begin(WIFI_SSID, WIFI_PASS);
+        connected = waitForConnection(WIFI_CONNECT_TIMEOUT_MS);
+    }
+
+    _connectMs = millis() - startAttempt;
 
     // 4. RESULT EVALUATION AND FAILOVER
     if (connected)
@@ -51,6 +102,11 @@ void NetworkManager::begin()
         Serial.println("[NET] Connection Successful!");
         Serial.printf("[NET] Mode: STATION (Client)\n");
         Serial.printf("[NET] Signal (RSSI): %d dBm\n", WiFi.RSSI());
+        Serial.printf("[NET] Path: %s | Association time: %lu ms\n",
+                      _fastPath ? "FAST (Cached BSSID)" : "FULL (Scan + DHCP)", _connectMs);
+
+        // Remember this association for the next boot
+        saveCache(cache);
     }
     else
     {
@@ -84,6 +140,7 @@ void NetworkManager::begin()
     if (MDNS.begin(DEVICE_HOSTNAME))
     {
         Serial.printf("[NET] mDNS started. Access via: http://%s.local\n", DEVICE_HOSTNAME);
+        advertiseServices();
     }
     else
     {
@@ -92,10 +149,39 @@ void NetworkManager::begin()
 
     // FINAL IP REPORT
     Serial.println("------------------------------------------------");
-    Serial.printf("[INFO] IP ADDRESS: %s\n", getIP().c_str());
+    Serial.printf("[INFO] IP ADDRESS: %s\n", getIP());
     Serial.println("------------------------------------------------");
 }
 
+void NetworkManager::advertiseServices()
+{
+    char value[12];
+
+    // 1. WEB SERVER: generic browsers/tools find the stream path
+    MDNS.addService("_http", "_tcp", HTTP_PORT);
+    MDNS.addServiceTxt("_http", "_tcp", "path", "/stream");
+
+    // 2. CONTROL ENDPOINT: everything a client needs to connect in one answer
+    MDNS.addService(MDNS_ROVER_SERVICE, "_udp", UDP_PORT);
+    snprintf(value, sizeof(value), "%d", ControlProtocol::VERSION);
+    MDNS.addServiceTxt(MDNS_ROVER_SERVICE, "_udp", "proto", value);
+    snprintf(value, sizeof(value), "%d", HTTP_PORT);
+    MDNS.addServiceTxt(MDNS_ROVER_SERVICE, "_udp", "http", value);
+    MDNS.addServiceTxt(MDNS_ROVER_SERVICE, "_udp", "stream", "/stream");
+    snprintf(value, sizeof(value), "%d", DSCP_CONTROL);
+    MDNS.addServiceTxt(MDNS_ROVER_SERVICE, "_udp", "dscp", value);
+
+    // Video transports this build can serve ('ws' needs httpd WebSocket support)
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    MDNS.addServiceTxt(MDNS_ROVER_SERVICE, "_udp", "video", "mjpeg,ws");
+#else
+    MDNS.addServiceTxt(MDNS_ROVER_SERVICE, "_udp", "video", "mjpeg");
+#endif
+
+    Serial.printf("[NET] mDNS services: _http._tcp:%d, %s._udp:%d (proto %d)\n",
+                  HTTP_PORT, MDNS_ROVER_SERVICE, UDP_PORT, ControlProtocol::VERSION);
+}
+
 void NetworkManager::update()
 {
     /**
@@ -111,20 +197,132 @@ void NetworkManager::update()
      */
 }
 
-String NetworkManager::getIP()
+const char *NetworkManager::getIP()
 {
     // Returns the correct IP based on active mode
-    if (_isAP)
+    IPAddress ip = _isAP ? WiFi.softAPIP() : WiFi.localIP();
+
+    // Re-format only when the address changes (no String, no heap)
+    uint32_t raw = (uint32_t)ip;
+    if (raw != _ipCache)
     {
-        return WiFi.softAPIP().toString();
+        snprintf(_ipText, sizeof(_ipText), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+        _ipCache = raw;
     }
-    else
+    return _ipText;
+}
+
+const char *NetworkManager::getMode()
+{
+    return _isAP ? "AP (Hotspot)" : "STA (Home WiFi)";
+}
+
+int NetworkManager::getRssi()
+{
+    if (!_isAP)
     {
-        return WiFi.localIP().toString();
+        return (WiFi.status() == WL_CONNECTED) ? WiFi.RSSI() : 0;
     }
+
+    // AP: the driver keeps the last RSSI of every associated station
+    wifi_sta_list_t list;
+    if (esp_wifi_ap_get_sta_list(&list) != ESP_OK || list.num == 0)
+    {
+        return 0;
+    }
+    int best = -127;
+    for (int i = 0; i < list.num; i++)
+    {
+        if (list.sta[i].rssi > best)
+        {
+            best = list.sta[i].rssi;
+        }
+    }
+    return best;
 }
 
-String NetworkManager::getMode()
+bool NetworkManager::usedFastPath()
 {
-    return _isAP ? "AP (Hotspot)" : "STA (Home WiFi)";
+    return _fastPath;
+}
+
+unsigned long NetworkManager::getConnectTimeMs()
+{
+    return _connectMs;
+}
+
+bool NetworkManager::waitForConnection(unsigned long timeoutMs)
+{
+    // Short polling period: a directed connect often completes in <500ms,
+    // so the original 500ms granularity would waste most of the gain.
+    unsigned long start = millis();
+    unsigned long lastDot = start;
+
+    while (millis() - start < timeoutMs)
+    {
+        if (WiFi.status() == WL_CONNECTED)
+        {
+            Serial.println();
+            return true;
+        }
+        delay(20);
+        if (millis() - lastDot >= 500)
+        {
+            lastDot = millis();
+            Serial.print(".");
+        }
+    }
+    Serial.println();
+    return false;
+}
+
+bool NetworkManager::loadCache(WiFiCache &cache)
+{
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) // Read-only
+    {
+        return false;
+    }
+
+    size_t len = prefs.getBytes(NVS_KEY, &cache, sizeof(cache));
+    prefs.end();
+
+    return (len == sizeof(cache)) && (cache.magic == WIFI_CACHE_MAGIC) && (cache.channel > 0);
+}
+
+void NetworkManager::saveCache(const WiFiCache &previous)
+{
+    WiFiCache cache;
+    memset(&cache, 0, sizeof(cache)); // Zero padding bytes: memcmp below must be stable
+    cache.magic = WIFI_CACHE_MAGIC;
+    memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+    cache.channel = (uint8_t)WiFi.channel();
+    cache.ip = (uint32_t)WiFi.localIP();
+    cache.gateway = (uint32_t)WiFi.gatewayIP();
+    cache.subnet = (uint32_t)WiFi.subnetMask();
+    cache.dns = (uint32_t)WiFi.dnsIP();
+
+    // FLASH ENDURANCE: Skip the write if nothing changed (normal case at home).
+    if (memcmp(&cache, &previous, sizeof(cache)) == 0)
+    {
+        return;
+    }
+
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false))
+    {
+        prefs.putBytes(NVS_KEY, &cache, sizeof(cache));
+        prefs.end();
+        Serial.println("[NET] Association cache updated (NVS).");
+    }
+}
+
+void NetworkManager::clearCache()
+{
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false))
+    {
+        prefs.remove(NVS_KEY);
+        prefs.end();
+    }
 }
@@ -2,18 +2,41 @@
  * @file NetworkManager.h
  * @brief WiFi Connectivity Interface Contract (STA + AP).
  * @author Alejandro Moyano (@AleSMC)
- * @version 1.1.0
+ * @version 1.5.0
  * @details
  * Exposes methods to manage the connection without blocking the main thread
  * indefinitely and provides getters for telemetry.
+ * Implements a Fast-Reconnect path (cached BSSID/Channel/IP in NVS) that skips
+ * the channel scan and DHCP handshake on subsequent boots.
+ * Getters return static text (no Arduino String): safe to call after boot
+ * without touching the heap.
  */
 
 #pragma once
 #include <Arduino.h>
 #include <WiFi.h>
 #include <ESPmDNS.h>
+#include <Preferences.h>
+#include "esp_wifi.h"
+#include "config.h"
 #include "secrets.h" // Critical dependency: WIFI_SSID, AP_SSID, etc.
 
+/**
+ * @brief Last known-good association parameters (persisted in NVS).
+ * @details Stored as a single binary blob. 'magic' invalidates entries written
+ * by older firmware layouts.
+ */
+struct WiFiCache
+{
+    uint32_t magic;    ///< Layout marker (WIFI_CACHE_MAGIC)
+    uint8_t bssid[6];  ///< MAC of the Access Point we associated with
+    uint8_t channel;   ///< Primary channel of that AP
+    uint32_t ip;       ///< Leased (or static) IPv4 address
+    uint32_t gateway;  ///< Default gateway
+    uint32_t subnet;   ///< Network mask
+    uint32_t dns;      ///< Primary DNS server
+};
+
 class NetworkManager
 {
 private:
@@ -24,6 +47,52 @@ private:
      */
     bool _isAP;
 
+    /**
+     * @brief Boot path used for the STA connection.
+     * - true: Directed connect with cached BSSID/Channel (Fast-Reconnect).
+     * - false: Full scan + DHCP (or AP failover).
+     */
+    bool _fastPath;
+
+    unsigned long _connectMs; ///< Time spent associating (ms), for boot reports
+
+    uint32_t _ipCache; ///< Address currently formatted in _ipText
+    char _ipText[16];  ///< "XXX.XXX.XXX.XXX" + NUL
+
+    /**
+     * @brief Polls the WiFi driver until connected or timeout.
+     * @param timeoutMs Max wait in milliseconds.
+     * @return true if WL_CONNECTED was reached.
+     */
+    bool waitForConnection(unsigned long timeoutMs);
+
+    /**
+     * @brief Reads the association cache from NVS.
+     * @param cache Output structure.
+     * @return true if a valid entry (correct size and magic) exists.
+     */
+    bool loadCache(WiFiCache &cache);
+
+    /**
+     * @brief Stores the current association parameters in NVS.
+     * @param previous Cache loaded at boot (skips the flash write if unchanged).
+     * @note Writes only on change to preserve flash endurance.
+     */
+    void saveCache(const WiFiCache &previous);
+
+    /**
+     * @brief Erases the association cache (called when the fast path fails).
+     */
+    void clearCache();
+
+    /**
+     * @brief Publishes the DNS-SD services (call after MDNS.begin()).
+     * @details '_http._tcp' (TXT path=/stream) and MDNS_ROVER_SERVICE '._udp'
+     * with TXT records for the protocol revision, HTTP port, stream path,
+     * control DSCP and video transports, so clients connect without an IP.
+     */
+    void advertiseServices();
+
 public:
     /**
      * @brief Constructor. Initializes default state to Client (STA).
@@ -33,9 +102,12 @@ public:
     /**
      * @brief Starts the network state machine.
      * @details
-     * 1. Attempts to connect to WIFI_SSID (10s timeout).
-     * 2. If it fails, raises AP_SSID (Emergency Network).
-     * 3. Starts mDNS for name resolution.
+     * 1. If a cached association exists, attempts a directed connect
+     *    (WIFI_FAST_CONNECT_TIMEOUT_MS). No scan, no DHCP.
+     * 2. Otherwise (or on failure) attempts a full connect to WIFI_SSID
+     *    (WIFI_CONNECT_TIMEOUT_MS).
+     * 3. If it fails, raises AP_SSID (Emergency Network).
+     * 4. Starts mDNS for name resolution and service discovery.
      * @note This function is blocking during the connection attempt.
      */
     void begin();
@@ -49,13 +121,34 @@ public:
 
     /**
      * @brief Returns the assigned IP.
-     * @return String formatted "XXX.XXX.XXX.XXX". Depends on mode (STA vs AP).
+     * @return Text formatted "XXX.XXX.XXX.XXX". Depends on mode (STA vs AP).
+     * @note Points to an internal buffer, re-formatted only when the address changes.
      */
-    String getIP();
+    const char *getIP();
 
     /**
      * @brief Returns a readable description of the current mode.
-     * @return "STA (Home WiFi)" or "AP (Hotspot)".
+     * @return "STA (Home WiFi)" or "AP (Hotspot)" (string literal).
+     */
+    const char *getMode();
+
+    /**
+     * @brief Signal strength of the pilot's link.
+     * @details STA: RSSI of the associated access point. AP: strongest
+     * connected station (the pilot's phone/laptop in practice).
+     * @return dBm (negative), or 0 if there is no link to measure.
+     */
+    int getRssi();
+
+    /**
+     * @brief Reports whether the Fast-Reconnect path was used at boot.
+     * @return true if the cached BSSID/Channel connection succeeded.
+     */
+    bool usedFastPath();
+
+    /**
+     * @brief Time spent in the STA association phase during begin().
+     * @return Milliseconds (includes the failed fast attempt, if any).
      */
-    String getMode();
+    unsigned long getConnectTimeMs();
 };
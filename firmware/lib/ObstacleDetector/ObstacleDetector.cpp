@@ -0,0 +1,339 @@
+/**
+ * @file ObstacleDetector.cpp
+ * @brief Frame Tap, 1/8 JPEG Decode, Scoring and '/vision' Endpoint.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "ObstacleDetector.h"
+
+#if ROVER_VISION
+
+#include <atomic>
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp32/rom/tjpgd.h"
+#include "VisionKernels.h"
+#include "EventLog.h"
+
+// =============================================================================
+// STATE (Written by the vision task unless noted)
+// =============================================================================
+
+/** @brief TJpgDec work pool (same size esp_jpg_decode() allocates per call). */
+static const size_t TJPGD_POOL_SIZE = 3100;
+static uint8_t _pool[TJPGD_POOL_SIZE];
+
+static ThrottleLimitSink _sink = NULL;
+static TaskHandle_t _task = NULL;
+static volatile bool _enabled = true; ///< Written by setEnabled(), applied by the vision task
+
+// Frame hand-off: '_busy' is the owner token of '_jpeg' (tap -> task -> tap)
+static std::atomic<bool> _busy(false);
+static uint8_t *_jpeg = NULL;             ///< JPEG copy (PSRAM, VISION_JPEG_MAX)
+static size_t _jpegLen = 0;               ///< Valid bytes in _jpeg
+static int64_t _lastOfferUs = 0;          ///< Time of the last accepted frame (tap owner)
+static volatile uint32_t _lastSeenMs = 0; ///< Last frame seen by any tap (video is running)
+static uint32_t _copyUs = 0;              ///< Last memcpy duration in the video task (tap owner)
+
+// Luma frames (internal RAM: the kernels read every byte)
+static uint8_t *_luma[2] = {NULL, NULL};
+static int _cur = 0;                  ///< Index of the frame being decoded
+static uint16_t _maxW = 0, _maxH = 0; ///< Buffer geometry (CAMERA_MAX_FRAMESIZE / 8)
+static uint16_t _w = 0, _h = 0;       ///< Geometry of the last decode
+static bool _havePrev = false;        ///< _luma[1 - _cur] holds a comparable frame
+
+// Results (read by the HTTP handler: single words, torn reads are harmless)
+static uint16_t _edgeQ8 = 0;
+static uint16_t _motionQ8 = 0;
+static uint8_t _level = ObstacleDetector::CLEAR;
+static uint8_t _clearRun = 0;
+static uint32_t _frames = 0;       ///< Decoded frames
+static uint32_t _selfCaptured = 0; ///< Frames captured by the task (nobody streaming)
+static uint32_t _skipped = 0;      ///< Decode errors or oversized frames
+static uint32_t _decodeUs = 0;
+static uint32_t _kernelUs = 0;
+
+/** @brief Input cursor for the TJpgDec callbacks. */
+struct JpegSource
+{
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+};
+
+// =============================================================================
+// TJPGDEC CALLBACKS
+// =============================================================================
+
+/**
+ * @brief Input: copies (or skips, buf == NULL) the next bytes of the JPEG.
+ */
+static UINT jpegRead(JDEC *jd, BYTE *buf, UINT len)
+{
+    JpegSource *src = (JpegSource *)jd->device;
+    size_t left = src->len - src->pos;
+    if (len > left)
+        len = left;
+    if (buf)
+        memcpy(buf, src->data + src->pos, len);
+    src->pos += len;
+    return len;
+}
+
+/**
+ * @brief Output: one RGB888 rectangle (at 1/8 scale one pixel per 8x8 block) -> luma.
+ */
+static UINT jpegWrite(JDEC *jd, void *bitmap, JRECT *rect)
+{
+    const uint8_t *rgb = (const uint8_t *)bitmap;
+    uint8_t *dst = _luma[_cur];
+    for (int y = rect->top; y <= rect->bottom; y++)
+    {
+        for (int x = rect->left; x <= rect->right; x++)
+        {
+            if (x < _w && y < _h)
+                dst[y * _w + x] = VisionKernels::luma(rgb[0], rgb[1], rgb[2]);
+            rgb += 3;
+        }
+    }
+    return 1; // Continue
+}
+
+// =============================================================================
+// PIPELINE
+// =============================================================================
+
+bool ObstacleDetector::begin(ThrottleLimitSink sink)
+{
+    // 1. BUFFERS (boot time: zero-heap-after-boot)
+    const resolution_info_t &max = resolution[psramFound() ? CAMERA_MAX_FRAMESIZE : FRAMESIZE_QVGA];
+    _maxW = (max.width + 7) / 8;
+    _maxH = (max.height + 7) / 8;
+    _jpeg = (uint8_t *)heap_caps_malloc(VISION_JPEG_MAX, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    _luma[0] = (uint8_t *)heap_caps_malloc((size_t)_maxW * _maxH, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    _luma[1] = (uint8_t *)heap_caps_malloc((size_t)_maxW * _maxH, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!_jpeg || !_luma[0] || !_luma[1])
+    {
+        Serial.println("[ERROR] Vision: buffer allocation failed. Stage disabled.");
+        return false;
+    }
+
+    // 2. TASK
+    _sink = sink;
+    xTaskCreatePinnedToCore(visionTask, "vision", TASK_VISION.stack, NULL,
+                            TASK_VISION.priority, &_task, TASK_VISION.core);
+    Serial.printf("[VISION] Obstacle detector: %ux%u luma @ %d ms\n", _maxW, _maxH, VISION_PERIOD_MS);
+    return true;
+}
+
+void ObstacleDetector::offer(const camera_fb_t *fb)
+{
+    // 1. CHEAP REJECT (runs for every frame in the video tasks)
+    if (_task == NULL || !_enabled)
+        return;
+    int64_t now = esp_timer_get_time();
+    _lastSeenMs = (uint32_t)(now / 1000);
+    if (_busy.load(std::memory_order_relaxed))
+        return;
+    if (now - _lastOfferUs < (int64_t)VISION_PERIOD_MS * 1000)
+        return;
+    if (fb->format != PIXFORMAT_JPEG || fb->len > VISION_JPEG_MAX)
+        return;
+
+    // 2. CLAIM (two video tasks may offer at once)
+    if (_busy.exchange(true))
+        return;
+
+    memcpy(_jpeg, fb->buf, fb->len);
+    _jpegLen = fb->len;
+    _lastOfferUs = now;
+    _copyUs = (uint32_t)(esp_timer_get_time() - now);
+    xTaskNotifyGive(_task);
+}
+
+bool ObstacleDetector::decode()
+{
+    JDEC jd;
+    JpegSource src = {_jpeg, _jpegLen, 0};
+
+    if (jd_prepare(&jd, jpegRead, _pool, sizeof(_pool), &src) != JDR_OK)
+        return false;
+
+    // Scale 3 = 1/8. Output rows use the scaled width as stride.
+    uint16_t w = (jd.width + 7) / 8;
+    uint16_t h = (jd.height + 7) / 8;
+    if (w > _maxW || h > _maxH)
+        return false;
+
+    // Geometry change (profile switch): the previous frame is not comparable
+    if (w != _w || h != _h)
+        _havePrev = false;
+    _w = w;
+    _h = h;
+
+    return jd_decomp(&jd, jpegWrite, 3) == JDR_OK;
+}
+
+void ObstacleDetector::evaluate()
+{
+    // 1. SCORES (lower region only: the floor ahead of the bumper)
+    int64_t t0 = esp_timer_get_time();
+    const uint8_t *cur = _luma[_cur];
+    int y0 = (_h * VISION_ROI_START_PCT) / 100;
+    if (_h - y0 < 2 || _w < 2)
+        return; // Region too small to score (needs one row/column of gradient)
+
+    uint32_t edges = VisionKernels::edgeCount(cur, _w, _h, y0, _h, VISION_EDGE_THRESHOLD);
+    uint32_t edgeTotal = (uint32_t)(_h - 1 - y0) * (_w - 1);
+    _edgeQ8 = VisionKernels::ratioQ8(edges, edgeTotal);
+
+    if (_havePrev)
+    {
+        uint32_t moved = VisionKernels::diffCount(cur, _luma[1 - _cur], _w, y0, _h, VISION_DIFF_THRESHOLD);
+        _motionQ8 = VisionKernels::ratioQ8(moved, (uint32_t)(_h - y0) * _w);
+    }
+    else
+    {
+        _motionQ8 = 0;
+    }
+    _kernelUs = (uint32_t)(esp_timer_get_time() - t0);
+
+    // 2. DECISION (escalate at once, release after VISION_CLEAR_FRAMES)
+    uint8_t level = CLEAR;
+    if (_edgeQ8 >= VISION_EDGE_STOP_Q8 && _motionQ8 >= VISION_MOTION_LOOM_Q8)
+        level = STOP;
+    else if (_edgeQ8 >= VISION_EDGE_SLOW_Q8)
+        level = SLOW;
+
+    if (level >= _level)
+    {
+        _clearRun = 0;
+    }
+    else if (++_clearRun < VISION_CLEAR_FRAMES)
+    {
+        level = _level; // Hold
+    }
+
+    if (level != _level)
+    {
+        _level = level;
+        _clearRun = 0;
+        uint8_t limit = (level == STOP) ? 0 : (level == SLOW) ? VISION_SLOW_PWM : 255;
+        EventLog::log(LOG_VISION_LIMIT, limit, _edgeQ8, _motionQ8);
+        if (_sink)
+            _sink(limit);
+    }
+
+    // 3. SWAP (this frame becomes the reference)
+    _cur = 1 - _cur;
+    _havePrev = true;
+}
+
+void ObstacleDetector::setEnabled(bool enabled)
+{
+    // Only the flag changes here (httpd/params task): the level and the sink
+    // belong to the vision task, which releases the limit on its next pass
+    _enabled = enabled;
+    if (!enabled && _task != NULL)
+        xTaskNotifyGive(_task);
+}
+
+void ObstacleDetector::visionTask(void *arg)
+{
+    while (true)
+    {
+        // 1. WAIT FOR A TAPPED FRAME (video running)
+        bool offered = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(VISION_PERIOD_MS * 2)) > 0;
+        if (!_enabled)
+        {
+            // Disabled: release the limit here, never racing evaluate()
+            if (_level != CLEAR)
+            {
+                _level = CLEAR;
+                _clearRun = 0;
+                if (_sink)
+                    _sink(255);
+            }
+            _havePrev = false;
+            _busy.store(false);
+            continue;
+        }
+
+        // 2. NOBODY STREAMING: capture our own frame (no consumer to slow down).
+        // A slow profile (night) can exceed the wait: only capture when no tap
+        // has seen a frame for a while, or we would steal frames from the stream.
+        if (!offered)
+        {
+            if ((uint32_t)(esp_timer_get_time() / 1000) - _lastSeenMs < VISION_IDLE_CAPTURE_MS)
+                continue;
+            if (_busy.exchange(true))
+                continue; // A tap won the race: its notification is pending
+            camera_fb_t *fb = esp_camera_fb_get();
+            if (!fb)
+            {
+                _busy.store(false);
+                continue;
+            }
+            bool fits = fb->len <= VISION_JPEG_MAX;
+            if (fits)
+            {
+                memcpy(_jpeg, fb->buf, fb->len);
+                _jpegLen = fb->len;
+            }
+            esp_camera_fb_return(fb);
+            if (!fits)
+            {
+                _skipped++;
+                _busy.store(false);
+                continue;
+            }
+            _selfCaptured++;
+        }
+
+        // 3. DECODE + SCORE
+        int64_t t0 = esp_timer_get_time();
+        bool ok = decode();
+        _decodeUs = (uint32_t)(esp_timer_get_time() - t0);
+        _busy.store(false); // The JPEG copy is free for the next offer
+
+        if (ok)
+        {
+            _frames++;
+            evaluate();
+        }
+        else
+        {
+            _skipped++;
+        }
+    }
+}
+
+esp_err_t ObstacleDetector::httpHandler(httpd_req_t *req)
+{
+    char query[32];
+    char value[4];
+    char line[320];
+
+    // 1. OPTIONAL SWITCH ('?enable=0|1')
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "enable", value, sizeof(value)) == ESP_OK)
+    {
+        setEnabled(value[0] == '1');
+    }
+
+    // 2. REPORT
+    static const char *LEVELS[] = {"clear", "slow", "stop"};
+    int len = snprintf(line, sizeof(line),
+                       "{\"enabled\":%s,\"level\":\"%s\",\"edges_q8\":%u,\"motion_q8\":%u,"
+                       "\"width\":%u,\"height\":%u,\"roi_start_pct\":%d,"
+                       "\"frames\":%u,\"self_captured\":%u,\"skipped\":%u,"
+                       "\"decode_us\":%u,\"kernel_us\":%u,\"tap_copy_us\":%u}",
+                       _enabled ? "true" : "false", LEVELS[_level], _edgeQ8, _motionQ8,
+                       _w, _h, VISION_ROI_START_PCT,
+                       _frames, _selfCaptured, _skipped,
+                       _decodeUs, _kernelUs, _copyUs);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, line, len);
+}
+
+#endif // ROVER_VISION
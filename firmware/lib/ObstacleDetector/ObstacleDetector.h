@@ -0,0 +1,98 @@
+/**
+ * @file ObstacleDetector.h
+ * @brief Low-Resolution Vision Stage: Looming Obstacle -> Throttle Limit.
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * The failsafe only knows about lost packets; the rover otherwise drives at
+ * whatever speed the pilot commands. This stage watches the lower part of the
+ * image and caps forward throttle when something fills it and is closing in.
+ *
+ * Pipeline (own task, TASK_VISION, every VISION_PERIOD_MS):
+ * 1. FRAME: The video senders offer() each frame they already hold; when one
+ *    is due it is copied (memcpy, ~10 KB) into a PSRAM buffer. Nobody streams
+ *    -> the task captures its own frame. Video never waits for the decoder.
+ * 2. DECODE: ROM TJpgDec at 1/8 scale (one DC coefficient per 8x8 block):
+ *    QVGA -> 40x30 luma. Static work pool: no heap.
+ * 3. SCORE: VisionKernels (fixed point) on the lower VISION_ROI_START_PCT rows:
+ *    edge density and motion vs the previous decode.
+ * 4. DECIDE: CLEAR / SLOW (VISION_SLOW_PWM) / STOP (forward traction braked),
+ *    released after VISION_CLEAR_FRAMES clear decodes.
+ *
+ * The limit reaches RemoteControl through the sink given to begin().
+ *
+ * @note The sensor stays in JPEG mode: a raw grayscale QQVGA grab would need a
+ * driver re-init (pixel format is fixed at esp_camera_init()).
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "esp_camera.h"
+#include "esp_http_server.h"
+#include "config.h"
+
+/**
+ * @brief Receiver of throttle limit changes.
+ * @param maxPwm Max forward PWM (255 = no limit, 0 = stop).
+ */
+typedef void (*ThrottleLimitSink)(uint8_t maxPwm);
+
+class ObstacleDetector
+{
+public:
+    /** @brief Decision levels. */
+    enum Level : uint8_t
+    {
+        CLEAR = 0, ///< No limit
+        SLOW = 1,  ///< Obstacle near: throttle capped
+        STOP = 2   ///< Obstacle looming: forward traction braked
+    };
+
+    /**
+     * @brief Allocates the buffers and starts the 'vision' task.
+     * @details Call after the camera is initialized (buffers are sized for
+     * CAMERA_MAX_FRAMESIZE / 8). offer() is a no-op until this returns.
+     * @param sink Throttle limit consumer (called from the vision task).
+     * @return false if the buffers could not be allocated (stage disabled).
+     */
+    static bool begin(ThrottleLimitSink sink);
+
+    /**
+     * @brief Frame tap for the video senders (streamHandler, ws_video).
+     * @details Returns immediately unless a decode is due and the task is idle;
+     * then copies the JPEG. Never blocks. Safe from several tasks.
+     * @param fb Frame the caller currently owns.
+     */
+    static void offer(const camera_fb_t *fb);
+
+    /**
+     * @brief Enables/disables the stage at runtime (disable releases the limit).
+     * @details Any task: the vision task applies the change (and the release).
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief HTTP handler: GET '/vision' reports scores, level and timings.
+     * '/vision?enable=0|1' switches the stage first.
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t Operation status.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+
+private:
+    /**
+     * @brief Decodes the buffered JPEG at 1/8 scale into the current luma frame.
+     * @return true if the frame was decoded and fits the buffers.
+     */
+    static bool decode();
+
+    /**
+     * @brief Scores the decoded frame and updates the level/limit.
+     */
+    static void evaluate();
+
+    /**
+     * @brief Task body: waits for offered frames, captures when nobody streams.
+     */
+    static void visionTask(void *arg);
+};
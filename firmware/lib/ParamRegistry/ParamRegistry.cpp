@@ -0,0 +1,321 @@
+/**
+ * @file ParamRegistry.cpp
+ * @brief Parameter Table, NVS Persistence, '/params' Endpoint and UDP Access.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "ParamRegistry.h"
+#include "lwip/sockets.h"
+#include <errno.h>
+
+// NVS location of the stored values (one int32 entry per parameter key)
+static const char *NVS_NAMESPACE = "params";
+
+// NVS keys are limited to 15 characters
+static const size_t KEY_MAX_LEN = 15;
+
+/**
+ * @brief Parses a request value: "true"/"false" or a whole decimal integer.
+ * @return false for garbage ("abc", "12xyz", "") or a value beyond int32.
+ */
+static bool parseValue(const char *text, int32_t *out)
+{
+    if (strcmp(text, "true") == 0 || strcmp(text, "false") == 0)
+    {
+        *out = text[0] == 't';
+        return true;
+    }
+
+    char *end = NULL;
+    errno = 0;
+    long v = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || v < INT32_MIN || v > INT32_MAX)
+        return false;
+    *out = (int32_t)v;
+    return true;
+}
+
+ParamRegistry::Param ParamRegistry::_params[MAX_PARAMS];
+int ParamRegistry::_count = 0;
+Preferences ParamRegistry::_prefs;
+SemaphoreHandle_t ParamRegistry::_lock = NULL;
+
+void ParamRegistry::begin()
+{
+    _lock = xSemaphoreCreateMutex();
+    if (!_prefs.begin(NVS_NAMESPACE, false))
+    {
+        Serial.println("[ERROR] Params: NVS unavailable, defaults only (not persisted)");
+    }
+}
+
+int ParamRegistry::add(const char *key, ParamType type, int32_t min, int32_t max, int32_t def,
+                       ParamApply apply)
+{
+    if (_count >= MAX_PARAMS || strlen(key) > KEY_MAX_LEN || find(key) >= 0)
+    {
+        Serial.printf("[ERROR] Params: cannot register '%s'\n", key);
+        return -1;
+    }
+
+    Param &p = _params[_count];
+    p.key = key;
+    p.type = type;
+    p.min = min;
+    p.max = max;
+    p.def = def;
+    p.apply = apply;
+
+    // 1. STORED VALUE (ignored if it no longer fits the range: firmware changed)
+    int32_t value = stored(key, min, max, def);
+
+    // 2. BOOT APPLY: the owner starts from the stored value, not the constant
+    if (apply && !apply(value))
+    {
+        Serial.printf("[ERROR] Params: '%s' rejected stored value %ld, using default\n", key, (long)value);
+        value = def;
+        apply(value);
+    }
+    p.value.store(value);
+
+    if (value != def)
+        Serial.printf("[PARAM] %s = %ld (stored, default %ld)\n", key, (long)value, (long)def);
+
+    return _count++;
+}
+
+int32_t ParamRegistry::stored(const char *key, int32_t min, int32_t max, int32_t def)
+{
+    if (!_prefs.isKey(key))
+        return def;
+    int32_t value = _prefs.getInt(key, def);
+    return (value >= min && value <= max) ? value : def;
+}
+
+int32_t ParamRegistry::get(int id)
+{
+    if (id < 0 || id >= _count)
+        return 0;
+    return _params[id].value.load(std::memory_order_relaxed);
+}
+
+int ParamRegistry::find(const char *key)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        if (strcmp(_params[i].key, key) == 0)
+            return i;
+    }
+    return -1;
+}
+
+bool ParamRegistry::store(int idx, int32_t value, bool persist)
+{
+    Param &p = _params[idx];
+
+    // 1. VALIDATION
+    if (value < p.min || value > p.max)
+        return false;
+
+    // 2. LIVE APPLY (owner may veto)
+    if (p.apply && !p.apply(value))
+        return false;
+    p.value.store(value);
+
+    // 3. PERSIST (only on change: flash endurance)
+    if (persist && (!_prefs.isKey(p.key) || _prefs.getInt(p.key, p.def) != value))
+        _prefs.putInt(p.key, value);
+
+    Serial.printf("[PARAM] %s = %ld\n", p.key, (long)value);
+    return true;
+}
+
+bool ParamRegistry::set(const char *key, int32_t value)
+{
+    int idx = find(key);
+    if (idx < 0)
+        return false;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool ok = store(idx, value, true);
+    xSemaphoreGive(_lock);
+    return ok;
+}
+
+bool ParamRegistry::reset(const char *key)
+{
+    int idx = find(key);
+    if (idx < 0)
+        return false;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool ok = store(idx, _params[idx].def, false);
+    if (ok && _prefs.isKey(key))
+        _prefs.remove(key);
+    xSemaphoreGive(_lock);
+    return ok;
+}
+
+int ParamRegistry::format(int idx, char *out, size_t size, bool json)
+{
+    const Param &p = _params[idx];
+    int32_t v = p.value.load(std::memory_order_relaxed);
+
+    if (!json)
+        return snprintf(out, size, "%s=%ld [%ld..%ld] def %ld\n", p.key, (long)v, (long)p.min,
+                        (long)p.max, (long)p.def);
+
+    if (p.type == PARAM_BOOL)
+        return snprintf(out, size, "{\"key\":\"%s\",\"type\":\"bool\",\"value\":%s,\"default\":%s}",
+                        p.key, v ? "true" : "false", p.def ? "true" : "false");
+
+    return snprintf(out, size, "{\"key\":\"%s\",\"type\":\"int\",\"value\":%ld,\"min\":%ld,\"max\":%ld,\"default\":%ld}",
+                    p.key, (long)v, (long)p.min, (long)p.max, (long)p.def);
+}
+
+esp_err_t ParamRegistry::httpHandler(httpd_req_t *req)
+{
+    char query[80];
+    char key[KEY_MAX_LEN + 1];
+    char arg[16];
+    char line[160];
+    int idx = -1;
+
+    httpd_resp_set_type(req, "application/json");
+
+    // 1. SINGLE PARAMETER ('?key=k' [&value=v | &reset=1])
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "key", key, sizeof(key)) == ESP_OK)
+    {
+        idx = find(key);
+        if (idx < 0)
+        {
+            httpd_resp_set_status(req, "404 Not Found");
+            return httpd_resp_send(req, "{\"error\":\"unknown key\"}", HTTPD_RESP_USE_STRLEN);
+        }
+
+        bool ok = true;
+        if (httpd_query_key_value(query, "value", arg, sizeof(arg)) == ESP_OK)
+        {
+            // "true"/"false" accepted for bools, plain integers otherwise
+            int32_t value;
+            ok = parseValue(arg, &value) && set(key, value);
+        }
+        else if (httpd_query_key_value(query, "reset", arg, sizeof(arg)) == ESP_OK)
+        {
+            ok = reset(key);
+        }
+
+        if (!ok)
+            httpd_resp_set_status(req, "400 Bad Request");
+        int len = format(idx, line, sizeof(line), true);
+        return httpd_resp_send(req, line, len);
+    }
+
+    // 2. LIST
+    httpd_resp_send_chunk(req, "{\"params\":[", HTTPD_RESP_USE_STRLEN);
+    for (int i = 0; i < _count; i++)
+    {
+        int len = 0;
+        if (i)
+            line[len++] = ',';
+        len += format(i, line + len, sizeof(line) - len, true);
+        httpd_resp_send_chunk(req, line, len);
+    }
+    httpd_resp_send_chunk(req, "]}", HTTPD_RESP_USE_STRLEN);
+    return httpd_resp_send_chunk(req, NULL, 0); // End of chunked response
+}
+
+void ParamRegistry::startUdp()
+{
+    xTaskCreatePinnedToCore(udpTask, "params", TASK_PARAMS.stack, NULL,
+                            TASK_PARAMS.priority, NULL, TASK_PARAMS.core);
+}
+
+void ParamRegistry::udpTask(void *arg)
+{
+    // 1. SOCKET (blocking: this task has nothing else to do)
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(PARAM_UDP_PORT);
+    if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        Serial.printf("[ERROR] Params: could not bind UDP port %d\n", PARAM_UDP_PORT);
+        if (sock >= 0)
+            close(sock);
+        vTaskDelete(NULL);
+        return;
+    }
+    Serial.printf("[UDP] Parameter access on port %d\n", PARAM_UDP_PORT);
+
+    static char request[64];
+    static char reply[1024]; // 'list' fits in one datagram for PARAM_MAX entries
+
+    while (true)
+    {
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        int n = recvfrom(sock, request, sizeof(request) - 1, 0, (struct sockaddr *)&from, &fromLen);
+        if (n <= 0)
+            continue;
+        request[n] = '\0';
+
+        // 2. PARSE: "<cmd> [key] [value]" (trailing newline tolerated)
+        char cmd[8] = "";
+        char key[KEY_MAX_LEN + 1] = "";
+        char arg[16] = "";
+        int32_t value = 0;
+        int fields = sscanf(request, "%7s %15s %15s", cmd, key, arg);
+
+        // 3. EXECUTE
+        int len = 0;
+        int idx = find(key);
+        if (strcmp(cmd, "list") == 0)
+        {
+            for (int i = 0; i < _count; i++)
+            {
+                // snprintf() reports the untruncated length: whole lines only
+                int n = format(i, reply + len, sizeof(reply) - len, false);
+                if (n < 0 || n >= (int)sizeof(reply) - len)
+                {
+                    reply[len] = '\0';
+                    break;
+                }
+                len += n;
+            }
+        }
+        else if (fields >= 2 && idx < 0)
+        {
+            len = snprintf(reply, sizeof(reply), "ERR unknown key %s\n", key);
+        }
+        else if (strcmp(cmd, "get") == 0 && fields >= 2)
+        {
+            len = format(idx, reply, sizeof(reply), false);
+        }
+        else if (strcmp(cmd, "set") == 0 && fields == 3 && !parseValue(arg, &value))
+        {
+            len = snprintf(reply, sizeof(reply), "ERR not a number: %s\n", arg);
+        }
+        else if (strcmp(cmd, "set") == 0 && fields == 3)
+        {
+            bool ok = set(key, value);
+            len = ok ? format(idx, reply, sizeof(reply), false)
+                     : snprintf(reply, sizeof(reply), "ERR rejected %s=%ld\n", key, (long)value);
+        }
+        else if (strcmp(cmd, "reset") == 0 && fields >= 2)
+        {
+            bool ok = reset(key);
+            len = ok ? format(idx, reply, sizeof(reply), false)
+                     : snprintf(reply, sizeof(reply), "ERR rejected default of %s\n", key);
+        }
+        else
+        {
+            len = snprintf(reply, sizeof(reply), "ERR usage: list | get <key> | set <key> <value> | reset <key>\n");
+        }
+
+        sendto(sock, reply, len, 0, (struct sockaddr *)&from, fromLen);
+    }
+}
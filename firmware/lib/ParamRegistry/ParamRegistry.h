@@ -0,0 +1,154 @@
+/**
+ * @file ParamRegistry.h
+ * @brief Persistent Runtime Parameters (NVS) with Range Check and Live Apply.
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * Tuning knobs (failsafe timeout, steering limits, motor PWM, camera overrides,
+ * stream pacing) used to be compile-time constants: every iteration was a
+ * reflash. Each knob is now a registered parameter:
+ * - Typed integer (int or bool) with [min, max] validation.
+ * - Default from config.h, stored value from NVS (namespace "params").
+ * - Apply callback: the owning subsystem takes the new value immediately and
+ *   may veto it (e.g. an impossible PWM frequency/resolution pair).
+ *
+ * Access:
+ * - HTTP: GET '/params' (list), '/params?key=k' (get), '/params?key=k&value=v'
+ *   (set), '/params?key=k&reset=1' (back to default).
+ * - UDP (PARAM_UDP_PORT, text, one request per datagram):
+ *   "list" | "get <key>" | "set <key> <value>" | "reset <key>".
+ *   Served by the low-priority 'params' task: NVS writes never run on the
+ *   control task.
+ *
+ * Values are written to NVS only when they change (flash endurance).
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <Preferences.h>
+#include "esp_http_server.h"
+#include "config.h"
+#include <atomic>
+
+/**
+ * @brief Value kinds (validation and JSON rendering).
+ */
+enum ParamType : uint8_t
+{
+    PARAM_INT = 0, ///< Signed integer in [min, max]
+    PARAM_BOOL = 1 ///< 0/1 (rendered as false/true)
+};
+
+/**
+ * @brief Applies a new value to the owning subsystem.
+ * @param value Already range-checked value.
+ * @return false to reject it (the previous value is kept).
+ * @note Runs in the caller's task (httpd or 'params'), and once at add().
+ */
+typedef bool (*ParamApply)(int32_t value);
+
+class ParamRegistry
+{
+public:
+    /** @brief Max registered parameters (fixed table, no heap). */
+    static const int MAX_PARAMS = PARAM_MAX;
+
+    /**
+     * @brief Opens the NVS namespace. Call before the first add().
+     */
+    static void begin();
+
+    /**
+     * @brief Registers a parameter and applies its stored (or default) value.
+     * @param key NVS key and public name (max 15 characters).
+     * @param type PARAM_INT or PARAM_BOOL.
+     * @param min Lowest accepted value.
+     * @param max Highest accepted value.
+     * @param def Default (used when nothing valid is stored).
+     * @param apply Owner callback (NULL = value only read through get()).
+     * @return Parameter id for get(), or -1 if the table is full / key invalid.
+     */
+    static int add(const char *key, ParamType type, int32_t min, int32_t max, int32_t def,
+                   ParamApply apply);
+
+    /**
+     * @brief Value add() will load for 'key': the stored one if it fits [min, max], else 'def'.
+     * @details Lets owners seed knobs validated as a group (all members loaded
+     * before the first add() applies one of them).
+     */
+    static int32_t stored(const char *key, int32_t min, int32_t max, int32_t def);
+
+    /**
+     * @brief Current value (lock-free, any task).
+     * @param id Value returned by add().
+     */
+    static int32_t get(int id);
+
+    /**
+     * @brief Validates, applies and persists a new value.
+     * @param key Parameter name.
+     * @param value New value.
+     * @return false if the key is unknown, out of range or vetoed by the owner.
+     */
+    static bool set(const char *key, int32_t value);
+
+    /**
+     * @brief Restores the default value and erases the stored one.
+     * @param key Parameter name.
+     * @return false if the key is unknown or the owner rejected the default.
+     */
+    static bool reset(const char *key);
+
+    /**
+     * @brief Starts the UDP access task ('params', TASK_PARAMS).
+     * @details Call after the network is up and all parameters are registered.
+     */
+    static void startUdp();
+
+    /**
+     * @brief HTTP handler: GET '/params' (see file header for the query keys).
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t Operation status.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+
+private:
+    /**
+     * @brief One registered parameter.
+     */
+    struct Param
+    {
+        const char *key;             ///< Name and NVS key
+        ParamType type;              ///< Value kind
+        int32_t min, max, def;       ///< Validation range and default
+        ParamApply apply;            ///< Owner callback (may be NULL)
+        std::atomic<int32_t> value;  ///< Current value (read lock-free)
+    };
+
+    /**
+     * @brief Index of 'key' in the table, -1 if unknown.
+     */
+    static int find(const char *key);
+
+    /**
+     * @brief Range check + owner apply + NVS write. Caller holds _lock.
+     * @param persist false = apply only (reset() erases the key instead).
+     */
+    static bool store(int idx, int32_t value, bool persist);
+
+    /**
+     * @brief Formats one parameter as JSON (or "key=value" for UDP).
+     * @return Characters written.
+     */
+    static int format(int idx, char *out, size_t size, bool json);
+
+    /**
+     * @brief Task body: serves the UDP text protocol.
+     */
+    static void udpTask(void *arg);
+
+    static Param _params[MAX_PARAMS];
+    static int _count;
+    static Preferences _prefs;
+    static SemaphoreHandle_t _lock; ///< Serializes writers (httpd vs 'params')
+};
@@ -0,0 +1,199 @@
+/**
+ * @file PowerGovernor.cpp
+ * @brief Temperature/Droop Sensing, Step Selection and CPU/TX/Video Actuation.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "PowerGovernor.h"
+#include "soc/rtc_cntl_reg.h"
+#include "esp_wifi.h"
+#include "CameraServer.h"
+#include "EventLog.h"
+#include "Metrics.h"
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+/** @brief Driver maximum (19.5 dBm): the reference of the uplink estimate. */
+static const int8_t TX_MAX_QDBM = POWER_STEPS[0].txMaxQdbm;
+
+std::atomic<bool> PowerGovernor::_enabled(true);
+std::atomic<int> PowerGovernor::_offsetC(0);
+int PowerGovernor::_tempX16 = 0;
+int PowerGovernor::_tempC = 0;
+int PowerGovernor::_thermal = 0;
+int PowerGovernor::_step = 0;
+uint32_t PowerGovernor::_droopUntil = 0;
+uint32_t PowerGovernor::_droops = 0;
+uint16_t PowerGovernor::_cpuMhz = 0;
+uint16_t PowerGovernor::_cpuCeiling = 0;
+int8_t PowerGovernor::_txQdbm = 0;
+
+#if CONFIG_PM_ENABLE
+esp_pm_lock_handle_t PowerGovernor::_busyLock = NULL;
+bool PowerGovernor::_locked = false;
+#endif
+
+void PowerGovernor::begin()
+{
+    // 1. DROOP DETECTOR: comparator on, reset and RF power-down off.
+    // The core's esp_brownout_init() left the brown-out interrupt enabled with
+    // an ISR that restarts the chip: mask it first, droopSeen() polls the raw
+    // flag instead. setup() cleared this register; the boot flag is discarded.
+    CLEAR_PERI_REG_MASK(RTC_CNTL_INT_ENA_REG, RTC_CNTL_BROWN_OUT_INT_ENA);
+    WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG,
+                   RTC_CNTL_BROWN_OUT_ENA | ((uint32_t)POWER_DROOP_THRESHOLD << RTC_CNTL_DBROWN_OUT_THRES_S));
+    WRITE_PERI_REG(RTC_CNTL_INT_CLR_REG, RTC_CNTL_BROWN_OUT_INT_CLR);
+
+    // 2. CURRENT STATE (first update() only logs what it changes)
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "power", &_busyLock);
+#endif
+    _cpuMhz = getCpuFrequencyMhz();
+    if (esp_wifi_get_max_tx_power(&_txQdbm) != ESP_OK)
+        _txQdbm = TX_MAX_QDBM;
+
+    Serial.printf("[POWER] Governor ready: %u MHz, TX %d/4 dBm, %d steps (%s)\n",
+                  _cpuMhz, _txQdbm, COUNT_OF(POWER_STEPS),
+#if CONFIG_PM_ENABLE
+                  "esp_pm lock"
+#else
+                  "direct clock"
+#endif
+    );
+}
+
+void PowerGovernor::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+}
+
+void PowerGovernor::setTempOffset(int offsetC)
+{
+    _offsetC = offsetC;
+}
+
+bool PowerGovernor::droopSeen()
+{
+    // Raw flag: latched by the comparator even with the interrupt disabled
+    if (!(READ_PERI_REG(RTC_CNTL_INT_RAW_REG) & RTC_CNTL_BROWN_OUT_INT_RAW))
+        return false;
+    WRITE_PERI_REG(RTC_CNTL_INT_CLR_REG, RTC_CNTL_BROWN_OUT_INT_CLR);
+    return true;
+}
+
+int PowerGovernor::thermalStep()
+{
+    int s = _thermal;
+    while (s + 1 < COUNT_OF(POWER_STEPS) && _tempC >= POWER_STEPS[s + 1].tempC)
+        s++;
+    while (s > 0 && _tempC < POWER_STEPS[s].tempC - POWER_TEMP_HYST_C)
+        s--;
+    return s;
+}
+
+int8_t PowerGovernor::txTarget(int rssiDbm, int8_t ceiling)
+{
+    if (rssiDbm == 0)
+        return ceiling; // Nobody associated yet: be heard
+
+    // Uplink at power P ~= rssi - (MAX - P) >= TARGET  ->  P >= MAX + (TARGET - rssi)
+    int want = TX_MAX_QDBM + (POWER_RSSI_TARGET - rssiDbm) * 4;
+
+    // Up immediately, down only with POWER_RSSI_HYST dB to spare
+    if (want < _txQdbm && want + POWER_RSSI_HYST * 4 > _txQdbm)
+        want = _txQdbm;
+
+    if (want < POWER_TX_MIN_QDBM)
+        want = POWER_TX_MIN_QDBM;
+    if (want > ceiling)
+        want = ceiling;
+    return (int8_t)want;
+}
+
+void PowerGovernor::applyCpu(uint16_t ceiling, bool busy)
+{
+    uint16_t mhz = busy ? ceiling : POWER_CPU_IDLE_MHZ;
+
+#if CONFIG_PM_ENABLE
+    // DFS between idle and ceiling; the lock pins the ceiling while busy
+    if (ceiling != _cpuCeiling)
+    {
+        esp_pm_config_esp32_t pm = {};
+        pm.max_freq_mhz = ceiling;
+        pm.min_freq_mhz = POWER_CPU_IDLE_MHZ;
+        pm.light_sleep_enable = false; // Would add wake-up latency to control
+        if (esp_pm_configure(&pm) == ESP_OK)
+            _cpuCeiling = ceiling;
+    }
+    if (busy != _locked && _busyLock)
+    {
+        if (busy)
+            esp_pm_lock_acquire(_busyLock);
+        else
+            esp_pm_lock_release(_busyLock);
+        _locked = busy;
+    }
+#else
+    // APB stays at 80 MHz for every clock >= 80: LEDC (motors, XCLK) and UART unaffected
+    if (mhz != _cpuMhz && !setCpuFrequencyMhz(mhz))
+        return;
+    _cpuCeiling = ceiling;
+#endif
+
+    if (mhz != _cpuMhz)
+    {
+        EventLog::log(LOG_POWER_CPU, mhz, ceiling, busy ? 1 : 0);
+        _cpuMhz = mhz;
+    }
+}
+
+void PowerGovernor::update(bool busy, int rssiDbm)
+{
+    // 1. SENSE (EMA 1/4: the raw sensor jumps by a few degrees per read)
+    int raw16 = (int)(temperatureRead() * 16);
+    if (_tempX16 == 0)
+        _tempX16 = raw16;
+    _tempX16 += (raw16 - _tempX16) / 4;
+    _tempC = (_tempX16 + 8) / 16 + _offsetC.load();
+
+    uint32_t now = millis();
+    if (droopSeen())
+    {
+        _droops++;
+        _droopUntil = now + POWER_DROOP_HOLD_MS;
+        Metrics::powerDroops.inc();
+    }
+    bool droop = _droops > 0 && (int32_t)(_droopUntil - now) > 0;
+
+    // 2. STEP (sensing continues while disabled, so re-enabling is immediate)
+    _thermal = thermalStep();
+    bool enabled = _enabled;
+    int step = _thermal;
+    if (droop && step < POWER_DROOP_STEP)
+        step = POWER_DROOP_STEP;
+    if (!enabled)
+        step = 0;
+    if (step != _step)
+    {
+        EventLog::log(LOG_POWER_STEP, step, (uint32_t)_tempC, _droops);
+        _step = step;
+    }
+    const PowerStep &p = POWER_STEPS[_step];
+
+    // 3. APPLY (disabled = fixed maximum performance)
+    applyCpu(p.cpuMhz, busy || !enabled);
+
+    int8_t tx = enabled ? txTarget(rssiDbm, p.txMaxQdbm) : TX_MAX_QDBM;
+    if (tx != _txQdbm && esp_wifi_set_max_tx_power(tx) == ESP_OK)
+    {
+        EventLog::log(LOG_POWER_TX, tx, (uint32_t)rssiDbm);
+        _txQdbm = tx;
+    }
+
+    CameraServer::setGovernorGapMs(p.frameGapMs);
+
+    Metrics::powerTempC.set(_tempC);
+    Metrics::powerStep.set(_step);
+    Metrics::powerCpuMhz.set(_cpuMhz);
+    Metrics::powerTxQdbm.set(_txQdbm);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file PowerGovernor.h
+ * @brief Thermal- and Supply-Aware Performance Governor (CPU, TX Power, Frame Rate).
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * The ESP32-CAM has no heatsink and usually a marginal supply. The old answers
+ * were fixed and permanent: 11 dBm TX power (commented out), a hand-picked
+ * frame gap, a low XCLK. This governor applies them only when they are needed,
+ * and only as far as needed.
+ *
+ * Each update() (control task, every POWER_UPDATE_MS):
+ * 1. SENSE: die temperature (smoothed, + 'power_temp_offset') and the
+ *    brown-out comparator flag (detect-only, no reset).
+ * 2. STEP: the POWER_STEPS entry for that temperature, with hysteresis. A
+ *    recent droop holds at least POWER_DROOP_STEP.
+ * 3. APPLY within the step's bounds:
+ *    - CPU: ceiling while busy (stream client or pilot), POWER_CPU_IDLE_MHZ
+ *      otherwise. With CONFIG_PM_ENABLE this is an esp_pm CPU_FREQ_MAX lock
+ *      held while busy (DFS does the switching); otherwise setCpuFrequencyMhz().
+ *    - TX power: lowest level keeping the estimated uplink at POWER_RSSI_TARGET.
+ *    - Video: extra pause between frames (CameraServer::setGovernorGapMs).
+ *
+ * Every change is logged (EventLog: LOG_POWER_*) and the state is exported in
+ * '/metrics' (rover_power_*).
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include <atomic>
+
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+class PowerGovernor
+{
+public:
+    /**
+     * @brief Arms the brown-out comparator in detect-only mode (no reset).
+     * @note Call after WiFi is started (TX power is a driver setting).
+     */
+    static void begin();
+
+    /**
+     * @brief One governor period (control task).
+     * @param busy true while a stream client or a pilot is connected.
+     * @param rssiDbm Pilot RSSI (NetworkManager::getRssi(), 0 = unknown).
+     */
+    static void update(bool busy, int rssiDbm);
+
+    /**
+     * @brief Enables/disables the governor (runtime parameter 'power_governor').
+     * @details Disabled = fixed maximum performance (240 MHz, 19.5 dBm, no gap)
+     * from the next update().
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Sensor calibration (runtime parameter 'power_temp_offset').
+     * @param offsetC Degrees added to every raw reading.
+     */
+    static void setTempOffset(int offsetC);
+
+    /** @brief Smoothed, calibrated die temperature (degC). */
+    static int temperature() { return _tempC; }
+
+    /** @brief Current POWER_STEPS index. */
+    static int step() { return _step; }
+
+    /** @brief Current CPU clock (MHz). */
+    static int cpuMhz() { return _cpuMhz; }
+
+    /** @brief Current TX power ceiling (0.25 dBm). */
+    static int txQdbm() { return _txQdbm; }
+
+private:
+    /**
+     * @brief true if the brown-out comparator fired since the last call (clears the flag).
+     */
+    static bool droopSeen();
+
+    /**
+     * @brief Thermal step for the current temperature (hysteresis on the way down).
+     */
+    static int thermalStep();
+
+    /**
+     * @brief Lowest TX power (0.25 dBm) meeting POWER_RSSI_TARGET, within [min, ceiling].
+     */
+    static int8_t txTarget(int rssiDbm, int8_t ceiling);
+
+    /**
+     * @brief Sets the CPU clock for this state (only on change).
+     */
+    static void applyCpu(uint16_t ceiling, bool busy);
+
+    static std::atomic<bool> _enabled;
+    static std::atomic<int> _offsetC;
+    static int _tempX16;          ///< Smoothed raw temperature (degC x16, EMA 1/4)
+    static int _tempC;            ///< Calibrated, rounded
+    static int _thermal;          ///< Step from temperature alone (hysteresis state)
+    static int _step;             ///< Applied step (droop floor / disabled included)
+    static uint32_t _droopUntil;  ///< millis() until the droop hold ends
+    static uint32_t _droops;      ///< Droop events since boot
+    static uint16_t _cpuMhz;      ///< Clock currently applied
+    static uint16_t _cpuCeiling;  ///< Ceiling currently configured (PM path)
+    static int8_t _txQdbm;        ///< TX power currently applied
+
+#if CONFIG_PM_ENABLE
+    static esp_pm_lock_handle_t _busyLock; ///< CPU_FREQ_MAX while busy
+    static bool _locked;
+#endif
+};
@@ -6,9 +6,15 @@
  * Implements a 2-byte binary protocol for traction and steering control.
  * Includes safety mechanisms (Failsafe) and CPU optimization (State Cache)
  * to avoid redundant writes to PWM drivers.
+ * The Link Governor adapts the failsafe timeout and caps throttle from the
+ * measured command interval and RSSI.
  */
 
 #include "RemoteControl.h"
+#include "esp_timer.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "EventLog.h"
 
 RemoteControl::RemoteControl(SolidAxle *motors, SteeringServo *steering)
 {
@@ -16,100 +22,381 @@ RemoteControl::RemoteControl(SolidAxle *motors, SteeringServo *steering)
     _motors = motors;
     _steering = steering;
 
+    _sock = -1;
     _lastPacketTime = 0;
+    _mailboxFull = false;
+    _mailboxLock = portMUX_INITIALIZER_UNLOCKED;
     _failsafeActive = false;
+    _failsafeMs.store(UDP_FAILSAFE_MS);
 
     // Initialize cache with out-of-range values (255) to
     // force physical hardware update on the first received packet.
     _prevSpeed = 255;
     _prevAngle = 255;
+
+    _requestedSpeed = 0;
+    _throttleLimit.store(255);
+    _limitChanged.store(false);
+
+    _intervalMean8 = 0;
+    _intervalDev4 = 0;
+    _intervalSamples = 0;
+    _rssi = 0;
+    _linkLimit = 255;
+    _linkGovernor.store(true);
 }
 
 void RemoteControl::begin()
 {
-    _udp.begin(UDP_PORT); // Port defined in config.h
-    Serial.printf("[UDP] Listening for binary protocol on port %d\n", UDP_PORT);
+    // Raw lwIP socket instead of WiFiUDP: we need setsockopt() for QoS.
+    _sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (_sock < 0)
+    {
+        Serial.println("[ERROR] UDP: Could not create socket");
+        return;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(UDP_PORT); // Port defined in config.h
+
+    if (bind(_sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        Serial.printf("[ERROR] UDP: Could not bind port %d\n", UDP_PORT);
+        close(_sock);
+        _sock = -1;
+        return;
+    }
+
+    // Non-blocking: listen() is polled from loop()
+    fcntl(_sock, F_SETFL, fcntl(_sock, F_GETFL, 0) | O_NONBLOCK);
+
+    // QoS: Replies (probe echoes/telemetry) travel in the WMM Voice queue
+    int tos = DSCP_CONTROL << 2;
+    setsockopt(_sock, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+
+    Serial.printf("[UDP] Listening for binary protocol on port %d (DSCP %u)\n", UDP_PORT, DSCP_CONTROL);
 }
 
 void RemoteControl::listen()
 {
-    int packetSize = _udp.parsePacket();
+    TRACE_SCOPE(TRACE_UDP_LISTEN);
 
-    // Basic Filter: Process only if packet matches protocol size (2 bytes)
-    // Byte 0: Traction | Byte 1: Steering
-    if (packetSize >= 2)
+    // 1. MAILBOX: Command parked by another transport (WebSocket)
+    uint8_t cmd[ControlProtocol::COMMAND_SIZE];
+    bool pending = false;
+
+    portENTER_CRITICAL(&_mailboxLock);
+    if (_mailboxFull)
     {
-        _udp.read(_packetBuffer, 2); // Read only relevant 2 bytes
+        cmd[0] = _mailbox[0];
+        cmd[1] = _mailbox[1];
+        _mailboxFull = false;
+        pending = true;
+    }
+    portEXIT_CRITICAL(&_mailboxLock);
 
-        // DEBUG: Show received data
-        // Serial.printf("[UDP] Motor: %d | Servo: %d\n", _packetBuffer[0], _packetBuffer[1]);
+    if (pending)
+    {
+        apply(cmd[0], cmd[1]);
+    }
 
-        // 1. WATCHDOG RESET
-        // Received heartbeat/signal from controller, reset timer.
-        _lastPacketTime = millis();
+    // 2. THROTTLE LIMIT: Re-apply the pilot's last command under the new cap
+    // (the watchdog is not fed: only real packets keep the link alive)
+    if (_limitChanged.exchange(false) && !_failsafeActive)
+    {
+        writeTraction(_requestedSpeed);
+    }
 
-        // 2. RECOVERY MANAGEMENT (EXIT FAILSAFE)
-        // If rover was in emergency mode and receives signal, reactivate control.
-        if (_failsafeActive)
+    // 3. UDP SOCKET
+    if (_sock < 0)
+    {
+        return;
+    }
+
+    struct sockaddr_in from;
+
+    // Drain the RX queue: with the socket buffer, several packets may have
+    // arrived since the last loop(). Each one is applied in order.
+    while (true)
+    {
+        socklen_t fromLen = sizeof(from);
+        int packetSize = recvfrom(_sock, _packetBuffer, sizeof(_packetBuffer), 0,
+                                  (struct sockaddr *)&from, &fromLen);
+
+        // EAGAIN: queue empty
+        if (packetSize < 0)
         {
-            _failsafeActive = false;
-            // Invalidate cache (_prev) to force immediate hardware update
-            // even if new values match old ones.
-            _prevSpeed = 255;
-            _prevAngle = 255;
-            Serial.println("[UDP] Signal recovered. Control reactivated.");
+            break;
         }
 
-        // --- BYTE 0: TRACTION (Throttle) ---
-        uint8_t speedCode = _packetBuffer[0];
+        int64_t rxUs = esp_timer_get_time();
+        Metrics::udpReceived.inc();
 
-        // CACHE OPTIMIZATION: Write to motor only if value changed.
-        // Saves CPU cycles and unnecessary PWM bus calls.
-        if (speedCode != _prevSpeed)
+        // Basic Filter: Process only if packet carries a full command
+        // Byte 0: Traction | Byte 1: Steering
+        ControlProtocol::PacketView packet(_packetBuffer, (size_t)packetSize);
+        if (!packet.valid())
         {
-            _prevSpeed = speedCode; // Update cache
-
-            if (speedCode == 0)
-            {
-                _motors->coast(); // 0 = Inertia (Release throttle)
-            }
-            else if (speedCode == 1)
-            {
-                _motors->brake(); // 1 = Active Brake
-            }
-            else
-            {
-                // Values 2-255 map directly to PWM.
-                // SolidAxle internally manages pin direction.
-                _motors->drive((int)speedCode);
-            }
+            Metrics::udpRejected.inc();
+            continue;
         }
 
-        // --- BYTE 1: STEERING ---
-        uint8_t angle = _packetBuffer[1];
+        apply(packet.traction(), packet.steering());
+        Metrics::controlApplyUs.observe((uint32_t)(esp_timer_get_time() - rxUs));
 
-        // CACHE OPTIMIZATION: Write to servo only if angle changed.
-        if (angle != _prevAngle)
+        // LATENCY PROBE: Echo the token once the actuators have been updated
+        if (packet.probeSize() > 0)
         {
-            _prevAngle = angle; // Update cache
+            sendto(_sock, packet.probe(), packet.probeSize(), 0,
+                   (struct sockaddr *)&from, fromLen);
+        }
+    }
+}
+
+void RemoteControl::submit(const uint8_t *frame, size_t len)
+{
+    ControlProtocol::PacketView packet(frame, len);
+    if (!packet.valid())
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&_mailboxLock);
+    _mailbox[0] = packet.traction();
+    _mailbox[1] = packet.steering();
+    _mailboxFull = true;
+    portEXIT_CRITICAL(&_mailboxLock);
+}
 
-            // Pass raw angle. SteeringServo class internally handles
-            // 'constrain' and physical limits.
-            _steering->write((int)angle);
+void RemoteControl::apply(uint8_t speedCode, uint8_t angle)
+{
+    // DEBUG: Show received data
+    // Serial.printf("[UDP] Motor: %d | Servo: %d\n", speedCode, angle);
+
+    // 1. WATCHDOG RESET
+    // Received heartbeat/signal from controller, reset timer.
+    // The gap since the previous command feeds the link statistics (not the
+    // first command, nor the outage that ends a failsafe).
+    unsigned long now = millis();
+    if (!_failsafeActive && _lastPacketTime != 0)
+    {
+        observeInterval(now - _lastPacketTime);
+    }
+    _lastPacketTime = now;
+
+    // 2. RECOVERY MANAGEMENT (EXIT FAILSAFE)
+    // If rover was in emergency mode and receives signal, reactivate control.
+    if (_failsafeActive)
+    {
+        _failsafeActive = false;
+        // Invalidate cache (_prev) to force immediate hardware update
+        // even if new values match old ones.
+        _prevSpeed = 255;
+        _prevAngle = 255;
+        // Relearn the interval: the pilot may now send at a slower rate, which
+        // the old (shorter) timeout would keep tripping on.
+        _intervalSamples = 0;
+        EventLog::log(LOG_SIGNAL_RECOVERED);
+    }
+
+    // 3. LINK CAP: A fresh command lifts the lateness penalty right away
+    evaluateLink();
+
+    // --- BYTE 0: TRACTION (Throttle) ---
+    _requestedSpeed = speedCode;
+    writeTraction(speedCode);
+
+    // --- BYTE 1: STEERING ---
+    // CACHE OPTIMIZATION: Write to servo only if angle changed.
+    if (angle != _prevAngle)
+    {
+        _prevAngle = angle; // Update cache
+
+        // Pass raw angle. SteeringServo class internally handles
+        // 'constrain' and physical limits.
+        _steering->write((int)angle);
+    }
+}
+
+void RemoteControl::writeTraction(uint8_t speedCode)
+{
+    // OBSTACLE / LINK LIMIT: Cap forward codes only (Coast/Brake are always allowed)
+    uint8_t limit = _throttleLimit.load(std::memory_order_relaxed);
+    if (_linkLimit < limit)
+    {
+        limit = _linkLimit;
+    }
+    if (speedCode >= 2 && speedCode > limit)
+    {
+        speedCode = (limit < 2) ? 1 : limit; // Below the PWM range: brake
+    }
+
+    // CACHE OPTIMIZATION: Write to motor only if value changed.
+    // Saves CPU cycles and unnecessary PWM bus calls.
+    if (speedCode != _prevSpeed)
+    {
+        _prevSpeed = speedCode; // Update cache
+
+        if (speedCode == 0)
+        {
+            _motors->coast(); // 0 = Inertia (Release throttle)
+        }
+        else if (speedCode == 1)
+        {
+            _motors->brake(); // 1 = Active Brake
+        }
+        else
+        {
+            // Values 2-255 map directly to PWM.
+            // SolidAxle internally manages pin direction.
+            _motors->drive((int)speedCode);
         }
     }
 }
 
+void RemoteControl::setThrottleLimit(uint8_t maxPwm)
+{
+    if (_throttleLimit.exchange(maxPwm) != maxPwm)
+    {
+        _limitChanged.store(true);
+    }
+}
+
+void RemoteControl::setFailsafeMs(uint32_t ms)
+{
+    _failsafeMs.store(ms, std::memory_order_relaxed);
+}
+
+void RemoteControl::setLinkGovernor(bool enabled)
+{
+    _linkGovernor.store(enabled, std::memory_order_relaxed);
+}
+
+void RemoteControl::observeInterval(uint32_t ms)
+{
+    // First sample seeds the estimators (mean = sample, deviation = sample / 2)
+    if (_intervalSamples == 0)
+    {
+        _intervalMean8 = ms << 3;
+        _intervalDev4 = ms << 1;
+    }
+    else
+    {
+        // mean += (sample - mean) / 8 ; dev += (|sample - mean| - dev) / 4
+        int32_t err = (int32_t)ms - (int32_t)(_intervalMean8 >> 3);
+        _intervalMean8 += err;
+        if (err < 0)
+        {
+            err = -err;
+        }
+        _intervalDev4 += err - (int32_t)(_intervalDev4 >> 2);
+    }
+
+    if (_intervalSamples < LINK_MIN_SAMPLES)
+    {
+        _intervalSamples++;
+    }
+}
+
+uint32_t RemoteControl::linkTimeout()
+{
+    uint32_t ceiling = _failsafeMs.load(std::memory_order_relaxed);
+    if (!_linkGovernor.load(std::memory_order_relaxed) || _intervalSamples < LINK_MIN_SAMPLES)
+    {
+        return ceiling;
+    }
+
+    // _intervalDev4 is already 4 x deviation
+    uint32_t timeout = LINK_MISS_TOLERANCE * (_intervalMean8 >> 3) + _intervalDev4;
+    if (timeout < LINK_FAILSAFE_MIN_MS)
+    {
+        timeout = LINK_FAILSAFE_MIN_MS;
+    }
+    return (timeout < ceiling) ? timeout : ceiling;
+}
+
+bool RemoteControl::evaluateLink()
+{
+    uint8_t limit = 255;
+
+    if (_linkGovernor.load(std::memory_order_relaxed))
+    {
+        // 1. SIGNAL QUALITY (Q8: 256 = perfect). Unknown RSSI does not limit.
+        int rssiQ8 = 256;
+        if (_rssi != 0 && _rssi < LINK_RSSI_GOOD)
+        {
+            rssiQ8 = (_rssi <= LINK_RSSI_BAD) ? 0
+                                              : ((_rssi - LINK_RSSI_BAD) * 256) / (LINK_RSSI_GOOD - LINK_RSSI_BAD);
+        }
+
+        // 2. LATENESS (Q8): full until half the timeout without a command,
+        // then linearly down to 0 at the failsafe deadline
+        int gapQ8 = 256;
+        uint32_t timeout = linkTimeout();
+        uint32_t elapsed = millis() - _lastPacketTime;
+        uint32_t half = timeout / 2;
+        if (elapsed > half)
+        {
+            gapQ8 = (elapsed >= timeout) ? 0 : (int)(((timeout - elapsed) * 256) / (timeout - half));
+        }
+
+        // 3. CAP: the worse of both, mapped onto [LINK_MIN_THROTTLE, 255]
+        int q = (rssiQ8 < gapQ8) ? rssiQ8 : gapQ8;
+        limit = (uint8_t)(LINK_MIN_THROTTLE + ((255 - LINK_MIN_THROTTLE) * q) / 256);
+    }
+
+    if (limit == _linkLimit)
+    {
+        return false;
+    }
+    _linkLimit = limit;
+    return true;
+}
+
+void RemoteControl::updateLink(int rssiDbm)
+{
+    // 1. RSSI: Smoothed (gain 1/4): single readings jump by several dB
+    if (rssiDbm == 0)
+    {
+        _rssi = 0;
+    }
+    else
+    {
+        _rssi = (_rssi == 0) ? rssiDbm : _rssi + (rssiDbm - _rssi) / 4;
+    }
+
+    // 2. CAP: Re-apply the pilot's last command if it moved
+    // (the watchdog is not fed: only real packets keep the link alive)
+    if (evaluateLink() && !_failsafeActive)
+    {
+        writeTraction(_requestedSpeed);
+    }
+
+    // 3. METRICS
+    Metrics::linkIntervalMs.set(_intervalMean8 >> 3);
+    Metrics::linkJitterMs.set(_intervalDev4 >> 2);
+    Metrics::linkTimeoutMs.set(linkTimeout());
+    Metrics::linkRssiDbm.set(_rssi);
+    Metrics::linkThrottle.set(_linkLimit);
+}
+
 void RemoteControl::checkFailsafe()
 {
     // Check only if system is NOT already in failure state.
     if (!_failsafeActive)
     {
         // If more time than allowed has passed without UDP packets...
-        if (millis() - _lastPacketTime > UDP_FAILSAFE_MS)
+        uint32_t silent = millis() - _lastPacketTime;
+        uint32_t timeout = linkTimeout();
+        if (silent > timeout)
         {
             // ...ACTIVATE EMERGENCY STOP PROTOCOL.
-            Serial.println("[FAILSAFE] Signal Lost (Timeout). EMERGENCY STOP.");
+            // Deferred log: the brake below must not wait for the UART
+            EventLog::log(LOG_FAILSAFE_TRIP, silent, timeout);
+            Metrics::failsafeTrips.inc();
 
             // Immediate physical actions
             _motors->brake();    // Hard brake
@@ -121,3 +408,26 @@ void RemoteControl::checkFailsafe()
         }
     }
 }
+
+unsigned long RemoteControl::msUntilFailsafe()
+{
+    unsigned long timeout = linkTimeout();
+    if (_failsafeActive)
+    {
+        return timeout;
+    }
+
+    unsigned long elapsed = millis() - _lastPacketTime;
+    // checkFailsafe() trips when elapsed > timeout (strictly greater)
+    return (elapsed > timeout) ? 0 : (timeout - elapsed + 1);
+}
+
+bool RemoteControl::isPiloted()
+{
+    return _lastPacketTime != 0 && !_failsafeActive;
+}
+
+int RemoteControl::getSocket()
+{
+    return _sock;
+}
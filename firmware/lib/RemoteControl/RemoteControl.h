@@ -6,22 +6,37 @@
  * Class responsible for listening to the UDP port, decoding control packets,
  * and orchestrating physical actuators (Motors and Servo).
  * Implements safety (Failsafe) and efficiency (State Cache).
+ *
+ * Link Governor: the command inter-arrival time is tracked (smoothed mean and
+ * mean deviation) together with the pilot's RSSI. The failsafe timeout is
+ * derived from the observed send interval (UDP_FAILSAFE_MS is the ceiling),
+ * and forward throttle is capped progressively as the link degrades, so the
+ * rover slows down BEFORE the failsafe cliff instead of braking from full speed.
  */
 
 #pragma once
 #include <Arduino.h>
-#include <WiFiUdp.h>
+#include "lwip/sockets.h"
 #include "config.h"
 #include "SolidAxle.h"
 #include "SteeringServo.h"
+#include <atomic>
 
 class RemoteControl
 {
 private:
-    WiFiUDP _udp;                  ///< UDP socket instance
-    uint8_t _packetBuffer[2];      ///< Reception buffer (Byte 0: Traction, Byte 1: Steering)
+    int _sock; ///< UDP socket (raw lwIP: required to set IP_TOS and to poll the fd)
+    uint8_t _packetBuffer[ControlProtocol::PACKET_MAX]; ///< Reception buffer (layout: control_protocol.h)
     unsigned long _lastPacketTime; ///< Timestamp of the last valid packet (ms)
     bool _failsafeActive;          ///< Flag: true if the robot is in emergency stop
+    std::atomic<uint32_t> _failsafeMs; ///< Watchdog timeout ceiling (default UDP_FAILSAFE_MS, runtime knob)
+
+    // --- MAILBOX (OTHER TASKS -> CONTROL LOOP) ---
+    // Commands from other transports (WebSocket) are parked here and applied by
+    // listen(), so the actuators keep a single writer (the loop task).
+    uint8_t _mailbox[ControlProtocol::COMMAND_SIZE]; ///< Latest pending command (Traction, Steering)
+    bool _mailboxFull;         ///< true if _mailbox holds an unapplied command
+    portMUX_TYPE _mailboxLock; ///< Spinlock: producer runs on another task/core
 
     // --- STATE CACHE (OPTIMIZATION) ---
     // We store the last applied command to avoid saturating the bus
@@ -29,10 +44,61 @@ private:
     uint8_t _prevSpeed; ///< Last speed code sent to motor (0-255)
     uint8_t _prevAngle; ///< Last angle sent to servo (0-180)
 
+    // --- THROTTLE LIMIT (OBSTACLE DETECTOR -> CONTROL LOOP) ---
+    uint8_t _requestedSpeed;                ///< Last speed code from the pilot (before the limit)
+    std::atomic<uint8_t> _throttleLimit;    ///< Max forward PWM (255 = none, 0 = stop)
+    std::atomic<bool> _limitChanged;        ///< Set by setThrottleLimit(), consumed by listen()
+
+    // --- LINK GOVERNOR (CONTROL TASK ONLY) ---
+    // Fixed point as in TCP's RTO estimator: mean x8 (gain 1/8), deviation x4 (gain 1/4).
+    uint32_t _intervalMean8;            ///< Smoothed inter-arrival time (ms << 3)
+    uint32_t _intervalDev4;             ///< Smoothed mean deviation (ms << 2)
+    int _intervalSamples;               ///< Intervals observed since the last reset
+    int _rssi;                          ///< Smoothed pilot RSSI (dBm, 0 = unknown)
+    uint8_t _linkLimit;                 ///< Forward PWM cap from link quality (255 = none)
+    std::atomic<bool> _linkGovernor;    ///< Runtime knob 'link_governor'
+
     // --- DEPENDENCIES (Hardware Pointers) ---
     SolidAxle *_motors;       ///< Traction Driver
     SteeringServo *_steering; ///< Steering Driver
 
+    /**
+     * @brief Applies one decoded command to the actuators.
+     * @details Resets the watchdog, exits Failsafe if needed and writes to the
+     * hardware only when the value differs from the State Cache.
+     * @param speedCode Byte[0]: 0=Coast, 1=Brake, 2-255=PWM Speed.
+     * @param angle Byte[1]: 0-180=Servo Angle.
+     */
+    void apply(uint8_t speedCode, uint8_t angle);
+
+    /**
+     * @brief Writes the traction command through the State Cache.
+     * @details Forward codes (2-255) are capped to the current throttle limit;
+     * a limit of 0 turns them into Brake. Coast/Brake pass through.
+     * @param speedCode 0=Coast, 1=Brake, 2-255=PWM Speed (as requested by the pilot).
+     */
+    void writeTraction(uint8_t speedCode);
+
+    /**
+     * @brief Feeds one command inter-arrival time to the link statistics.
+     * @param ms Time since the previous command.
+     */
+    void observeInterval(uint32_t ms);
+
+    /**
+     * @brief Effective failsafe timeout (ms).
+     * @details LINK_MISS_TOLERANCE * mean + 4 * deviation, clamped to
+     * [LINK_FAILSAFE_MIN_MS, failsafe_ms]. The ceiling alone while fewer than
+     * LINK_MIN_SAMPLES intervals are known or the governor is disabled.
+     */
+    uint32_t linkTimeout();
+
+    /**
+     * @brief Recomputes the link throttle cap from RSSI and packet lateness.
+     * @return true if the cap changed.
+     */
+    bool evaluateLink();
+
 public:
     /**
      * @brief Constructor with Dependency Injection.
@@ -43,23 +109,91 @@ public:
 
     /**
      * @brief Opens the UDP port and starts listening.
+     * @details Non-blocking socket. Replies are marked with DSCP_CONTROL (AC_VO).
      */
     void begin();
 
     /**
      * @brief Processes the incoming UDP packet queue.
      * @details
-     * Binary Protocol:
+     * Binary Protocol (decoded with ControlProtocol::PacketView):
      * - Byte[0]: 0=Coast, 1=Brake, 2-255=PWM Speed.
      * - Byte[1]: 0-180=Servo Angle.
-     * @note Must be called in every loop() iteration.
+     * - Byte[2..] (Optional): Probe token (max ControlProtocol::PROBE_MAX bytes). Echoed back
+     *   verbatim to the sender once the command has been applied, so host tools
+     *   can measure control latency. Plain 2-byte packets get no reply.
+     * @note Called by the control task when the socket is readable or woken. Drains all queued datagrams.
      */
     void listen();
 
+    /**
+     * @brief Queues a command received by another transport (e.g. WebSocket).
+     * @details Thread-safe and non-blocking. Only the latest command is kept
+     * (newer commands supersede unapplied ones). Applied on the next listen().
+     * @param frame Raw bytes with the UDP layout (Byte[0] Traction, Byte[1] Steering).
+     * @param len Frame length. Frames shorter than ControlProtocol::COMMAND_SIZE are ignored.
+     */
+    void submit(const uint8_t *frame, size_t len);
+
+    /**
+     * @brief Caps forward throttle (obstacle detector).
+     * @details Thread-safe and non-blocking. The new cap is applied to the
+     * pilot's last command on the next listen() (wake the control task to make
+     * it immediate), without touching the failsafe watchdog.
+     * @param maxPwm Max forward PWM: 255 = no limit, 0 = brake instead of forward.
+     */
+    void setThrottleLimit(uint8_t maxPwm);
+
+    /**
+     * @brief Changes the watchdog timeout (runtime parameter 'failsafe_ms').
+     * @details Thread-safe. Takes effect at the next failsafe deadline. With the
+     * link governor enabled this is the ceiling of the adaptive timeout.
+     * @param ms Max time without packets before the emergency stop.
+     */
+    void setFailsafeMs(uint32_t ms);
+
+    /**
+     * @brief Enables/disables the link governor (runtime parameter 'link_governor').
+     * @details Disabled: fixed failsafe_ms timeout and no link throttle cap
+     * (statistics are still collected for '/metrics').
+     * @param enabled true = adaptive timeout and throttle cap.
+     */
+    void setLinkGovernor(bool enabled);
+
+    /**
+     * @brief Periodic link evaluation (every LINK_UPDATE_MS, control task).
+     * @details Smooths the RSSI sample, lowers the throttle cap as the next
+     * command goes late and re-applies the pilot's last command under the new
+     * cap. Publishes the link gauges to Metrics.
+     * @param rssiDbm Current pilot RSSI (NetworkManager::getRssi(), 0 = unknown).
+     */
+    void updateLink(int rssiDbm);
+
     /**
      * @brief Safety Monitor (Watchdog).
-     * @details If no valid packets are received within UDP_FAILSAFE_MS (config.h),
-     * stops motors and centers steering to prevent accidents.
+     * @details If no valid packets are received within the failsafe timeout
+     * (adaptive, at most failsafe_ms), stops motors and centers steering to prevent accidents.
      */
     void checkFailsafe();
+
+    /**
+     * @brief Time left before the Failsafe would trip.
+     * @details Used by the event-driven scheduler to sleep exactly until the
+     * watchdog deadline instead of polling it.
+     * @return Milliseconds (0 = due now). If Failsafe is already active, returns
+     * the timeout itself: only a new packet can change the state.
+     */
+    unsigned long msUntilFailsafe();
+
+    /**
+     * @brief true while a pilot is in control (commands received, failsafe not active).
+     * @note Control task only (same context as listen()).
+     */
+    bool isPiloted();
+
+    /**
+     * @brief UDP socket descriptor (for select()-based event loops).
+     * @return lwIP fd, or -1 if begin() failed.
+     */
+    int getSocket();
 };
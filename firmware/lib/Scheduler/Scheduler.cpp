@@ -0,0 +1,194 @@
+/**
+ * @file Scheduler.cpp
+ * @brief Tickless Event-Driven Main Loop Implementation.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "Scheduler.h"
+
+Scheduler::Scheduler()
+{
+    _timerCount = 0;
+    _sourceCount = 0;
+    _wakeFn = NULL;
+    _wakeCtx = NULL;
+    _wakeSock = -1;
+    _wakePending = false;
+    _woken = false;
+    FD_ZERO(&_ready);
+    memset(&_wakeAddr, 0, sizeof(_wakeAddr));
+}
+
+bool Scheduler::begin()
+{
+    // SELF-PIPE TRICK (lwIP flavour): select() only watches sockets, so other
+    // tasks wake us by sending a 1-byte datagram to a loopback socket.
+    _wakeSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (_wakeSock < 0)
+    {
+        Serial.println("[SCHED] ERROR: Could not create wake socket");
+        return false;
+    }
+
+    _wakeAddr.sin_family = AF_INET;
+    _wakeAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    _wakeAddr.sin_port = 0; // Ephemeral
+
+    socklen_t len = sizeof(_wakeAddr);
+    if (bind(_wakeSock, (struct sockaddr *)&_wakeAddr, sizeof(_wakeAddr)) < 0 ||
+        getsockname(_wakeSock, (struct sockaddr *)&_wakeAddr, &len) < 0)
+    {
+        Serial.println("[SCHED] ERROR: Could not bind wake socket");
+        close(_wakeSock);
+        _wakeSock = -1;
+        return false;
+    }
+
+    fcntl(_wakeSock, F_SETFL, fcntl(_wakeSock, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+bool Scheduler::addTimer(const char *name, TimerFn fn, void *ctx, uint32_t firstDelayMs)
+{
+    if (_timerCount >= MAX_TIMERS)
+    {
+        Serial.printf("[SCHED] ERROR: Timer table full (%s)\n", name);
+        return false;
+    }
+
+    Timer &t = _timers[_timerCount++];
+    t.name = name;
+    t.fn = fn;
+    t.ctx = ctx;
+    t.deadlineUs = esp_timer_get_time() + (int64_t)firstDelayMs * 1000;
+    return true;
+}
+
+bool Scheduler::addReadable(const char *name, int fd, EventFn fn, void *ctx)
+{
+    if (fd < 0 || _sourceCount >= MAX_SOURCES)
+    {
+        Serial.printf("[SCHED] ERROR: Cannot watch source %s (fd %d)\n", name, fd);
+        return false;
+    }
+
+    Source &s = _sources[_sourceCount++];
+    s.name = name;
+    s.fd = fd;
+    s.fn = fn;
+    s.ctx = ctx;
+    return true;
+}
+
+void Scheduler::onWake(EventFn fn, void *ctx)
+{
+    _wakeFn = fn;
+    _wakeCtx = ctx;
+}
+
+void Scheduler::wake()
+{
+    // Coalescing: one pending datagram is enough to interrupt select().
+    // A benign race only costs one extra (harmless) wake-up.
+    if (_wakeSock < 0 || _wakePending)
+    {
+        return;
+    }
+    _wakePending = true;
+
+    uint8_t token = 1;
+    if (sendto(_wakeSock, &token, 1, 0, (struct sockaddr *)&_wakeAddr, sizeof(_wakeAddr)) < 0)
+    {
+        // Nothing queued (e.g. ENOMEM): the next wake() must try again
+        _wakePending = false;
+    }
+}
+
+void Scheduler::wait()
+{
+    // 1. EARLIEST DEADLINE
+    int64_t now = esp_timer_get_time();
+    int64_t timeoutUs = 1000000; // Upper bound: never sleep blindly for more than 1s
+
+    for (int i = 0; i < _timerCount; i++)
+    {
+        int64_t remaining = _timers[i].deadlineUs - now;
+        if (remaining < timeoutUs)
+        {
+            timeoutUs = (remaining > 0) ? remaining : 0;
+        }
+    }
+
+    // 2. BUILD FD SET
+    FD_ZERO(&_ready);
+    int maxFd = -1;
+    for (int i = 0; i < _sourceCount; i++)
+    {
+        FD_SET(_sources[i].fd, &_ready);
+        if (_sources[i].fd > maxFd)
+            maxFd = _sources[i].fd;
+    }
+    if (_wakeSock >= 0)
+    {
+        FD_SET(_wakeSock, &_ready);
+        if (_wakeSock > maxFd)
+            maxFd = _wakeSock;
+    }
+
+    // 3. SLEEP (select() blocks the task: the core goes IDLE)
+    struct timeval tv;
+    tv.tv_sec = (long)(timeoutUs / 1000000);
+    tv.tv_usec = (long)(timeoutUs % 1000000);
+
+    int n = (maxFd >= 0) ? select(maxFd + 1, &_ready, NULL, NULL, &tv) : 0;
+    if (maxFd < 0 && timeoutUs > 0)
+    {
+        delay((uint32_t)((timeoutUs + 999) / 1000)); // No sources registered yet
+    }
+    if (n <= 0)
+    {
+        FD_ZERO(&_ready); // Timeout (or error): only timers are due
+    }
+
+    // 4. DRAIN WAKE SOCKET
+    _woken = false;
+    if (_wakeSock >= 0 && FD_ISSET(_wakeSock, &_ready))
+    {
+        uint8_t sink[8];
+        while (recv(_wakeSock, sink, sizeof(sink), 0) > 0)
+        {
+        }
+        _wakePending = false;
+        _woken = true;
+    }
+}
+
+void Scheduler::dispatch()
+{
+    // 1. EVENTS FIRST (Control packets have priority over periodic work)
+    if (_woken && _wakeFn != NULL)
+    {
+        _wakeFn(_wakeCtx);
+    }
+    for (int i = 0; i < _sourceCount; i++)
+    {
+        if (FD_ISSET(_sources[i].fd, &_ready))
+        {
+            _sources[i].fn(_sources[i].ctx);
+        }
+    }
+
+    // 2. EXPIRED TIMERS
+    int64_t now = esp_timer_get_time();
+    for (int i = 0; i < _timerCount; i++)
+    {
+        Timer &t = _timers[i];
+        if (now >= t.deadlineUs)
+        {
+            uint32_t nextMs = t.fn(t.ctx);
+            // Re-arm from "now" (not from the old deadline): a late run must not
+            // trigger a burst of catch-up executions.
+            t.deadlineUs = esp_timer_get_time() + (int64_t)nextMs * 1000;
+        }
+    }
+}
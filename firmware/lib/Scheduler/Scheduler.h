@@ -0,0 +1,130 @@
+/**
+ * @file Scheduler.h
+ * @brief Tickless Event-Driven Main Loop (Deadlines + Readable Sockets).
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * Replaces the fixed "poll everything + delay(5)" loop:
+ * - Timers: each one returns the delay until its next run, so periodic jobs
+ *   (telemetry) and moving deadlines (failsafe) share one mechanism.
+ * - Readable sources: lwIP sockets (e.g. UDP control) watched with select().
+ * - Wake-up: other tasks (WebSocket handler) interrupt the wait via wake().
+ *
+ * wait() blocks in select() exactly until the earliest deadline or the first
+ * event: while blocked, the core runs the IDLE task (lower power, less heat)
+ * and a control packet is handled as soon as lwIP queues it (no 5ms poll).
+ *
+ * @note Single consumer: wait()/dispatch() must be called from one task only.
+ * wake() is safe from any task.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "lwip/sockets.h"
+#include "esp_timer.h"
+
+class Scheduler
+{
+public:
+    /**
+     * @brief Timer callback.
+     * @param ctx User pointer given at registration.
+     * @return Milliseconds until the next run (e.g. the period).
+     */
+    typedef uint32_t (*TimerFn)(void *ctx);
+
+    /**
+     * @brief Event callback (readable socket or wake-up).
+     * @param ctx User pointer given at registration.
+     */
+    typedef void (*EventFn)(void *ctx);
+
+    static const int MAX_TIMERS = 8;  ///< Fixed table size (no heap)
+    static const int MAX_SOURCES = 4; ///< Fixed table size (no heap)
+
+private:
+    struct Timer
+    {
+        const char *name;
+        TimerFn fn;
+        void *ctx;
+        int64_t deadlineUs; ///< esp_timer_get_time() of the next run
+    };
+
+    struct Source
+    {
+        const char *name;
+        int fd;
+        EventFn fn;
+        void *ctx;
+    };
+
+    Timer _timers[MAX_TIMERS];
+    int _timerCount;
+    Source _sources[MAX_SOURCES];
+    int _sourceCount;
+
+    EventFn _wakeFn;              ///< Called after a wake() (e.g. drain a mailbox)
+    void *_wakeCtx;               ///< User pointer for _wakeFn
+    int _wakeSock;                ///< Loopback UDP socket: wake() target
+    struct sockaddr_in _wakeAddr; ///< 127.0.0.1:<ephemeral port>
+    volatile bool _wakePending;   ///< Coalesces wake() bursts into 1 datagram
+
+    fd_set _ready; ///< Result of the last wait()
+    bool _woken;   ///< Last wait() was interrupted by wake()
+
+public:
+    /**
+     * @brief Constructor. Empty tables.
+     */
+    Scheduler();
+
+    /**
+     * @brief Creates the loopback wake-up socket.
+     * @note Call after the network stack (lwIP) is running.
+     * @return true on success.
+     */
+    bool begin();
+
+    /**
+     * @brief Registers a timer.
+     * @param name Static label (diagnostics).
+     * @param fn Callback; its return value schedules the next run.
+     * @param ctx User pointer.
+     * @param firstDelayMs Delay before the first run.
+     * @return false if the table is full.
+     */
+    bool addTimer(const char *name, TimerFn fn, void *ctx, uint32_t firstDelayMs = 0);
+
+    /**
+     * @brief Registers a socket; fn runs whenever it becomes readable.
+     * @param name Static label (diagnostics).
+     * @param fd lwIP socket descriptor.
+     * @param fn Callback (must drain the socket, otherwise wait() returns immediately).
+     * @param ctx User pointer.
+     * @return false if the table is full or fd is invalid.
+     */
+    bool addReadable(const char *name, int fd, EventFn fn, void *ctx);
+
+    /**
+     * @brief Sets the callback executed after wake().
+     * @param fn Callback.
+     * @param ctx User pointer.
+     */
+    void onWake(EventFn fn, void *ctx);
+
+    /**
+     * @brief Interrupts wait() from another task. Thread-safe, non-blocking.
+     */
+    void wake();
+
+    /**
+     * @brief Sleeps until the earliest timer deadline, a readable source or wake().
+     */
+    void wait();
+
+    /**
+     * @brief Runs the callbacks that became ready during the last wait().
+     */
+    void dispatch();
+};
@@ -5,6 +5,8 @@
  */
 
 #include "SolidAxle.h"
+#include "Trace.h"
+#include "EventLog.h"
 
 SolidAxle::SolidAxle(int pinFwd, int pinRev, int pinPWM)
 {
@@ -12,6 +14,9 @@ SolidAxle::SolidAxle(int pinFwd, int pinRev, int pinPWM)
     _pinRev = pinRev;
     _pinPWM = pinPWM;
     _velocidadActual = 0;
+    _level = 0;
+    _pwmFreq = MOTOR_PWM_FREQ;
+    _pwmResolution = MOTOR_PWM_RESOLUTION;
 }
 
 void SolidAxle::begin()
@@ -23,6 +28,7 @@ void SolidAxle::begin()
 
     // 2. PWM Peripheral Configuration (LEDC)
     // ESP32 uses LEDC hardware controller, not analogWrite().
+    // Channel/timer chosen in config.h so the camera XCLK (timer 0) is untouched.
     ledcSetup(_pwmChannel, _pwmFreq, _pwmResolution);
     ledcAttachPin(_pinPWM, _pwmChannel);
 
@@ -32,19 +38,23 @@ void SolidAxle::begin()
 
 void SolidAxle::brake()
 {
+    TRACE_SCOPE(TRACE_MOTOR_WRITE);
+
     // L298N Logic: IN1=LOW, IN2=LOW, ENA=HIGH -> Short Brake
     digitalWrite(_pinFwd, LOW);
     digitalWrite(_pinRev, LOW);
-    ledcWrite(_pwmChannel, 255);
+    writeLevel(255);
     _velocidadActual = 0;
 }
 
 void SolidAxle::coast()
 {
+    TRACE_SCOPE(TRACE_MOTOR_WRITE);
+
     // L298N Logic: ENA=LOW -> Motor Disabled (Free Run)
     digitalWrite(_pinFwd, LOW);
     digitalWrite(_pinRev, LOW);
-    ledcWrite(_pwmChannel, 0);
+    writeLevel(0);
     _velocidadActual = 0;
 }
 
@@ -53,7 +63,7 @@ void SolidAxle::drive(int velocidad)
     // --- 1. INTEGRITY VALIDATION ---
     if (velocidad > 255 || velocidad < -255)
     {
-        Serial.printf("[ERROR] Motor: Speed %d out of range. Ignored.\n", velocidad);
+        EventLog::log(LOG_MOTOR_RANGE, (uint32_t)velocidad); // Deferred: never blocks control
         return;
     }
 
@@ -63,7 +73,7 @@ void SolidAxle::drive(int velocidad)
     // In this phase, reverse is blocked until "Dynamic Dead Time" is implemented in client.
     if (velocidad < 0)
     {
-        Serial.printf("[WARN] Reverse requested. Blocked for safety.\n");
+        EventLog::log(LOG_MOTOR_REVERSE);
         brake();
         return;
     }
@@ -78,6 +88,7 @@ void SolidAxle::drive(int velocidad)
     }
 
     // --- 4. POWER APPLICATION ---
+    TRACE_BEGIN(TRACE_MOTOR_WRITE);
     if (velocidad > 0)
     {
         // Forward Config: IN1=HIGH, IN2=LOW
@@ -92,6 +103,39 @@ void SolidAxle::drive(int velocidad)
     }
 
     // PWM is always positive (velocity vector magnitude)
-    ledcWrite(_pwmChannel, abs(velocidad));
+    writeLevel(abs(velocidad));
+    TRACE_END(TRACE_MOTOR_WRITE);
     _velocidadActual = velocidad;
 }
+
+void SolidAxle::writeLevel(uint8_t level)
+{
+    // Commands are 0-255 whatever the resolution: 255 stays 100% duty
+    _level = level;
+    uint32_t maxDuty = (1UL << _pwmResolution) - 1;
+    ledcWrite(_pwmChannel, (uint32_t)level * maxDuty / 255);
+}
+
+bool SolidAxle::setPwm(uint32_t freqHz, uint8_t resolution)
+{
+    // 1. PARK THE CHANNEL: a duty computed for one resolution must never run
+    // at the other (14 -> 8 bits would saturate to full duty).
+    uint8_t level = _level;
+    ledcWrite(_pwmChannel, 0);
+
+    // 2. TIMER + SCALE TOGETHER (the LEDC divider must fit: 0 = rejected)
+    bool ok = ledcChangeFrequency(_pwmChannel, freqHz, resolution) != 0;
+    if (ok)
+    {
+        _pwmFreq = freqHz;
+        _pwmResolution = resolution;
+    }
+    else
+    {
+        ledcChangeFrequency(_pwmChannel, _pwmFreq, _pwmResolution); // Restore
+    }
+
+    // 3. SAME LEVEL BACK, scaled for the timer now running
+    writeLevel(level);
+    return ok;
+}
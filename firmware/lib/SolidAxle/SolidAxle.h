@@ -11,6 +11,7 @@
 
 #pragma once
 #include <Arduino.h>
+#include "config.h"
 
 class SolidAxle
 {
@@ -22,11 +23,19 @@ private:
 
     // --- Internal State ---
     int _velocidadActual; ///< Last commanded speed (-255 to 255)
+    uint8_t _level;       ///< Last PWM level written, 0-255 scale (re-scaled on resolution change)
 
     // --- PWM Configuration (ESP32 LEDC) ---
-    const int _pwmFreq = 1000;    ///< 1kHz Frequency (Optimal for generic DC motors)
-    const int _pwmChannel = 0;    ///< PWM Channel 0
-    const int _pwmResolution = 8; ///< 8-bit Resolution (Range 0-255)
+    // Channel is fixed (LEDC allocation in config.h: off the camera XCLK timer).
+    // Frequency and resolution are runtime parameters (setPwm).
+    const int _pwmChannel = MOTOR_PWM_CHANNEL; ///< LEDC channel (timer 2)
+    uint32_t _pwmFreq;                         ///< Frequency in Hz (default MOTOR_PWM_FREQ)
+    uint8_t _pwmResolution;                    ///< Duty resolution in bits (default MOTOR_PWM_RESOLUTION)
+
+    /**
+     * @brief Writes a 0-255 level scaled to the current resolution.
+     */
+    void writeLevel(uint8_t level);
 
 public:
     /**
@@ -67,4 +76,17 @@ public:
      * The motor remains electrically disconnected and spins freely by inertia.
      */
     void coast();
+
+    /**
+     * @brief Reconfigures the PWM timer while running (runtime tuning).
+     * @details The current output level is kept (re-scaled to the new resolution);
+     * the output is held at 0 for the few microseconds the timer is reprogrammed.
+     * @warning Call from the task that drives the motor (control task): it
+     * must not interleave with drive()/brake()/coast().
+     * @param freqHz PWM frequency.
+     * @param resolution Duty resolution in bits (1-16).
+     * @return false if the LEDC timer cannot produce this pair
+     * (freqHz x 2^resolution > 80MHz): previous settings stay active.
+     */
+    bool setPwm(uint32_t freqHz, uint8_t resolution);
 };
@@ -5,6 +5,8 @@
  */
 
 #include "SteeringServo.h"
+#include "config.h"
+#include "Trace.h"
 
 SteeringServo::SteeringServo(int pin, int center, int leftMax, int rightMax)
 {
@@ -17,6 +19,7 @@ SteeringServo::SteeringServo(int pin, int center, int leftMax, int rightMax)
     _angleCenter = center;
     _angleLeft = leftMax;
     _angleRight = rightMax;
+    _lastAngle = center;
 }
 
 void SteeringServo::begin()
@@ -26,6 +29,10 @@ void SteeringServo::begin()
     // @warning Using higher frequencies (>60Hz) can overheat or burn analog servos.
     _servo.setPeriodHertz(50);
 
+    // LEDC: keep the servo on its own timer (config.h). Without an explicit
+    // allocation ESP32Servo may pick timer 0, which drives the camera XCLK.
+    ESP32PWM::allocateTimer(SERVO_LEDC_TIMER);
+
     // 2. Configure Pulse Widths
     // Define the mapping between electrical signal (microseconds) and physical rotation.
     // - RC Theoretical Standard: 1000us (0°) to 2000us (180°).
@@ -39,17 +46,21 @@ void SteeringServo::begin()
 
 void SteeringServo::center()
 {
+    TRACE_SCOPE(TRACE_SERVO_WRITE);
     _servo.write(_angleCenter);
+    _lastAngle = _angleCenter;
 }
 
 void SteeringServo::turnLeft()
 {
     _servo.write(_angleLeft);
+    _lastAngle = _angleLeft;
 }
 
 void SteeringServo::turnRight()
 {
     _servo.write(_angleRight);
+    _lastAngle = _angleRight;
 }
 
 void SteeringServo::write(int angle)
@@ -61,5 +72,22 @@ void SteeringServo::write(int angle)
     // This physically prevents the servo from receiving a command that breaks the steering.
     int safeAngle = constrain(angle, _minLimit, _maxLimit);
 
+    TRACE_SCOPE(TRACE_SERVO_WRITE);
     _servo.write(safeAngle);
+    _lastAngle = safeAngle;
+}
+
+void SteeringServo::setCalibration(int centerAngle, int leftMax, int rightMax)
+{
+    bool centered = (_lastAngle == _angleCenter);
+
+    _minLimit = min(leftMax, rightMax);
+    _maxLimit = max(leftMax, rightMax);
+    _angleCenter = centerAngle;
+    _angleLeft = leftMax;
+    _angleRight = rightMax;
+
+    // Visible result while tuning the trim on the bench
+    if (centered)
+        center();
 }
@@ -27,6 +27,8 @@ private:
     int _minLimit; ///< Lowest allowed numerical value (e.g., 70)
     int _maxLimit; ///< Highest allowed numerical value (e.g., 110)
 
+    int _lastAngle; ///< Last angle written (recenter on calibration change)
+
 public:
     /**
      * @brief Constructor with physical limits.
@@ -64,4 +66,15 @@ public:
      * to avoid forcing the mechanism.
      */
     void write(int angle);
+
+    /**
+     * @brief Replaces the calibration while running (runtime tuning).
+     * @details Same rules as the constructor; the servo moves to the new center
+     * only if it is currently centered.
+     * @param centerAngle Center angle.
+     * @param leftMax Max left angle.
+     * @param rightMax Max right angle.
+     * @warning Call from the task that drives the servo (control task).
+     */
+    void setCalibration(int centerAngle, int leftMax, int rightMax);
 };
@@ -0,0 +1,191 @@
+/**
+ * @file TaskMonitor.cpp
+ * @brief FreeRTOS Run-Time Statistics Sampler Implementation.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "TaskMonitor.h"
+
+#if configGENERATE_RUN_TIME_STATS
+#define TASKMON_CPU_STATS 1
+#else
+#define TASKMON_CPU_STATS 0
+#endif
+
+// Scratch snapshot: only touched by the sampler task (static: ~1.2KB off its stack)
+static TaskStatus_t _snapshot[TaskMonitor::MAX_TASKS];
+
+TaskMonitor::TaskMonitor()
+{
+    _rowCount = 0;
+    _windowUs = 0;
+    _task = NULL;
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+    for (int i = 0; i < portNUM_PROCESSORS; i++)
+    {
+        _idlePermille[i] = 0;
+    }
+}
+
+void TaskMonitor::begin()
+{
+#if !configUSE_TRACE_FACILITY
+    Serial.println("[TASKS] ERROR: configUSE_TRACE_FACILITY disabled. Monitor unavailable.");
+    return;
+#endif
+    if (!TASKMON_CPU_STATS)
+    {
+        Serial.println("[TASKS] WARNING: Run-time stats disabled in sdkconfig. Reporting stacks only.");
+    }
+    xTaskCreatePinnedToCore(samplerTask, "taskmon", TASK_TASKMON.stack, this,
+                            TASK_TASKMON.priority, &_task, TASK_TASKMON.core);
+}
+
+void TaskMonitor::samplerTask(void *arg)
+{
+    TaskMonitor *self = (TaskMonitor *)arg;
+    TickType_t lastWake = xTaskGetTickCount();
+
+    while (true)
+    {
+        self->sample();
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(TASKMON_PERIOD_MS));
+    }
+}
+
+void TaskMonitor::sample()
+{
+#if configUSE_TRACE_FACILITY
+    static uint32_t prevTotal = 0;
+    uint32_t total = 0;
+
+    UBaseType_t n = uxTaskGetSystemState(_snapshot, MAX_TASKS, &total);
+    if (n == 0)
+    {
+        // FreeRTOS returns 0 when the table is too small for all tasks
+        Serial.printf("[TASKS] WARNING: More than %d tasks. Raise MAX_TASKS.\n", MAX_TASKS);
+        return;
+    }
+
+    uint32_t window = total - prevTotal; // Run-time clock (us) elapsed since last sample
+#if TASKMON_CPU_STATS
+    bool first = (prevTotal == 0);
+#endif
+    prevTotal = total;
+
+    // 1. BUILD NEW ROWS (diff against the published ones, matched by handle)
+    TaskRow rows[MAX_TASKS];
+    uint16_t idle[portNUM_PROCESSORS] = {0};
+
+    for (UBaseType_t i = 0; i < n; i++)
+    {
+        const TaskStatus_t &t = _snapshot[i];
+        TaskRow &r = rows[i];
+
+        strncpy(r.name, t.pcTaskName, sizeof(r.name) - 1);
+        r.name[sizeof(r.name) - 1] = '\0';
+        r.handle = t.xHandle;
+        r.core = (int)t.xCoreID;
+        r.priority = (uint8_t)t.uxCurrentPriority;
+        r.stackFree = t.usStackHighWaterMark; // ESP-IDF: bytes (StackType_t is uint8_t)
+        r.runtime = t.ulRunTimeCounter;
+        r.cpuPermille = 0;
+
+#if TASKMON_CPU_STATS
+        // Reading _rows without the lock is safe: only this task writes it.
+        for (int j = 0; j < _rowCount && !first && window > 0; j++)
+        {
+            if (_rows[j].handle == t.xHandle)
+            {
+                uint32_t delta = t.ulRunTimeCounter - _rows[j].runtime;
+                uint32_t permille = (uint32_t)(((uint64_t)delta * 1000) / window);
+                r.cpuPermille = (uint16_t)(permille > 1000 ? 1000 : permille);
+                break;
+            }
+        }
+
+        // IDLE0 / IDLE1: per-core idle time
+        if (strncmp(r.name, "IDLE", 4) == 0 && r.core >= 0 && r.core < portNUM_PROCESSORS)
+        {
+            idle[r.core] = r.cpuPermille;
+        }
+#endif
+    }
+
+    // 2. PUBLISH (short critical section: memcpy only)
+    portENTER_CRITICAL(&_lock);
+    memcpy(_rows, rows, sizeof(TaskRow) * n);
+    _rowCount = (int)n;
+    memcpy(_idlePermille, idle, sizeof(idle));
+    _windowUs = window;
+    portEXIT_CRITICAL(&_lock);
+#endif
+}
+
+void TaskMonitor::printReport()
+{
+    TaskRow rows[MAX_TASKS];
+    uint16_t idle[portNUM_PROCESSORS];
+    int count;
+
+    portENTER_CRITICAL(&_lock);
+    count = _rowCount;
+    memcpy(rows, _rows, sizeof(TaskRow) * count);
+    memcpy(idle, _idlePermille, sizeof(idle));
+    portEXIT_CRITICAL(&_lock);
+
+    Serial.println("[TASKS] NAME             CORE PRIO   CPU%  STACK_FREE");
+    for (int i = 0; i < count; i++)
+    {
+        Serial.printf("[TASKS] %-16s %4d %4u %5u.%u %8lu\n",
+                      rows[i].name, rows[i].core == tskNO_AFFINITY ? -1 : rows[i].core,
+                      rows[i].priority, rows[i].cpuPermille / 10, rows[i].cpuPermille % 10,
+                      (unsigned long)rows[i].stackFree);
+    }
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+    {
+        Serial.printf("[TASKS] Core %d idle: %u.%u%%\n", c, idle[c] / 10, idle[c] % 10);
+    }
+}
+
+esp_err_t TaskMonitor::httpHandler(httpd_req_t *req)
+{
+    TaskMonitor *self = (TaskMonitor *)req->user_ctx;
+    static TaskRow rows[MAX_TASKS]; // Static: only the httpd task runs this handler
+    uint16_t idle[portNUM_PROCESSORS];
+    uint32_t window;
+    int count;
+    char line[160];
+
+    portENTER_CRITICAL(&self->_lock);
+    count = self->_rowCount;
+    memcpy(rows, self->_rows, sizeof(TaskRow) * count);
+    memcpy(idle, self->_idlePermille, sizeof(idle));
+    window = self->_windowUs;
+    portEXIT_CRITICAL(&self->_lock);
+
+    httpd_resp_set_type(req, "application/json");
+
+    int len = snprintf(line, sizeof(line), "{\"cpu_stats\":%s,\"window_us\":%lu,\"idle_pct\":[",
+                       TASKMON_CPU_STATS ? "true" : "false", (unsigned long)window);
+    httpd_resp_send_chunk(req, line, len);
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+    {
+        len = snprintf(line, sizeof(line), "%s%u.%u", c ? "," : "", idle[c] / 10, idle[c] % 10);
+        httpd_resp_send_chunk(req, line, len);
+    }
+    httpd_resp_send_chunk(req, "],\"tasks\":[", HTTPD_RESP_USE_STRLEN);
+
+    for (int i = 0; i < count; i++)
+    {
+        const TaskRow &r = rows[i];
+        len = snprintf(line, sizeof(line),
+                       "%s{\"name\":\"%s\",\"core\":%d,\"prio\":%u,\"cpu_pct\":%u.%u,\"stack_free\":%lu}",
+                       i ? "," : "", r.name, r.core == tskNO_AFFINITY ? -1 : r.core, r.priority,
+                       r.cpuPermille / 10, r.cpuPermille % 10, (unsigned long)r.stackFree);
+        httpd_resp_send_chunk(req, line, len);
+    }
+
+    httpd_resp_send_chunk(req, "]}", HTTPD_RESP_USE_STRLEN);
+    return httpd_resp_send_chunk(req, NULL, 0); // End of chunked response
+}
@@ -0,0 +1,87 @@
+/**
+ * @file TaskMonitor.h
+ * @brief Per-Task CPU Load and Stack High-Water Sampler (FreeRTOS).
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * A low-priority task periodically snapshots 'uxTaskGetSystemState()' and diffs
+ * the run-time counters against the previous snapshot:
+ * - CPU % per task (100% = one core fully busy during the window).
+ * - Idle % per core (from the IDLE0/IDLE1 tasks).
+ * - Stack high-water mark per task (minimum free stack ever, bytes).
+ * The last report is served as JSON at '/tasks'.
+ *
+ * @note CPU figures require CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS in the
+ * framework's sdkconfig. Without it, only stack high-water marks are reported
+ * and "cpu_stats" is false in the JSON.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "esp_http_server.h"
+#include "config.h"
+
+class TaskMonitor
+{
+public:
+    /** @brief Max tracked tasks (fixed tables, no heap). */
+    static const int MAX_TASKS = 32;
+
+private:
+    /**
+     * @brief One row of the published report.
+     */
+    struct TaskRow
+    {
+        char name[16];        ///< Task name (copied: tasks may be deleted)
+        TaskHandle_t handle;  ///< Identity across samples
+        int core;             ///< Affinity (tskNO_AFFINITY = any)
+        uint8_t priority;     ///< Current priority
+        uint32_t runtime;     ///< Raw run-time counter at this sample
+        uint16_t cpuPermille; ///< CPU load in the window (0-1000 = 0-100.0% of one core)
+        uint32_t stackFree;   ///< Stack high-water mark (bytes never used)
+    };
+
+    TaskRow _rows[MAX_TASKS];                   ///< Published report
+    int _rowCount;                              ///< Valid entries in _rows
+    uint16_t _idlePermille[portNUM_PROCESSORS]; ///< Idle % per core (permille)
+    uint32_t _windowUs;                         ///< Length of the last window
+    portMUX_TYPE _lock;                         ///< Guards the published report
+    TaskHandle_t _task;                         ///< Sampler task
+
+    /**
+     * @brief Takes one snapshot and publishes the diff against the previous one.
+     */
+    void sample();
+
+    /**
+     * @brief Sampler task body.
+     * @param arg TaskMonitor instance.
+     */
+    static void samplerTask(void *arg);
+
+public:
+    /**
+     * @brief Constructor. Empty report.
+     */
+    TaskMonitor();
+
+    /**
+     * @brief Starts the periodic sampler (TASKMON_PERIOD_MS).
+     * @details Runs at priority 1 (just above idle) so it never delays control.
+     */
+    void begin();
+
+    /**
+     * @brief Prints the last report as a table to Serial.
+     */
+    void printReport();
+
+    /**
+     * @brief HTTP handler serving the last report as JSON.
+     * @details Register with 'user_ctx' pointing to the TaskMonitor instance.
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t Operation status.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+};
@@ -0,0 +1,88 @@
+/**
+ * @file Trace.cpp
+ * @brief Event Tracer Storage and Chrome JSON Exporter.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "Trace.h"
+
+#if ROVER_TRACE
+
+// Power of 2 required: the slot index is a mask, not a modulo.
+static_assert((TRACE_EVENTS_PER_CORE & (TRACE_EVENTS_PER_CORE - 1)) == 0,
+              "TRACE_EVENTS_PER_CORE must be a power of 2");
+
+/** @brief Display names, indexed by TraceId. */
+static const char *TRACE_NAMES[TRACE_ID_COUNT] = {
+    "fb_get",
+    "stream_send",
+    "ws_send",
+    "udp_listen",
+    "motor_write",
+    "servo_write",
+};
+
+Trace::Event Trace::_rings[portNUM_PROCESSORS][TRACE_EVENTS_PER_CORE];
+std::atomic<uint32_t> Trace::_head[portNUM_PROCESSORS];
+
+esp_err_t Trace::httpHandler(httpd_req_t *req)
+{
+    char line[160];
+    bool first = true;
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"rover_trace.json\"");
+    httpd_resp_send_chunk(req, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", HTTPD_RESP_USE_STRLEN);
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        // 1. PROCESS NAME (one "process" per core)
+        int len = snprintf(line, sizeof(line),
+                           "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"Core %d\"}}",
+                           first ? "" : ",", core, core);
+        httpd_resp_send_chunk(req, line, len);
+        first = false;
+
+        // 2. EVENTS (oldest -> newest). Writers keep running: the oldest few
+        // entries may be overwritten during the dump, which only drops events.
+        uint32_t head = _head[core].load(std::memory_order_relaxed);
+        uint32_t count = (head > TRACE_EVENTS_PER_CORE) ? TRACE_EVENTS_PER_CORE : head;
+
+        for (uint32_t n = head - count; n != head; n++)
+        {
+            const Event &e = _rings[core][n & (TRACE_EVENTS_PER_CORE - 1)];
+            if (e.id >= TRACE_ID_COUNT)
+            {
+                continue; // Defensive: never emit an out-of-table name
+            }
+            len = snprintf(line, sizeof(line),
+                           ",{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%u,\"pid\":%d,\"tid\":%u}",
+                           TRACE_NAMES[e.id], e.phase, (unsigned)e.ts, core, (unsigned)(uintptr_t)e.task);
+            if (httpd_resp_send_chunk(req, line, len) != ESP_OK)
+            {
+                return ESP_FAIL; // Client gone
+            }
+        }
+    }
+
+#if configUSE_TRACE_FACILITY
+    // 3. THREAD NAMES (live tasks only; deleted tasks keep their numeric tid)
+    static TaskStatus_t tasks[24]; // Static: ~1KB would strain the httpd stack
+    UBaseType_t n = uxTaskGetSystemState(tasks, 24, NULL);
+    for (UBaseType_t i = 0; i < n; i++)
+    {
+        for (int core = 0; core < portNUM_PROCESSORS; core++)
+        {
+            int len = snprintf(line, sizeof(line),
+                               ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                               core, (unsigned)(uintptr_t)tasks[i].xHandle, tasks[i].pcTaskName);
+            httpd_resp_send_chunk(req, line, len);
+        }
+    }
+#endif
+
+    httpd_resp_send_chunk(req, "]}", HTTPD_RESP_USE_STRLEN);
+    return httpd_resp_send_chunk(req, NULL, 0); // End of chunked response
+}
+
+#endif // ROVER_TRACE
@@ -0,0 +1,124 @@
+/**
+ * @file Trace.h
+ * @brief Lock-Free Per-Core Event Tracer (Chrome/Perfetto JSON Export).
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * Records begin/end events with microsecond timestamps into one ring buffer per
+ * CPU core. Writers reserve a slot with a single atomic fetch_add (no locks,
+ * no heap), so tracing from the httpd task, the loop task and ISRs-free contexts
+ * on both cores never blocks. When the ring wraps, the oldest events are lost.
+ *
+ * '/trace' dumps both rings as Chrome Trace Event JSON:
+ * open it in chrome://tracing or https://ui.perfetto.dev.
+ * - pid = CPU core (shows how both cores overlap).
+ * - tid = FreeRTOS task.
+ *
+ * @note Controlled by ROVER_TRACE (config.h). When 0, the TRACE_* macros expand
+ * to nothing and the rings are not allocated.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+/**
+ * @brief Traced code regions. Keep in sync with TRACE_NAMES (Trace.cpp).
+ */
+enum TraceId : uint8_t
+{
+    TRACE_FB_GET = 0,      ///< esp_camera_fb_get() (waiting for a frame)
+    TRACE_STREAM_SEND,     ///< MJPEG part send (sendAll(): part header + JPEG)
+    TRACE_WS_SEND,         ///< WebSocket JPEG push
+    TRACE_UDP_LISTEN,      ///< RemoteControl::listen()
+    TRACE_MOTOR_WRITE,     ///< SolidAxle PWM/direction update
+    TRACE_SERVO_WRITE,     ///< SteeringServo PWM update
+    TRACE_ID_COUNT
+};
+
+#if ROVER_TRACE
+
+#include "esp_timer.h"
+#include "esp_http_server.h"
+#include <atomic>
+
+/** @brief Opens a region on the current task. */
+#define TRACE_BEGIN(id) Trace::record((id), 'B')
+/** @brief Closes the region opened by TRACE_BEGIN. */
+#define TRACE_END(id) Trace::record((id), 'E')
+/** @brief Traces the enclosing C++ scope (RAII). */
+#define TRACE_SCOPE(id) TraceScope _traceScope_##id(id)
+
+class Trace
+{
+public:
+    /**
+     * @brief Compact event (12 bytes).
+     */
+    struct Event
+    {
+        uint32_t ts;       ///< esp_timer_get_time() low 32 bits (wraps every ~71 min)
+        TaskHandle_t task; ///< Recording task (Chrome 'tid')
+        uint8_t id;        ///< TraceId
+        char phase;        ///< 'B' (begin) or 'E' (end)
+        uint16_t reserved; ///< Padding (explicit)
+    };
+
+    /**
+     * @brief Appends an event to the ring of the current core.
+     * @details Wait-free: one atomic fetch_add + 12-byte store.
+     * @param id Region identifier.
+     * @param phase 'B' or 'E'.
+     */
+    static inline void record(uint8_t id, char phase)
+    {
+        int core = xPortGetCoreID();
+        uint32_t slot = _head[core].fetch_add(1, std::memory_order_relaxed) & (TRACE_EVENTS_PER_CORE - 1);
+        Event &e = _rings[core][slot];
+        e.ts = (uint32_t)esp_timer_get_time();
+        e.task = xTaskGetCurrentTaskHandle();
+        e.id = id;
+        e.phase = phase;
+    }
+
+    /**
+     * @brief HTTP handler dumping both rings as Chrome Trace Event JSON.
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t Operation status.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+
+private:
+    static Event _rings[portNUM_PROCESSORS][TRACE_EVENTS_PER_CORE];
+    static std::atomic<uint32_t> _head[portNUM_PROCESSORS]; ///< Total events written per core
+};
+
+/**
+ * @brief RAII helper used by TRACE_SCOPE.
+ */
+class TraceScope
+{
+private:
+    uint8_t _id;
+
+public:
+    explicit TraceScope(uint8_t id) : _id(id) { Trace::record(id, 'B'); }
+    ~TraceScope() { Trace::record(_id, 'E'); }
+};
+
+#else // !ROVER_TRACE: Zero overhead
+
+#define TRACE_BEGIN(id) \
+    do                  \
+    {                   \
+    } while (0)
+#define TRACE_END(id) \
+    do                \
+    {                 \
+    } while (0)
+#define TRACE_SCOPE(id) \
+    do                  \
+    {                   \
+    } while (0)
+
+#endif // ROVER_TRACE
@@ -0,0 +1,204 @@
+/**
+ * @file WebUI.cpp
+ * @brief LittleFS Mount, ETag Index and Chunked Gzip Responses.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "WebUI.h"
+#include <LittleFS.h>
+#include "Metrics.h"
+
+// Static files are built as <original name>.gz
+static const char *GZ_SUFFIX = ".gz";
+static const char *PAGE_FILE = "/index.html.gz";
+static const char *ASSET_DIR = "/ui";
+
+WebUI::Asset WebUI::_assets[WEBUI_MAX_FILES];
+int WebUI::_count = 0;
+char WebUI::_chunk[WEBUI_CHUNK_SIZE];
+
+// "public, max-age=N": formatted once at boot (header values must outlive the handler)
+static char assetCacheControl[40];
+
+/**
+ * @brief Little-endian u32 (gzip trailer fields).
+ */
+static uint32_t readLe32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool WebUI::begin()
+{
+    snprintf(assetCacheControl, sizeof(assetCacheControl), "public, max-age=%lu",
+             (unsigned long)WEBUI_ASSET_MAX_AGE_S);
+
+    // 1. MOUNT (no format on failure: an unflashed partition is not an error)
+    if (!LittleFS.begin(false))
+    {
+        Serial.println("[WEB] LittleFS not mounted (run 'pio run -t uploadfs'): UI disabled");
+        return false;
+    }
+
+    // 2. INDEX: the page, then every '/ui/*.gz' asset
+    index(PAGE_FILE, "/");
+
+    File dir = LittleFS.open(ASSET_DIR);
+    if (dir && dir.isDirectory())
+    {
+        File f = dir.openNextFile();
+        while (f)
+        {
+            // Copied: the name belongs to the File handle closed below
+            char path[sizeof(_assets[0].path)];
+            char uri[sizeof(_assets[0].uri)];
+            snprintf(path, sizeof(path), "%s", f.path());
+            bool isFile = !f.isDirectory();
+            f.close();
+
+            size_t len = strlen(path);
+            size_t suffix = strlen(GZ_SUFFIX);
+            if (isFile && len > suffix && strcmp(path + len - suffix, GZ_SUFFIX) == 0)
+            {
+                snprintf(uri, sizeof(uri), "%.*s", (int)(len - suffix), path);
+                index(path, uri);
+            }
+            f = dir.openNextFile();
+        }
+        dir.close();
+    }
+
+    Serial.printf("[WEB] %d file(s) indexed, %u/%u KB of LittleFS used\n", _count,
+                  (unsigned)(LittleFS.usedBytes() / 1024), (unsigned)(LittleFS.totalBytes() / 1024));
+    return _count > 0 && _assets[0].page;
+}
+
+void WebUI::index(const char *path, const char *uri)
+{
+    if (_count >= WEBUI_MAX_FILES || strlen(path) >= sizeof(_assets[0].path) ||
+        strlen(uri) >= sizeof(_assets[0].uri))
+    {
+        Serial.printf("[ERROR] Web: cannot index %s\n", path);
+        return;
+    }
+
+    File f = LittleFS.open(path, FILE_READ);
+    if (!f)
+    {
+        return;
+    }
+
+    // 1. VALIDATE: gzip magic and room for the 8-byte trailer
+    uint8_t head[2] = {0, 0};
+    uint8_t trailer[8];
+    size_t size = f.size();
+    bool ok = size >= 18 && f.read(head, 2) == 2 && head[0] == 0x1F && head[1] == 0x8B &&
+              f.seek(size - 8) && f.read(trailer, 8) == 8;
+    f.close();
+    if (!ok)
+    {
+        Serial.printf("[ERROR] Web: %s is not a gzip file, skipped\n", path);
+        return;
+    }
+
+    // 2. ETAG: CRC32 + length of the original, plus the compressed length.
+    // Changes whenever the served bytes change (the build is deterministic).
+    Asset &a = _assets[_count];
+    strcpy(a.path, path);
+    strcpy(a.uri, uri);
+    snprintf(a.etag, sizeof(a.etag), "\"%08lx-%lx-%x\"", (unsigned long)readLe32(trailer),
+             (unsigned long)readLe32(trailer + 4), (unsigned)size);
+    a.page = strcmp(uri, "/") == 0;
+    a.type = mimeType(a.page ? "index.html" : uri);
+    _count++;
+}
+
+const char *WebUI::mimeType(const char *uri)
+{
+    static const struct
+    {
+        const char *ext;
+        const char *type;
+    } TYPES[] = {
+        {".html", "text/html; charset=utf-8"},
+        {".js", "application/javascript"},
+        {".css", "text/css"},
+        {".svg", "image/svg+xml"},
+        {".json", "application/json"},
+        {".webmanifest", "application/manifest+json"},
+        {".ico", "image/x-icon"},
+        {".png", "image/png"},
+    };
+
+    const char *dot = strrchr(uri, '.');
+    for (size_t i = 0; dot && i < sizeof(TYPES) / sizeof(TYPES[0]); i++)
+    {
+        if (strcmp(dot, TYPES[i].ext) == 0)
+        {
+            return TYPES[i].type;
+        }
+    }
+    return "application/octet-stream";
+}
+
+esp_err_t WebUI::httpHandler(httpd_req_t *req)
+{
+    // 1. RESOLVE (query string ignored: '/?v=2' is still the page)
+    size_t uriLen = strcspn(req->uri, "?");
+    const Asset *asset = NULL;
+    for (int i = 0; i < _count && !asset; i++)
+    {
+        if (strlen(_assets[i].uri) == uriLen && strncmp(_assets[i].uri, req->uri, uriLen) == 0)
+        {
+            asset = &_assets[i];
+        }
+    }
+    if (!asset)
+    {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, _count ? "Not found" : "UI not flashed (pio run -t uploadfs)");
+    }
+
+    // 2. CACHE HEADERS (sent with 200 and 304 alike)
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", asset->page ? "no-cache" : assetCacheControl);
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+    // 3. REVALIDATION: matching ETag -> 304, no body, no flash access
+    char inm[80];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", inm, sizeof(inm)) == ESP_OK &&
+        strstr(inm, asset->etag) != NULL)
+    {
+        Metrics::webNotModified.inc();
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    // 4. BODY: stored gzip bytes streamed as-is, chunk by chunk
+    File f = LittleFS.open(asset->path, FILE_READ);
+    if (!f)
+    {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Read error");
+    }
+
+    httpd_resp_set_type(req, asset->type);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+
+    esp_err_t res = ESP_OK;
+    while (res == ESP_OK)
+    {
+        size_t n = f.read((uint8_t *)_chunk, sizeof(_chunk));
+        if (n == 0)
+        {
+            break;
+        }
+        res = httpd_resp_send_chunk(req, _chunk, n);
+    }
+    f.close();
+
+    if (res != ESP_OK)
+    {
+        return res; // Client gone: httpd closes the session
+    }
+    Metrics::webServed.inc();
+    return httpd_resp_send_chunk(req, NULL, 0); // End of chunked response
+}
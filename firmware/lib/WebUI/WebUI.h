@@ -0,0 +1,75 @@
+/**
+ * @file WebUI.h
+ * @brief Browser Pilot Page Served Pre-Compressed from LittleFS.
+ * @author Alejandro Moyano (@AleSMC)
+ * @version 1.0.0
+ * @details
+ * The page (video + touch/gamepad controls over '/ws') lives gzip-compressed
+ * in the otherwise unused LittleFS partition of 'huge_app.csv'. Nothing is
+ * compressed, templated or buffered on the rover:
+ * - Files are stored as '<name>.gz' (built by 'python -m tools.build_webui').
+ * - Responses carry 'Content-Encoding: gzip' and are streamed from flash in
+ *   WEBUI_CHUNK_SIZE chunks through one static buffer (no full-file RAM copy).
+ * - Strong ETag per file from the gzip trailer (CRC32 + size of the original)
+ *   and the compressed size: computed at boot from 8 bytes per file, without
+ *   reading or hashing the content.
+ * - Cache policy: '/' is revalidated on every load ('no-cache' + ETag -> a
+ *   ~150 B '304 Not Modified'), '/ui/' assets are cached WEBUI_ASSET_MAX_AGE_S.
+ *   After the first visit the UI costs one round trip.
+ *
+ * Routes: '/' -> '/index.html.gz', '/ui/<file>' -> '/ui/<file>.gz'.
+ * @note The '/ui/' prefix route needs the wildcard URI matcher (set by CameraServer::startServer).
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "esp_http_server.h"
+#include "config.h"
+
+class WebUI
+{
+public:
+    /**
+     * @brief Mounts LittleFS and indexes the compressed files (ETag, type).
+     * @details Never formats the partition: an empty or missing filesystem only
+     * disables the UI (the API endpoints keep working).
+     * @return true if at least the page ('/index.html.gz') was found.
+     */
+    static bool begin();
+
+    /**
+     * @brief HTTP handler for '/' and every '/ui/' asset (GET).
+     * @param req Incoming HTTP request structure.
+     * @return esp_err_t Operation status.
+     */
+    static esp_err_t httpHandler(httpd_req_t *req);
+
+private:
+    /**
+     * @brief One servable file.
+     */
+    struct Asset
+    {
+        char uri[32];     ///< Public path ("/" or "/ui/x.css")
+        char path[40];    ///< LittleFS path of the compressed file
+        char etag[32];    ///< Quoted strong ETag
+        const char *type; ///< MIME type (from the original extension)
+        bool page;        ///< true = revalidate always, false = long max-age
+    };
+
+    /**
+     * @brief Adds a file to the table if it is a valid gzip member.
+     * @param path LittleFS path ending in ".gz".
+     * @param uri Public path it is served under.
+     */
+    static void index(const char *path, const char *uri);
+
+    /**
+     * @brief MIME type from the extension of the original name.
+     */
+    static const char *mimeType(const char *uri);
+
+    static Asset _assets[WEBUI_MAX_FILES];
+    static int _count;
+    static char _chunk[WEBUI_CHUNK_SIZE]; ///< Flash -> socket buffer (httpd task only)
+};
@@ -8,12 +8,12 @@
  * @author Alejandro Moyano (@AleSMC)
  * @note --- USAGE INSTRUCTIONS (PLATFORMIO) ---
  * 1. Upload Firmware:   pio run -t upload
- * 2. Serial Monitor:    pio device monitor -b 115200
+ * 2. Serial Monitor:    pio device monitor  (text only, LOG_BAUD)
+ *    Full log decoder:  cd software && python -m tools.log_decoder --port <COM/tty>
  * @warning If upload fails, connect GPIO0 to GND (IO0 Button) and press Reset.
  */
 
 #include <Arduino.h>
-#include <WiFi.h> // [COOL-DOWN] Required to adjust TX power
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
 
@@ -24,6 +24,18 @@
 #include "SolidAxle.h"
 #include "SteeringServo.h"
 #include "RemoteControl.h"
+#include "BootProfiler.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "TaskMonitor.h"
+#include "Scheduler.h"
+#include "HeapAudit.h"
+#include "EventLog.h"
+#include "CameraProfiles.h"
+#include "ObstacleDetector.h"
+#include "ParamRegistry.h"
+#include "WebUI.h"
+#include "PowerGovernor.h"
 
 // =============================================================================
 // GLOBAL INSTANCES (Service Architecture)
@@ -43,6 +55,334 @@ SteeringServo steering(PIN_SERVO, STEERING_CENTER, STEERING_LEFT_MAX, STEERING_R
 // This allows 'remote' to manipulate 'motors' and 'steering' without owning them.
 RemoteControl remote(&motors, &steering);
 
+// 4. Diagnostics
+BootProfiler boot;
+TaskMonitor tasks;
+
+// =============================================================================
+// PARALLEL BOOT (Camera probe on Core 0 while WiFi associates on Core 1)
+// =============================================================================
+// The OV2640 probe (SCCB + DMA/PSRAM allocation) and the WiFi association are
+// independent and both spend most of their time waiting on hardware.
+
+static SemaphoreHandle_t cameraInitDone = NULL; ///< Given when camera.init() returns
+static volatile bool cameraOk = false;          ///< Result of camera.init()
+
+/**
+ * @brief One-shot task: initializes the camera and signals the main thread.
+ * @param arg Unused.
+ */
+static void cameraInitTask(void *arg)
+{
+    int phase = boot.begin("camera_init");
+    cameraOk = camera.init();
+    boot.end(phase);
+
+    xSemaphoreGive(cameraInitDone);
+    vTaskDelete(NULL);
+}
+
+// =============================================================================
+// EVENT-DRIVEN SERVICES (Registered in the Scheduler)
+// =============================================================================
+
+Scheduler scheduler;
+
+/**
+ * @brief Control Process (Real-Time): UDP socket readable or WebSocket mailbox.
+ * @details Reads UDP buffer, decodes protocol, and updates motors/servo.
+ */
+static void onControlEvent(void *ctx)
+{
+    remote.listen();
+}
+
+/**
+ * @brief Safety System (Watchdog): Checks if connection with pilot has been lost.
+ * @return Delay until the (possibly moved) failsafe deadline.
+ */
+static uint32_t failsafeTimer(void *ctx)
+{
+    remote.checkFailsafe();
+    return remote.msUntilFailsafe();
+}
+
+/**
+ * @brief Link Governor: RSSI sample and throttle cap re-evaluation.
+ * @return LINK_UPDATE_MS (fixed period).
+ */
+static uint32_t linkTimer(void *ctx)
+{
+    remote.updateLink(network.getRssi());
+    // The adaptive timeout may have shrunk since the failsafe timer was armed
+    remote.checkFailsafe();
+    return LINK_UPDATE_MS;
+}
+
+/**
+ * @brief Power Governor: temperature/droop sample, CPU clock, TX power, frame gap.
+ * @return POWER_UPDATE_MS (fixed period).
+ */
+static uint32_t powerTimer(void *ctx)
+{
+    StreamClientStats streams[STREAM_MAX_CLIENTS];
+    bool busy = remote.isPiloted() || CameraServer::getStreamStats(streams, STREAM_MAX_CLIENTS) > 0;
+    PowerGovernor::update(busy, network.getRssi());
+    return POWER_UPDATE_MS;
+}
+
+/**
+ * @brief Network Maintenance.
+ * @details Currently passive thanks to FreeRTOS, reserved for future logic.
+ */
+static uint32_t networkTimer(void *ctx)
+{
+    network.update();
+    return NETWORK_UPDATE_MS;
+}
+
+/**
+ * @brief Telemetry (Heartbeat): Prints status every TELEMETRY_PERIOD_MS.
+ * @details Own low-priority task (TASK_TELEMETRY): a blocking Serial line
+ * must never delay a control packet.
+ */
+static void telemetryTask(void *arg)
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    // Formatted here, not with Serial.printf(): Print::printf() falls back to
+    // malloc() for lines longer than 64 chars (zero-heap-after-boot).
+    char line[128];
+
+    while (true)
+    {
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(TELEMETRY_PERIOD_MS));
+
+        snprintf(line, sizeof(line), "[ALIVE] Mode: %s | IP: %s | Uptime: %lu s\n",
+                 network.getMode(),
+                 network.getIP(),
+                 millis() / 1000);
+        Serial.print(line);
+
+        // RSSI next to the governor state: a lowered TX power must not kill the signal
+        // (AP mode: strongest connected station, i.e. the pilot)
+        long rssi = network.getRssi();
+        int tx = PowerGovernor::txQdbm();
+        snprintf(line, sizeof(line), "[STATUS] IP: %s | Signal: %ld dBm | Temp: %d C | Step %d: %d MHz, TX %d.%02d dBm\n",
+                 network.getIP(), rssi, PowerGovernor::temperature(), PowerGovernor::step(),
+                 PowerGovernor::cpuMhz(), tx / 4, (tx % 4) * 25);
+        Serial.print(line);
+    }
+}
+
+// =============================================================================
+// ACTUATOR MAILBOX (Runtime Calibration -> Control Task)
+// =============================================================================
+// The control task is the only writer of the motor and the servo, so it also
+// applies their calibration, between two commands. Setters (httpd or 'params'
+// task, one at a time under ParamRegistry's lock) post the values, wake the
+// loop and wait for the verdict.
+static struct
+{
+    bool pending;      ///< Posted, not taken by the control task yet
+    bool steer;        ///< true = steering calibration, false = motor PWM pair
+    int32_t values[3]; ///< Center/left/right or frequency/resolution
+    bool ok;           ///< Result of the last apply
+} actuatorReq;
+static portMUX_TYPE actuatorLock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t actuatorDone = NULL; ///< Given by the control task after an apply
+static volatile bool controlStarted = false;  ///< Before: setup() applies directly
+
+/**
+ * @brief Applies one actuator setting (control task, or setup() before it runs).
+ */
+static bool applyActuator(bool steer, const int32_t *v)
+{
+    if (steer)
+    {
+        steering.setCalibration(v[0], v[1], v[2]);
+        return true;
+    }
+    return motors.setPwm(v[0], v[1]);
+}
+
+/**
+ * @brief Control task: applies the posted actuator setting, if any.
+ */
+static void serviceActuatorMailbox()
+{
+    portENTER_CRITICAL(&actuatorLock);
+    bool pending = actuatorReq.pending;
+    bool steer = actuatorReq.steer;
+    int32_t v[3] = {actuatorReq.values[0], actuatorReq.values[1], actuatorReq.values[2]};
+    actuatorReq.pending = false;
+    portEXIT_CRITICAL(&actuatorLock);
+
+    if (!pending)
+        return;
+    actuatorReq.ok = applyActuator(steer, v);
+    xSemaphoreGive(actuatorDone); // Publishes 'ok' to the waiting setter
+}
+
+/**
+ * @brief Hands an actuator setting to the control task and waits for the result.
+ * @param steer true = steering calibration (3 values), false = motor PWM (2 values).
+ * @return false if the owner rejected it or the loop did not take it in time.
+ */
+static bool postActuator(bool steer, const int32_t *v)
+{
+    if (!controlStarted)
+        return applyActuator(steer, v); // Boot: nothing else drives them yet
+
+    portENTER_CRITICAL(&actuatorLock);
+    actuatorReq.steer = steer;
+    memcpy(actuatorReq.values, v, (steer ? 3 : 2) * sizeof(int32_t));
+    actuatorReq.pending = true;
+    portEXIT_CRITICAL(&actuatorLock);
+    scheduler.wake();
+
+    if (xSemaphoreTake(actuatorDone, pdMS_TO_TICKS(PARAM_APPLY_TIMEOUT_MS)) != pdTRUE)
+    {
+        // Loop stalled: withdraw the request, unless it is being applied right now
+        portENTER_CRITICAL(&actuatorLock);
+        bool withdrawn = actuatorReq.pending;
+        actuatorReq.pending = false;
+        portEXIT_CRITICAL(&actuatorLock);
+        if (withdrawn)
+            return false;
+        xSemaphoreTake(actuatorDone, portMAX_DELAY);
+    }
+    return actuatorReq.ok;
+}
+
+/**
+ * @brief Control Task (TASK_CONTROL): runs the event-driven Scheduler.
+ * @details Replaces Arduino's loopTask, whose core and priority (1) are fixed
+ * by the framework and would let the video senders delay control.
+ */
+static void controlTask(void *arg)
+{
+    while (true)
+    {
+        // 1. SLEEP UNTIL WORK (Tickless)
+        // Blocks in select() until a control packet arrives, another task calls
+        // scheduler.wake(), or the earliest deadline (failsafe) expires.
+        // While blocked the core runs IDLE: this replaces the old delay(5) cool-down
+        // without its 0-5ms reaction penalty.
+        scheduler.wait();
+
+        // 2. RUN READY SERVICES
+        int64_t loopStart = esp_timer_get_time();
+        Metrics::loopIterations.inc();
+
+        serviceActuatorMailbox(); // Calibration changes land between two commands
+        scheduler.dispatch();
+
+        // Body duration only (the wait above is excluded on purpose)
+        Metrics::loopUs.observe((uint32_t)(esp_timer_get_time() - loopStart));
+    }
+}
+
+// =============================================================================
+// RUNTIME PARAMETERS (Tuning Knobs, NVS)
+// =============================================================================
+// Defaults are the config.h constants. Each callback applies the value to its
+// owner right away (and at boot, with the value stored in NVS).
+
+// Last applied values of the knobs that are only valid as a group
+static int32_t steerCal[3] = {STEERING_CENTER, STEERING_LEFT_MAX, STEERING_RIGHT_MAX};
+static int32_t motorPwm[2] = {MOTOR_PWM_FREQ, MOTOR_PWM_RESOLUTION};
+
+/**
+ * @brief Steering calibration: the three angles are validated together.
+ * @param which 0 = center, 1 = left stop, 2 = right stop.
+ * @param value New angle.
+ */
+static bool applySteering(int which, int32_t value)
+{
+    int32_t cal[3] = {steerCal[0], steerCal[1], steerCal[2]};
+    cal[which] = value;
+    if (cal[0] < min(cal[1], cal[2]) || cal[0] > max(cal[1], cal[2]))
+        return false; // Center must lie between the stops
+
+    if (!postActuator(true, cal))
+        return false;
+    steerCal[which] = value;
+    return true;
+}
+
+/**
+ * @brief Motor PWM timer: frequency and resolution are validated as a pair.
+ * @param which 0 = frequency (Hz), 1 = resolution (bits).
+ * @param value New value.
+ */
+static bool applyMotorPwm(int which, int32_t value)
+{
+    int32_t pwm[2] = {motorPwm[0], motorPwm[1]};
+    pwm[which] = value;
+    if (!postActuator(false, pwm))
+        return false; // LEDC cannot divide down to this pair (or loop stalled)
+
+    motorPwm[which] = value;
+    return true;
+}
+
+/**
+ * @brief Registers every knob. Call after the actuators and the camera are up.
+ */
+static void registerParams()
+{
+    ParamRegistry::begin();
+
+    ParamRegistry::add("failsafe_ms", PARAM_INT, 100, 5000, UDP_FAILSAFE_MS, [](int32_t v)
+                       { remote.setFailsafeMs(v); return true; });
+    ParamRegistry::add("link_governor", PARAM_BOOL, 0, 1, 1, [](int32_t v)
+                       { remote.setLinkGovernor(v != 0); return true; });
+
+    // Each steer_* apply is checked against the other two: seed the group with
+    // the stored calibration (if it is valid as a whole), not the defaults
+    int32_t cal[3] = {ParamRegistry::stored("steer_center", 0, 180, STEERING_CENTER),
+                      ParamRegistry::stored("steer_left", 0, 180, STEERING_LEFT_MAX),
+                      ParamRegistry::stored("steer_right", 0, 180, STEERING_RIGHT_MAX)};
+    if (cal[0] >= min(cal[1], cal[2]) && cal[0] <= max(cal[1], cal[2]))
+    {
+        for (int i = 0; i < 3; i++)
+            steerCal[i] = cal[i];
+    }
+
+    ParamRegistry::add("steer_center", PARAM_INT, 0, 180, STEERING_CENTER, [](int32_t v)
+                       { return applySteering(0, v); });
+    ParamRegistry::add("steer_left", PARAM_INT, 0, 180, STEERING_LEFT_MAX, [](int32_t v)
+                       { return applySteering(1, v); });
+    ParamRegistry::add("steer_right", PARAM_INT, 0, 180, STEERING_RIGHT_MAX, [](int32_t v)
+                       { return applySteering(2, v); });
+
+    ParamRegistry::add("motor_pwm_hz", PARAM_INT, 100, 40000, MOTOR_PWM_FREQ, [](int32_t v)
+                       { return applyMotorPwm(0, v); });
+    ParamRegistry::add("motor_pwm_bits", PARAM_INT, 8, 14, MOTOR_PWM_RESOLUTION, [](int32_t v)
+                       { return applyMotorPwm(1, v); });
+
+    ParamRegistry::add("stream_gap_ms", PARAM_INT, 0, 500, STREAM_FRAME_GAP_MS, [](int32_t v)
+                       { CameraServer::setFrameGapMs(v); return true; });
+
+    // Camera overrides: -1 = follow the active profile ('/profile')
+    ParamRegistry::add("cam_quality", PARAM_INT, -1, 63, -1, [](int32_t v)
+                       { return CameraProfiles::setOverride(OVERRIDE_QUALITY, v); });
+    ParamRegistry::add("cam_framesize", PARAM_INT, -1, CAMERA_MAX_FRAMESIZE, -1, [](int32_t v)
+                       { return CameraProfiles::setOverride(OVERRIDE_FRAMESIZE, v); });
+    ParamRegistry::add("cam_xclk_mhz", PARAM_INT, -1, 20, -1, [](int32_t v)
+                       { return (v < 0 || v >= 8) && CameraProfiles::setOverride(OVERRIDE_XCLK, v); });
+
+    ParamRegistry::add("power_governor", PARAM_BOOL, 0, 1, 1, [](int32_t v)
+                       { PowerGovernor::setEnabled(v != 0); return true; });
+    ParamRegistry::add("power_temp_offset", PARAM_INT, -20, 20, 0, [](int32_t v)
+                       { PowerGovernor::setTempOffset(v); return true; });
+
+#if ROVER_VISION
+    ParamRegistry::add("vision_enable", PARAM_BOOL, 0, 1, 1, [](int32_t v)
+                       { ObstacleDetector::setEnabled(v != 0); return true; });
+#endif
+}
+
 // =============================================================================
 // SETUP (System Initialization)
 // =============================================================================
@@ -51,11 +391,17 @@ void setup()
     // 1. POWER MANAGEMENT (CRITICAL)
     // Disable Brownout Detector. WiFi and Motor startup generates
     // current spikes that could reset the ESP32 if this were active.
+    // The core's brown-out ISR stays enabled here (the comparator is off);
+    // PowerGovernor::begin() masks it before re-arming the comparator detect-only.
     WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
 
     // 2. START SERIAL PORT (Debug)
-    Serial.begin(115200);
-    delay(1000);
+    // No settle delay: the boot report is printed at the end of setup(),
+    // and early lines are only lost if the monitor attaches late.
+    // LOG_BAUD (921600): text logs + binary event records (tools.log_decoder).
+    Serial.begin(LOG_BAUD);
+    boot.mark("serial");
+    EventLog::begin(); // Deferred logging for hot paths (control, failsafe)
 
     // [COOL-DOWN] 3. ENSURE FLASH OFF (GPIO 4)
     // The flash pin sometimes floats and generates heat/phantom power drain.
@@ -65,15 +411,31 @@ void setup()
     // 4. INITIALIZE PHYSICAL ACTUATORS
     // Safe to init hardware before WiFi.
     Serial.println("\n[BOOT] Initializing Motors and Servo...");
+    int phase = boot.begin("actuators");
     motors.begin();
     steering.begin();
     steering.center(); // Safe initial position (Straight wheels)
+    boot.end(phase);
 
-    // 5. INITIALIZE CAMERA
+    // 5. INITIALIZE CAMERA (PARALLEL, CORE 0)
     // High Priority: Camera needs to reserve large memory blocks (DMA/PSRAM).
-    // We do this before starting the WiFi stack to prevent RAM fragmentation.
-    Serial.println("[BOOT] Initializing Video Hardware...");
-    if (camera.init())
+    // The task is started before the WiFi stack so its allocations still come
+    // first and RAM fragmentation is kept low.
+    Serial.println("[BOOT] Initializing Video Hardware (Core 0)...");
+    cameraInitDone = xSemaphoreCreateBinary();
+    xTaskCreatePinnedToCore(cameraInitTask, "cam_init", TASK_CAMERA_INIT.stack, NULL,
+                            TASK_CAMERA_INIT.priority, NULL, TASK_CAMERA_INIT.core);
+
+    // 6. START NETWORK STACK (CORE 1, IN PARALLEL WITH THE CAMERA)
+    // Blocking process (~10s max) that connects to WiFi or creates AP.
+    phase = boot.begin("network");
+    network.begin();
+    boot.end(phase);
+
+    // 7. JOIN: Camera result is required before exposing the stream
+    xSemaphoreTake(cameraInitDone, portMAX_DELAY);
+    vSemaphoreDelete(cameraInitDone);
+    if (cameraOk)
     {
         Serial.println("[BOOT] OV2640 Camera ready.");
     }
@@ -87,63 +449,118 @@ void setup()
         }
     }
 
-    // 6. START NETWORK STACK
-    // Blocking process (~10s max) that connects to WiFi or creates AP.
-    network.begin();
-
-    // // [COOL-DOWN] 7. REDUCE WIFI POWER (Optional)
-    // // When connecting to iPhone (short range), we don't need 20dBm.
-    // // WIFI_POWER_11dBm saves ~100mA and significantly reduces heat.
-    // WiFi.setTxPower(WIFI_POWER_11dBm);
-    // Serial.println("[ENERGY] WiFi Power reduced to 11dBm.");
+    // 8. POWER GOVERNOR (replaces the fixed 11 dBm cool-down)
+    // TX power, CPU clock and frame gap now follow temperature, supply droops
+    // and the pilot's RSSI (config.h, POWER GOVERNOR).
+    PowerGovernor::begin();
 
-    // 8. START BACKGROUND SERVICES
+    // 9. START BACKGROUND SERVICES
+    phase = boot.begin("services");
+    actuatorDone = xSemaphoreCreateBinary();
+    registerParams(); // Stored tuning (NVS) applied before anything moves
     camera.startServer(); // Async Web Server (Port 80)
     remote.begin();       // UDP Listener (Port 9999)
 
+    // WebSocket control frames are routed to the same controller as UDP.
+    // wake() makes the loop apply them immediately instead of at the next event.
+    camera.setControlSink([](const uint8_t *frame, size_t len)
+                          { remote.submit(frame, len); scheduler.wake(); });
+
+    // Event-driven main loop: sources and deadlines
+    scheduler.begin();
+    scheduler.addReadable("udp_control", remote.getSocket(), onControlEvent, NULL);
+    scheduler.onWake(onControlEvent, NULL);
+    scheduler.addTimer("failsafe", failsafeTimer, NULL, UDP_FAILSAFE_MS);
+    scheduler.addTimer("network", networkTimer, NULL, NETWORK_UPDATE_MS);
+    scheduler.addTimer("link", linkTimer, NULL, LINK_UPDATE_MS);
+    scheduler.addTimer("power", powerTimer, NULL, POWER_UPDATE_MS);
+
+#if ROVER_VISION
+    // Obstacle detector: throttle cap applied by the control task right away
+    ObstacleDetector::begin([](uint8_t maxPwm)
+                            { remote.setThrottleLimit(maxPwm); scheduler.wake(); });
+#endif
+
+    // Task layout (config.h, TASK LAYOUT): control preempts video senders
+    // From here on, actuator knobs go through the control task's mailbox
+    controlStarted = true;
+    xTaskCreatePinnedToCore(controlTask, "control", TASK_CONTROL.stack, NULL,
+                            TASK_CONTROL.priority, NULL, TASK_CONTROL.core);
+    xTaskCreatePinnedToCore(telemetryTask, "telemetry", TASK_TELEMETRY.stack, NULL,
+                            TASK_TELEMETRY.priority, NULL, TASK_TELEMETRY.core);
+    boot.end(phase);
+    boot.mark("drivable"); // KPI: Time-to-Drivable (control accepted from here)
+
+    camera.addEndpoint("/boot", HTTP_GET, BootProfiler::httpHandler, &boot);
+    camera.addEndpoint("/metrics", HTTP_GET, Metrics::httpHandler);
+#if ROVER_TRACE
+    camera.addEndpoint("/trace", HTTP_GET, Trace::httpHandler);
+#endif
+    tasks.begin(); // Periodic CPU/stack sampler (priority 1)
+    camera.addEndpoint("/tasks", HTTP_GET, TaskMonitor::httpHandler, &tasks);
+    camera.addEndpoint("/heap", HTTP_GET, HeapAudit::httpHandler);
+    camera.addEndpoint("/profile", HTTP_GET, CameraProfiles::httpHandler);
+    camera.addEndpoint("/params", HTTP_GET, ParamRegistry::httpHandler);
+    ParamRegistry::startUdp(); // Text get/set on PARAM_UDP_PORT (priority 1)
+#if ROVER_VISION
+    camera.addEndpoint("/vision", HTTP_GET, ObstacleDetector::httpHandler);
+#endif
+    bool webUi = WebUI::begin(); // Pilot page from LittleFS (gzip, ETag)
+    camera.addEndpoint("/", HTTP_GET, WebUI::httpHandler);
+    camera.addEndpoint("/ui/*", HTTP_GET, WebUI::httpHandler);
+
     // FINAL STATUS REPORT
     Serial.println("\n[BOOT] SYSTEM ONLINE - ROVER READY.");
     Serial.printf("[INFO] Video Stream: http://%s.local/stream\n", MDNS_NAME);
-    Serial.printf("[INFO] Video Stream by IP:   http://%s/stream\n", network.getIP().c_str());
+    Serial.printf("[INFO] Video Stream by IP:   http://%s/stream\n", network.getIP());
     Serial.printf("[INFO] UDP Control:  Port %d\n", UDP_PORT);
+    Serial.printf("[INFO] WebSocket:    ws://%s/ws\n", network.getIP());
+    Serial.printf("[INFO] Boot Report:  http://%s/boot\n", network.getIP());
+    Serial.printf("[INFO] Metrics:      http://%s/metrics\n", network.getIP());
+    Serial.printf("[INFO] Task Load:    http://%s/tasks\n", network.getIP());
+    Serial.printf("[INFO] Heap Audit:   http://%s/heap\n", network.getIP());
+    Serial.printf("[INFO] Cam Profile:  http://%s/profile?name=fpv\n", network.getIP());
+    Serial.printf("[INFO] Still:        http://%s/still?size=UXGA\n", network.getIP());
+    Serial.printf("[INFO] Parameters:   http://%s/params (UDP %d)\n", network.getIP(), PARAM_UDP_PORT);
+    Serial.printf("[INFO] Pilot UI:     http://%s/%s\n", network.getIP(), webUi ? "" : " (not flashed)");
+#if ROVER_VISION
+    Serial.printf("[INFO] Vision:       http://%s/vision\n", network.getIP());
+#endif
+    boot.printReport();
+    Serial.printf("[BOOT] Time-to-Drivable: %lu ms (WiFi path: %s)\n",
+                  (unsigned long)(boot.getTime("drivable") / 1000),
+                  network.usedFastPath() ? "FAST" : "FULL");
+
+    // ZERO-HEAP-AFTER-BOOT: everything above may allocate, nothing below should.
+    // Strict tasks have no legitimate allocation left. The others still call
+    // into lwIP from their own context (e.g. UDP probe echo -> pbuf), which
+    // is counted but tolerated.
+    HeapAudit::watch("telemetry", true);
+    HeapAudit::watch("taskmon", true);
+    HeapAudit::watch("eventlog", true);
+    HeapAudit::watch("control", false);
+    HeapAudit::watch("httpd", false);
+    HeapAudit::watch("ws_video", false);
+    for (int i = 0; i < STREAM_MAX_CLIENTS; i++)
+    {
+        char name[12];
+        snprintf(name, sizeof(name), "stream%d", i); // Same names as CameraServer::startServer()
+        HeapAudit::watch(name, false);
+    }
+    HeapAudit::watch("still", false);
+    HeapAudit::watch("params", false); // NVS writes allocate inside the IDF
+#if ROVER_VISION
+    HeapAudit::watch("vision", true); // Static TJpgDec pool: no allocation at all
+#endif
+    HeapAudit::arm();
 }
 
 // =============================================================================
-// LOOP (Non-Blocking Main Loop)
+// LOOP (Unused)
 // =============================================================================
 void loop()
 {
-    // 1. Network Maintenance
-    // (Currently passive thanks to FreeRTOS, reserved for future logic)
-    network.update();
-
-    // 2. Control Process (Real-Time)
-    // Reads UDP buffer, decodes protocol, and updates motors/servo.
-    remote.listen();
-
-    // 3. Safety System (Watchdog)
-    // Checks if connection with pilot has been lost.
-    remote.checkFailsafe();
-
-    // 4. Telemetry (Heartbeat)
-    // Prints status every 5 seconds without using delay() to avoid blocking control.
-    static unsigned long lastTime = 0;
-    if (millis() - lastTime > 5000)
-    {
-        lastTime = millis();
-        Serial.printf("[ALIVE] Mode: %s | IP: %s | Uptime: %lu s\n",
-                      network.getMode().c_str(),
-                      network.getIP().c_str(),
-                      millis() / 1000);
-
-        // Print RSSI to ensure lowering power didn't kill signal
-        long rssi = WiFi.RSSI();
-        Serial.printf("[STATUS] IP: %s | Signal: %ld dBm | Temp: OK\n",
-                      network.getIP().c_str(), rssi);
-    }
-
-    // [COOL-DOWN] 5. CPU COOL-DOWN
-    // Critical: A small delay allows the RTOS to put the CPU into "Idle" mode.
-    // This drops temperature drastically without affecting response (5ms is imperceptible).
-    delay(5);
+    // All periodic and event work runs in the pinned 'control' task.
+    // Arduino's loopTask is not needed any more: free its stack.
+    vTaskDelete(NULL);
 }
@@ -13,34 +13,68 @@ import numpy as np
 # --- MODULAR IMPORTS ---
 from modules.VideoStream import VideoStream
 from modules.KeyboardPilot import KeyboardPilot
+from modules.Discovery import discover
+from modules import Protocol
 
 # --- CONFIGURATION ---
-# [CRITICAL] SET YOUR ROVER IP HERE
-# 1. AP Mode (Default): "192.168.4.1" (If you connect to 'Rover-Emergency' WiFi)
-# 2. STA Mode (Home WiFi): Check the ESP32 Serial Monitor (Baud 115200) to see the assigned IP.
-ROVER_IP = "192.168.4.1"
+# ROVER ADDRESS
+# None (Default): Auto-discovery via mDNS ('_rover._udp' service, ~1s).
+# Set a fixed IP to skip it (e.g. networks that block multicast).
+ROVER_IP = None
 
-# Video URL (Default Port 80 per firmware config)
-VIDEO_URL = f"http://{ROVER_IP}/stream" 
+# Used when discovery finds nothing: the Rover's own hotspot ('Rover-Emergency' WiFi)
+AP_FALLBACK_IP = "192.168.4.1"
 
-# UDP Control Port
+# Max discovery wait (seconds)
+DISCOVERY_TIMEOUT_S = 2.0
+
+# Video URL and UDP Control Port (overridden by the discovered TXT records)
+VIDEO_URL = None
 UDP_PORT = 9999
 
 # Control Frequency (5Hz = Eco Mode / Stable)
 SEND_INTERVAL_MS = 200 
 
+# QoS Marking (WMM): DSCP CS6 (48) -> 802.11e Voice queue (AC_VO).
+# The router then sends control packets ahead of queued video traffic.
+# Must match DSCP_CONTROL in firmware/include/config.h. Set to 0 to disable.
+CONTROL_DSCP = 48
+
+def resolve_rover():
+    """Returns (ip, udp_port, video_url): fixed ROVER_IP, else mDNS, else AP fallback."""
+    if ROVER_IP:
+        return ROVER_IP, UDP_PORT, VIDEO_URL or f"http://{ROVER_IP}/stream"
+
+    print("Searching for rover (mDNS)...")
+    t0 = time.time()
+    rovers = discover(timeout=DISCOVERY_TIMEOUT_S)
+    if rovers:
+        rover = rovers[0]
+        print(f"[DISCOVERY] Found {rover} in {time.time() - t0:.1f}s")
+        return rover.ip, rover.control_port, rover.video_url
+
+    print(f"[DISCOVERY] No rover answered. Falling back to AP address {AP_FALLBACK_IP}")
+    return AP_FALLBACK_IP, UDP_PORT, f"http://{AP_FALLBACK_IP}/stream"
+
 def main():
     print(f"--- STARTING ROVER SYSTEM ---")
-    print(f"Target IP: {ROVER_IP}")
+    rover_ip, udp_port, video_url = resolve_rover()
+    print(f"Target IP: {rover_ip}")
     
     # 1. Setup UDP Network
     sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        # IP_TOS carries DSCP in its upper 6 bits
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_TOS, CONTROL_DSCP << 2)
+    except OSError as e:
+        # Some OS (e.g. Windows without admin policy) ignore or reject IP_TOS
+        print(f"[WARN] Could not set DSCP {CONTROL_DSCP}: {e}")
     
     # 2. Start Video Module
     print("Connecting to camera...")
     try:
         # Instantiate the imported class
-        vs = VideoStream(VIDEO_URL).start()
+        vs = VideoStream(video_url).start()
         time.sleep(2.0) # Sensor warmup
     except Exception as e:
         print(f"[ERROR] Could not connect to video: {e}")
@@ -80,16 +114,16 @@ def main():
             
             if (current_time - last_send_time) > SEND_INTERVAL_MS:
                 packet = pilot.get_packet()
-                sock.sendto(packet, (ROVER_IP, UDP_PORT))
+                sock.sendto(packet, (rover_ip, udp_port))
                 last_send_time = current_time
     except KeyboardInterrupt:
         print("\n[INFO] User interruption.")
     finally:
         print("[SHUTDOWN] Stopping Rover and releasing resources...")
         # Send stop command multiple times to ensure reception
-        stop_cmd = bytes([1, 90])
+        stop_cmd = Protocol.encode(Protocol.TRACTION_BRAKE, Protocol.STEERING_STRAIGHT)
         for _ in range(3): 
-            sock.sendto(stop_cmd, (ROVER_IP, UDP_PORT))
+            sock.sendto(stop_cmd, (rover_ip, udp_port))
             time.sleep(0.05)
             
         vs.stop()
@@ -0,0 +1,122 @@
+"""
+Discovery.py
+------------
+Module responsible for finding the Rover on the local network (mDNS / DNS-SD).
+Browses the '_rover._udp' service published by the firmware (NetworkManager)
+and reads the connection parameters from its TXT records, so the client needs
+no hard-coded IP and no trip to the serial monitor.
+
+TXT records (firmware/lib/NetworkManager/NetworkManager.cpp):
+- proto:  control protocol revision (ControlProtocol::VERSION).
+- http:   web server port.
+- stream: MJPEG path.
+- dscp:   DSCP the firmware marks control replies with.
+- video:  video transports served ("mjpeg", "ws").
+
+List the rovers on the network (from 'software/'):
+    python -m modules.Discovery
+"""
+
+import threading
+import time
+
+from modules import Protocol
+
+try:
+    from zeroconf import ServiceBrowser, ServiceListener, Zeroconf
+except ImportError:  # Optional: without it the client falls back to a fixed IP
+    Zeroconf = None
+    ServiceListener = object
+
+SERVICE_TYPE = "_rover._udp.local."
+
+# Highest control protocol revision this client speaks (generated from
+# firmware/include/control_protocol.h).
+PROTOCOL_VERSION = Protocol.VERSION
+
+
+class RoverInfo:
+    """Connection parameters of one advertised Rover."""
+
+    def __init__(self, name, ip, control_port, txt):
+        self.name = name
+        self.ip = ip
+        self.control_port = control_port
+        self.proto = int(txt.get("proto", "1"))
+        self.http_port = int(txt.get("http", "80"))
+        self.stream_path = txt.get("stream", "/stream")
+        self.dscp = int(txt.get("dscp", "48"))
+        self.video = [v for v in txt.get("video", "mjpeg").split(",") if v]
+
+    @property
+    def video_url(self):
+        port = "" if self.http_port == 80 else f":{self.http_port}"
+        return f"http://{self.ip}{port}{self.stream_path}"
+
+    def __str__(self):
+        return (f"{self.name}: {self.ip} | control udp/{self.control_port} (proto {self.proto}) "
+                f"| video {','.join(self.video)} {self.video_url}")
+
+
+class _Listener(ServiceListener):
+    """Collects resolved '_rover._udp' instances (called from the zeroconf thread)."""
+
+    def __init__(self):
+        self.found = []
+        self.event = threading.Event()
+        self.lock = threading.Lock()
+
+    def add_service(self, zc, type_, name):
+        info = zc.get_service_info(type_, name, timeout=1000)
+        if info is None:
+            return
+        ipv4 = [a for a in info.parsed_addresses() if ":" not in a]
+        if not ipv4:
+            return
+        txt = {k.decode(): (v or b"").decode() for k, v in info.properties.items()}
+        rover = RoverInfo(name.replace("." + type_, ""), ipv4[0], info.port, txt)
+        if rover.proto > PROTOCOL_VERSION:
+            print(f"[DISCOVERY] Skipping {rover.name}: protocol {rover.proto} > {PROTOCOL_VERSION} (update the client)")
+            return
+        with self.lock:
+            self.found.append(rover)
+        self.event.set()
+
+    def update_service(self, zc, type_, name):
+        pass
+
+    def remove_service(self, zc, type_, name):
+        pass
+
+
+def discover(timeout=2.0, first=True):
+    """
+    Browses for Rovers.
+    :param timeout: Max wait in seconds (an answer usually arrives in well under 1s).
+    :param first: Return as soon as one Rover is resolved (else wait the full timeout).
+    :return: List of RoverInfo (empty if none answered or zeroconf is not installed).
+    """
+    if Zeroconf is None:
+        print("[DISCOVERY] 'zeroconf' not installed (pip install zeroconf): discovery disabled.")
+        return []
+
+    zc = Zeroconf()
+    listener = _Listener()
+    try:
+        ServiceBrowser(zc, SERVICE_TYPE, listener)
+        if first:
+            listener.event.wait(timeout)
+        else:
+            time.sleep(timeout)
+        with listener.lock:
+            return list(listener.found)
+    finally:
+        zc.close()
+
+
+if __name__ == "__main__":
+    t0 = time.perf_counter()
+    rovers = discover(timeout=3.0, first=False)
+    for r in rovers:
+        print(r)
+    print(f"[DISCOVERY] {len(rovers)} rover(s) in {time.perf_counter() - t0:.1f}s")
@@ -9,13 +9,15 @@ keyboard events to eliminate lag and allow diagonals.
 
 from pynput import keyboard
 
+from modules import Protocol
+
 class KeyboardPilot:
     def __init__(self):
         # --- PARAMETER CONFIGURATION ---
         
         # PWM Speed Mapping
-        self.PWM_COAST = 0
-        self.PWM_BRAKE = 1
+        self.PWM_COAST = Protocol.TRACTION_COAST
+        self.PWM_BRAKE = Protocol.TRACTION_BRAKE
         
         # For PWM_SLOW: 130 is approximately 50% duty cycle (255 is 100%).
         # This causes a lot of electrical noise through the cables and triggers the servo.
@@ -28,7 +30,7 @@ class KeyboardPilot:
         self.PWM_TURBO = 255  # Space + W (Turbo Mode)
         
         # Angle Mapping
-        self.ANGLE_CENTER = 90
+        self.ANGLE_CENTER = Protocol.STEERING_STRAIGHT
         self.ANGLE_LEFT = 40   # Calibrated Limit
         self.ANGLE_RIGHT = 140 # Calibrated Limit
 
@@ -116,8 +118,8 @@ class KeyboardPilot:
         elif k_space and not k_w:
             pwm_out = self.PWM_BRAKE
             
-        # Return packet ready for UDP
-        return bytes([int(pwm_out), int(angle_out)])
+        # Return packet ready for UDP (layout: firmware/include/control_protocol.h)
+        return Protocol.encode(int(pwm_out), int(angle_out))
 
     def stop(self):
         self.listener.stop()
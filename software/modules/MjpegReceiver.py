@@ -0,0 +1,126 @@
+"""
+MjpegReceiver.py
+----------------
+Python binding (ctypes) of the native low-latency MJPEG receiver
+(native/mjpeg_receiver.cpp).
+
+The library parses the rover's multipart stream on its own thread, decodes
+only the newest complete JPEG (libjpeg-turbo) and hands it over through a
+triple buffer. read() wraps that buffer in a numpy array WITHOUT copying it:
+the array is valid until the next read() or stop(). Copy it (frame.copy())
+to keep a frame longer.
+
+Build the library first (from 'software/'):
+    g++ -O2 -std=c++11 -shared -fPIC -pthread native/mjpeg_receiver.cpp -ljpeg -o native/libmjpeg_receiver.so
+
+If it is not built, 'available' is False and VideoStream falls back to OpenCV.
+"""
+
+import ctypes
+import os
+import sys
+from urllib.parse import urlparse
+
+import numpy as np
+
+LIB_NAME = "libmjpeg_receiver.dylib" if sys.platform == "darwin" else "libmjpeg_receiver.so"
+LIB_PATH = os.path.join(os.path.dirname(__file__), "..", "native", LIB_NAME)
+
+
+class MjpegStats(ctypes.Structure):
+    """Mirror of MjpegStats (native/mjpeg_receiver.h)."""
+
+    _fields_ = [
+        ("received", ctypes.c_uint64),
+        ("decoded", ctypes.c_uint64),
+        ("skipped", ctypes.c_uint64),
+        ("corrupt", ctypes.c_uint64),
+        ("bytes", ctypes.c_uint64),
+        ("lastDecodeUs", ctypes.c_uint32),
+        ("lastPublishUs", ctypes.c_uint32),
+        ("connected", ctypes.c_int32),
+    ]
+
+
+def _load():
+    try:
+        lib = ctypes.CDLL(os.path.normpath(LIB_PATH))
+    except OSError:
+        return None
+    lib.mjpeg_open.restype = ctypes.c_void_p
+    lib.mjpeg_open.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_char_p, ctypes.c_int]
+    lib.mjpeg_acquire.restype = ctypes.c_int
+    lib.mjpeg_acquire.argtypes = [
+        ctypes.c_void_p,
+        ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8)),
+        ctypes.POINTER(ctypes.c_int),
+        ctypes.POINTER(ctypes.c_int),
+        ctypes.POINTER(ctypes.c_uint64),
+    ]
+    lib.mjpeg_stats.restype = None
+    lib.mjpeg_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(MjpegStats)]
+    lib.mjpeg_close.restype = None
+    lib.mjpeg_close.argtypes = [ctypes.c_void_p]
+    return lib
+
+
+_lib = _load()
+available = _lib is not None
+
+
+class MjpegReceiver:
+    def __init__(self, url, timeout_ms=3000):
+        """
+        Connects to an MJPEG stream.
+        :param url: Stream URL (e.g., http://192.168.4.1/stream).
+        :param timeout_ms: Connect/receive timeout; the stream ends on a silent link.
+        """
+        if not available:
+            raise RuntimeError(f"{LIB_NAME} not built (see native/mjpeg_receiver.h)")
+        u = urlparse(url)
+        if u.scheme != "http" or not u.hostname:
+            raise ValueError(f"Unsupported stream URL: {url}")
+        self._rx = _lib.mjpeg_open(u.hostname.encode(), u.port or 80,
+                                   (u.path or "/").encode(), timeout_ms)
+        if not self._rx:
+            raise ConnectionError(f"Could not open {url}")
+
+        self._data = ctypes.POINTER(ctypes.c_uint8)()
+        self._w = ctypes.c_int()
+        self._h = ctypes.c_int()
+        self._seq = ctypes.c_uint64()
+        self.frame = None
+        self.seq = 0
+
+    def read(self):
+        """
+        Newest decoded frame as a BGR numpy view (H x W x 3), or None before
+        the first one. Valid until the next read()/stop().
+        """
+        if not self._rx:
+            return None
+        res = _lib.mjpeg_acquire(self._rx, ctypes.byref(self._data), ctypes.byref(self._w),
+                                 ctypes.byref(self._h), ctypes.byref(self._seq))
+        if res == 1:
+            # Zero-copy: the array points into the receiver's held buffer
+            flat = np.ctypeslib.as_array(self._data, shape=(self._h.value * self._w.value * 3,))
+            self.frame = flat.reshape(self._h.value, self._w.value, 3)
+            self.seq = self._seq.value
+        return self.frame
+
+    def stats(self):
+        """Receiver counters as a dict (see MjpegStats)."""
+        st = MjpegStats()
+        if self._rx:
+            _lib.mjpeg_stats(self._rx, ctypes.byref(st))
+        return {name: getattr(st, name) for name, _ in MjpegStats._fields_}
+
+    def connected(self):
+        return self.stats()["connected"] == 1
+
+    def stop(self):
+        """Closes the stream and frees the native buffers (invalidates read() views)."""
+        if self._rx:
+            _lib.mjpeg_close(self._rx)
+            self._rx = None
+            self.frame = None
@@ -0,0 +1,49 @@
+"""
+Protocol.py
+-----------
+Control packet codec (Python side of 'firmware/include/control_protocol.h').
+
+GENERATED by 'python -m tools.gen_protocol'. DO NOT EDIT: change the header
+and regenerate, so the firmware and the client never disagree on the layout.
+"""
+
+VERSION           = 1
+TRACTION_OFFSET   = 0  # Byte offset of the traction code
+STEERING_OFFSET   = 1  # Byte offset of the steering angle
+COMMAND_SIZE      = 2  # Mandatory part of every packet
+PROBE_OFFSET      = 2  # Optional probe token starts here
+PROBE_MAX         = 16  # Longest probe token accepted
+PACKET_MAX        = 18  # COMMAND_SIZE + PROBE_MAX (receive buffers)
+TRACTION_COAST    = 0  # Release throttle (inertia)
+TRACTION_BRAKE    = 1  # Active brake
+TRACTION_PWM_MIN  = 2  # Lowest forward PWM code
+STEERING_MAX      = 180  # Highest servo angle
+STEERING_STRAIGHT = 90  # Nominal straight-ahead angle (before calibration)
+
+
+def encode(traction, steering, probe=b""):
+    """
+    Builds one control packet (same rules as ControlProtocol::encode).
+    :param traction: 0=Coast, 1=Brake, 2-255=PWM forward.
+    :param steering: Servo angle (0-180).
+    :param probe: Optional token echoed back by the rover (max PROBE_MAX bytes).
+    :return: bytes ready for sendto() / a WebSocket binary frame.
+    """
+    if not (0 <= traction <= 255 and 0 <= steering <= 255):
+        raise ValueError(f"command out of byte range: {traction}, {steering}")
+    if len(probe) > PROBE_MAX:
+        raise ValueError(f"probe token too long: {len(probe)} > {PROBE_MAX}")
+    packet = bytearray(COMMAND_SIZE)
+    packet[TRACTION_OFFSET] = traction
+    packet[STEERING_OFFSET] = steering
+    return bytes(packet) + bytes(probe)
+
+
+def decode(data):
+    """
+    Splits one packet (same rules as ControlProtocol::PacketView).
+    :return: (traction, steering, probe) or None if shorter than COMMAND_SIZE.
+    """
+    if len(data) < COMMAND_SIZE:
+        return None
+    return data[TRACTION_OFFSET], data[STEERING_OFFSET], bytes(data[PROBE_OFFSET:])
@@ -4,17 +4,31 @@ VideoStream.py
 Module responsible for asynchronous video reception.
 Uses threading to prevent blocking the main loop caused by 
 network latency or OpenCV decoding overhead.
+
+HTTP streams use the native receiver (modules/MjpegReceiver.py) when its
+library is built: newest-frame-only decoding and zero-copy frames. Otherwise,
+and for local cameras, OpenCV's VideoCapture is used.
 """
 
 import cv2
 import threading
 
+from modules import MjpegReceiver
+
 class VideoStream:
     def __init__(self, src=0):
         """
         Initializes the video stream.
         :param src: Video URL (e.g., http://192.168.4.1/stream) or local camera ID (0).
         """
+        self.native = None
+        self.stopped = False
+        if MjpegReceiver.available and isinstance(src, str) and src.startswith("http://"):
+            # Own thread and triple buffer: nothing to poll here
+            self.native = MjpegReceiver.MjpegReceiver(src)
+            print("[VIDEO] Native MJPEG receiver (newest frame only)")
+            return
+
         self.stream = cv2.VideoCapture(src)
 
         # Limit internal buffer to 1 frame.
@@ -24,10 +38,11 @@ class VideoStream:
 
         # Read the first frame to ensure connection is established
         (self.grabbed, self.frame) = self.stream.read()
-        self.stopped = False
 
     def start(self):
         """Starts the capture thread in the background."""
+        if self.native:
+            return self
         t = threading.Thread(target=self.update, args=())
         t.daemon = True # Kills thread automatically if main program exits
         t.start()
@@ -43,10 +58,18 @@ class VideoStream:
                 (self.grabbed, self.frame) = self.stream.read()
 
     def read(self):
-        """Returns the most recent available frame."""
+        """
+        Returns the most recent available frame.
+        Native receiver: a view valid until the next read() (copy to keep it).
+        """
+        if self.native:
+            return self.native.read()
         return self.frame
 
     def stop(self):
         """Releases the camera resource and stops the thread."""
         self.stopped = True
-        self.stream.release()
\ No newline at end of file
+        if self.native:
+            self.native.stop()
+        else:
+            self.stream.release()
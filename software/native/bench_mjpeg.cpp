@@ -0,0 +1,435 @@
+/**
+ * @file bench_mjpeg.cpp
+ * @brief Host Benchmark - Frame Age of the MJPEG Receiver vs In-Order Decoding.
+ * @author Alejandro Moyano (@AleSMC)
+ *
+ * @details
+ * Starts a local stand-in for the rover's '/stream' (same response header,
+ * boundary and part headers as CameraServer.cpp, synthetic SVGA JPEGs at a
+ * fixed rate, small send buffer like lwIP) and measures, for a consumer that
+ * needs WORK_MS per displayed frame, how old each displayed frame is:
+ *
+ * - in-order:    read and decode every part in sequence, then work (the
+ *                'cap.read()' pattern). When work + decode exceed the frame
+ *                period the backlog queues in the socket buffers.
+ * - newest-only: mjpeg_receiver (drain, decode the last part, triple buffer).
+ *                Age stays around one frame period + one decode.
+ *
+ * Frame age = display time - time the server started sending that part.
+ *
+ * mode,shown,age_p50_ms,age_p99_ms,age_max_ms,received,decoded,skipped
+ *
+ * =================================================================================
+ * @section execution Build & Run (Host, Linux/macOS with libjpeg-turbo)
+ * =================================================================================
+ *
+ * 1. BUILD (From 'software/'):
+ * $ g++ -O2 -std=c++11 -pthread native/bench_mjpeg.cpp native/mjpeg_receiver.cpp -ljpeg -o bench_mjpeg
+ *
+ * 2. RUN: ./bench_mjpeg [fps] [work_ms] [seconds]   (defaults: 25 50 10)
+ *
+ * 3. VERIFICATION:
+ * - newest-only: p99 below ~2 frame periods whatever work_ms is. Frames the
+ *   consumer was too slow to show cost one decode each (received - shown);
+ *   parts arriving faster than they decode (burst, high fps) are 'skipped',
+ *   never decoded at all (try fps 400).
+ * - in-order: age of several hundred ms with the defaults, bounded only by
+ *   the socket buffers (the server stalls once they are full).
+ * - With work_ms below the period both modes show every frame.
+ * =================================================================================
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <jpeglib.h>
+#include "mjpeg_receiver.h"
+
+// Same strings as firmware/lib/CameraServer/CameraServer.cpp
+#define PART_BOUNDARY "123456789000000000000987654321"
+static const char *STREAM_HEADER = "HTTP/1.1 200 OK\r\n"
+                                   "Content-Type: multipart/x-mixed-replace;boundary=" PART_BOUNDARY "\r\n"
+                                   "Cache-Control: no-cache\r\n"
+                                   "Connection: close\r\n\r\n";
+static const char *STREAM_BOUNDARY = "\r\n--" PART_BOUNDARY "\r\n";
+static const char *STREAM_PART = "Content-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n";
+
+const int WIDTH = 800;           ///< SVGA (config.h CAMERA_MAX_FRAMESIZE)
+const int HEIGHT = 600;
+const int QUALITY = 80;          ///< libjpeg scale (~ sensor quality 10-12)
+const int VARIANTS = 16;         ///< Distinct pre-encoded frames
+const int SERVER_SNDBUF = 16384; ///< Close to the rover's lwIP TCP send window
+const int MAX_PARTS = 1 << 16;
+
+typedef std::chrono::steady_clock Clock;
+
+static std::atomic<int64_t> g_sendNs[MAX_PARTS]; ///< Per part: server send start
+static std::atomic<bool> g_serverStop{false};
+
+static int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// =============================================================================
+// SYNTHETIC FRAMES
+// =============================================================================
+
+/**
+ * @brief Textured floor with a moving block (realistic JPEG size, not a flat image).
+ */
+static std::vector<uint8_t> makeJpeg(int variant)
+{
+    std::vector<uint8_t> rgb((size_t)WIDTH * HEIGHT * 3);
+    unsigned seed = 1234 + variant;
+    for (int y = 0; y < HEIGHT; y++)
+    {
+        for (int x = 0; x < WIDTH; x++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            int noise = (seed >> 16) & 7;
+            int block = (x / 40 + variant) % 8 == 0 && y > HEIGHT / 3 ? 80 : 0;
+            uint8_t *p = &rgb[((size_t)y * WIDTH + x) * 3];
+            p[0] = (uint8_t)(60 + y / 5 + noise + block);
+            p[1] = (uint8_t)(90 + ((x + y) & 63) + noise);
+            p[2] = (uint8_t)(120 + x / 10 + noise - block / 2);
+        }
+    }
+
+    jpeg_compress_struct c;
+    jpeg_error_mgr err;
+    c.err = jpeg_std_error(&err);
+    jpeg_create_compress(&c);
+    unsigned char *out = NULL;
+    unsigned long outSize = 0;
+    jpeg_mem_dest(&c, &out, &outSize);
+    c.image_width = WIDTH;
+    c.image_height = HEIGHT;
+    c.input_components = 3;
+    c.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&c);
+    jpeg_set_quality(&c, QUALITY, TRUE);
+    jpeg_start_compress(&c, TRUE);
+    while (c.next_scanline < c.image_height)
+    {
+        JSAMPROW row = &rgb[(size_t)c.next_scanline * WIDTH * 3];
+        jpeg_write_scanlines(&c, &row, 1);
+    }
+    jpeg_finish_compress(&c);
+    std::vector<uint8_t> jpg(out, out + outSize);
+    jpeg_destroy_compress(&c);
+    free(out);
+    return jpg;
+}
+
+// =============================================================================
+// STAND-IN SERVER
+// =============================================================================
+
+static bool sendAll(int sock, const void *data, size_t len)
+{
+    const char *p = (const char *)data;
+    while (len > 0)
+    {
+        ssize_t n = send(sock, p, len, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief Serves one client at a time until g_serverStop.
+ */
+static void serverLoop(int listener, int fps, const std::vector<std::vector<uint8_t>> *frames)
+{
+    const auto period = std::chrono::microseconds(1000000 / fps);
+    while (!g_serverStop)
+    {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0)
+            break;
+        int sndbuf = SERVER_SNDBUF;
+        setsockopt(client, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+        // Request (content ignored, like the rover's single route)
+        char req[1024];
+        if (recv(client, req, sizeof(req), 0) <= 0 || !sendAll(client, STREAM_HEADER, strlen(STREAM_HEADER)))
+        {
+            close(client);
+            continue;
+        }
+
+        Clock::time_point next = Clock::now();
+        for (int seq = 1; seq < MAX_PARTS && !g_serverStop; seq++)
+        {
+            const std::vector<uint8_t> &jpg = (*frames)[seq % frames->size()];
+            char part[128];
+            int len = snprintf(part, sizeof(part), STREAM_PART, (unsigned)jpg.size());
+            g_sendNs[seq] = nowNs();
+            if (!sendAll(client, STREAM_BOUNDARY, strlen(STREAM_BOUNDARY)) ||
+                !sendAll(client, part, len) ||
+                !sendAll(client, jpg.data(), jpg.size()))
+                break;
+
+            // Camera pace; a blocked send() (full buffers) delays the next capture, as on the rover
+            next += period;
+            if (next > Clock::now())
+                std::this_thread::sleep_until(next);
+            else
+                next = Clock::now();
+        }
+        close(client);
+    }
+}
+
+// =============================================================================
+// IN-ORDER BASELINE
+// =============================================================================
+
+/**
+ * @brief Minimal blocking reader: every part, in order.
+ */
+struct InOrderReader
+{
+    int sock;
+    std::vector<uint8_t> buf;
+    size_t start = 0, end = 0;
+
+    bool fill()
+    {
+        if (start > 0)
+        {
+            memmove(buf.data(), buf.data() + start, end - start);
+            end -= start;
+            start = 0;
+        }
+        if (buf.size() - end < 65536)
+            buf.resize(end + 65536);
+        ssize_t n = recv(sock, buf.data() + end, buf.size() - end, 0);
+        if (n <= 0)
+            return false;
+        end += n;
+        return true;
+    }
+
+    /** @brief Skips to the end of the next "\r\n\r\n" (HTTP or part header); returns its text. */
+    bool header(std::string &out)
+    {
+        for (;;)
+        {
+            std::string window((const char *)buf.data() + start, end - start);
+            size_t at = window.find("\r\n\r\n");
+            if (at != std::string::npos)
+            {
+                out = window.substr(0, at);
+                start += at + 4;
+                return true;
+            }
+            if (!fill())
+                return false;
+        }
+    }
+
+    bool body(size_t len, std::vector<uint8_t> &out)
+    {
+        while (end - start < len)
+            if (!fill())
+                return false;
+        out.assign(buf.begin() + start, buf.begin() + start + len);
+        start += len;
+        return true;
+    }
+};
+
+static bool decodeBgr(const std::vector<uint8_t> &jpg, std::vector<uint8_t> &pixels)
+{
+    jpeg_decompress_struct d;
+    jpeg_error_mgr err;
+    d.err = jpeg_std_error(&err);
+    jpeg_create_decompress(&d);
+    jpeg_mem_src(&d, jpg.data(), jpg.size());
+    jpeg_read_header(&d, TRUE);
+#ifdef JCS_EXTENSIONS
+    d.out_color_space = JCS_EXT_BGR;
+#endif
+    jpeg_start_decompress(&d);
+    pixels.resize((size_t)d.output_width * d.output_height * 3);
+    while (d.output_scanline < d.output_height)
+    {
+        JSAMPROW row = &pixels[(size_t)d.output_scanline * d.output_width * 3];
+        jpeg_read_scanlines(&d, &row, 1);
+    }
+    jpeg_finish_decompress(&d);
+    jpeg_destroy_decompress(&d);
+    return true;
+}
+
+// =============================================================================
+// MEASUREMENT
+// =============================================================================
+
+static void report(const char *mode, std::vector<double> &ages, uint64_t received, uint64_t decoded, uint64_t skipped)
+{
+    if (ages.empty())
+    {
+        printf("%s,0,,,,%llu,%llu,%llu\n", mode, (unsigned long long)received,
+               (unsigned long long)decoded, (unsigned long long)skipped);
+        return;
+    }
+    std::sort(ages.begin(), ages.end());
+    double p50 = ages[ages.size() / 2];
+    double p99 = ages[std::min(ages.size() - 1, ages.size() * 99 / 100)];
+    printf("%s,%zu,%.1f,%.1f,%.1f,%llu,%llu,%llu\n", mode, ages.size(), p50, p99, ages.back(),
+           (unsigned long long)received, (unsigned long long)decoded, (unsigned long long)skipped);
+}
+
+static int connectLocal(int port)
+{
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(sock, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static void runInOrder(int port, int workMs, int seconds)
+{
+    int sock = connectLocal(port);
+    const char *req = "GET /stream HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    if (sock < 0 || !sendAll(sock, req, strlen(req)))
+    {
+        fprintf(stderr, "[BENCH] in-order: connect failed\n");
+        return;
+    }
+
+    InOrderReader rd;
+    rd.sock = sock;
+    std::string head;
+    std::vector<uint8_t> jpg, pixels;
+    std::vector<double> ages;
+    uint64_t seq = 0;
+    rd.header(head); // HTTP response
+
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(seconds);
+    while (Clock::now() < deadline && rd.header(head))
+    {
+        size_t at = head.find("Content-Length: ");
+        if (at == std::string::npos || !rd.body(strtoul(head.c_str() + at + 16, NULL, 10), jpg))
+            break;
+        decodeBgr(jpg, pixels);
+        seq++;
+        ages.push_back((nowNs() - g_sendNs[seq]) / 1e6);
+        std::this_thread::sleep_for(std::chrono::milliseconds(workMs));
+    }
+    close(sock);
+    report("in-order", ages, seq, seq, 0);
+}
+
+static void runNewestOnly(int port, int workMs, int seconds)
+{
+    MjpegReceiver *rx = mjpeg_open("127.0.0.1", port, "/stream", 2000);
+    if (!rx)
+    {
+        fprintf(stderr, "[BENCH] newest-only: mjpeg_open failed\n");
+        return;
+    }
+
+    std::vector<double> ages;
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(seconds);
+    while (Clock::now() < deadline)
+    {
+        const uint8_t *data;
+        int w, h;
+        uint64_t seq;
+        if (mjpeg_acquire(rx, &data, &w, &h, &seq) == 1)
+        {
+            ages.push_back((nowNs() - g_sendNs[seq]) / 1e6);
+            std::this_thread::sleep_for(std::chrono::milliseconds(workMs));
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Poll (display loop)
+        }
+    }
+
+    MjpegStats st;
+    mjpeg_stats(rx, &st);
+    mjpeg_close(rx);
+    report("newest-only", ages, st.received, st.decoded, st.skipped);
+    fprintf(stderr, "[BENCH] newest-only: last decode %u us, part -> published %u us, corrupt %llu\n",
+            st.lastDecodeUs, st.lastPublishUs, (unsigned long long)st.corrupt);
+}
+
+int main(int argc, char **argv)
+{
+    int fps = argc > 1 ? atoi(argv[1]) : 25;
+    int workMs = argc > 2 ? atoi(argv[2]) : 50;
+    int seconds = argc > 3 ? atoi(argv[3]) : 10;
+    if (fps <= 0 || workMs < 0 || seconds <= 0)
+    {
+        fprintf(stderr, "usage: %s [fps] [work_ms] [seconds]\n", argv[0]);
+        return 1;
+    }
+
+    // 1. FRAMES
+    std::vector<std::vector<uint8_t>> frames;
+    size_t total = 0;
+    for (int i = 0; i < VARIANTS; i++)
+    {
+        frames.push_back(makeJpeg(i));
+        total += frames.back().size();
+    }
+    fprintf(stderr, "[BENCH] %dx%d JPEG ~%zu B, %d fps, consumer %d ms/frame, %d s per mode\n",
+            WIDTH, HEIGHT, total / VARIANTS, fps, workMs, seconds);
+
+    // 2. SERVER (127.0.0.1, ephemeral port)
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    if (bind(listener, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listener, 1) != 0 ||
+        getsockname(listener, (sockaddr *)&addr, &addrLen) != 0)
+    {
+        perror("[BENCH] listen");
+        return 1;
+    }
+    int port = ntohs(addr.sin_port);
+    std::thread server(serverLoop, listener, fps, &frames);
+
+    // 3. MODES (one connection each, part numbering restarts at 1)
+    printf("mode,shown,age_p50_ms,age_p99_ms,age_max_ms,received,decoded,skipped\n");
+    runInOrder(port, workMs, seconds);
+    runNewestOnly(port, workMs, seconds);
+
+    g_serverStop = true;
+    shutdown(listener, SHUT_RDWR);
+    close(listener);
+    server.join();
+    return 0;
+}
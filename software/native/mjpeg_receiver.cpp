@@ -0,0 +1,483 @@
+/**
+ * @file mjpeg_receiver.cpp
+ * @brief Incremental Multipart Parser, Newest-Only Decode and Triple Buffer.
+ * @author Alejandro Moyano (@AleSMC)
+ */
+
+#include "mjpeg_receiver.h"
+
+#include <atomic>
+#include <chrono>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <jpeglib.h>
+
+// Firmware default (CameraServer.cpp PART_BOUNDARY), used if the response
+// header does not name one.
+static const char *DEFAULT_BOUNDARY = "123456789000000000000987654321";
+
+static const size_t RX_CHUNK = 64 * 1024;         ///< Bytes requested per recv()
+static const size_t HEADER_MAX = 4096;            ///< Longest HTTP/part header accepted
+static const size_t FRAME_MAX = 8 * 1024 * 1024;  ///< Larger Content-Length = corrupt stream
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief libjpeg error manager: longjmp back instead of exit().
+ */
+struct JpegError
+{
+    jpeg_error_mgr mgr;
+    jmp_buf jump;
+};
+
+static void onJpegError(j_common_ptr cinfo)
+{
+    longjmp(((JpegError *)cinfo->err)->jump, 1);
+}
+
+static void onJpegMessage(j_common_ptr)
+{
+    // Silenced: corrupt frames are counted, not printed per frame
+}
+
+/**
+ * @brief One decoded frame (owned by exactly one of back / ready / held).
+ */
+struct Frame
+{
+    std::vector<uint8_t> pixels; ///< BGR, row-major
+    int width = 0;
+    int height = 0;
+    uint64_t seq = 0;
+};
+
+struct MjpegReceiver
+{
+    int sock = -1;
+    std::thread thread;
+    std::atomic<bool> stop{false};
+
+    // --- PARSER (receiver thread only) ---
+    enum State
+    {
+        FIND_BOUNDARY, ///< Looking for "--<boundary>" (start or resync)
+        PART_HEADER,   ///< Reading "Content-Type/Content-Length" lines
+        BODY           ///< Copying Content-Length bytes
+    } state = FIND_BOUNDARY;
+    std::string boundary;              ///< "--" + boundary
+    std::vector<uint8_t> rx;           ///< Receive window [rxStart, rxEnd)
+    size_t rxStart = 0;
+    size_t rxEnd = 0;
+    size_t bodyLen = 0;                ///< Content-Length of the current part
+    std::vector<uint8_t> assembling;   ///< Part being received
+    std::vector<uint8_t> newest;       ///< Last complete part, not yet decoded
+    bool haveNewest = false;
+    uint64_t partSeq = 0;              ///< Parts completed so far
+    uint64_t newestSeq = 0;
+    Clock::time_point newestDone;      ///< When 'newest' completed
+
+    // --- DECODER (receiver thread only) ---
+    jpeg_decompress_struct cinfo;
+    JpegError jerr;
+    std::vector<JSAMPROW> rows;
+
+    // --- TRIPLE BUFFER (swaps under 'lock') ---
+    std::mutex lock;
+    Frame frames[3];
+    int back = 0;       ///< Decoder writes here
+    int ready = 1;      ///< Latest published frame
+    int held = 2;       ///< Owned by the reader (mjpeg_acquire)
+    bool fresh = false; ///< 'ready' newer than 'held'
+
+    // --- COUNTERS ---
+    std::atomic<uint64_t> received{0}, decoded{0}, skipped{0}, corrupt{0}, bytes{0};
+    std::atomic<uint32_t> lastDecodeUs{0}, lastPublishUs{0};
+    std::atomic<int32_t> connected{0};
+};
+
+// =============================================================================
+// PARSER
+// =============================================================================
+
+/**
+ * @brief Position of 'needle' in the receive window, or -1.
+ */
+static long findInWindow(const MjpegReceiver *rx, const char *needle, size_t len)
+{
+    const uint8_t *begin = rx->rx.data() + rx->rxStart;
+    size_t avail = rx->rxEnd - rx->rxStart;
+    if (avail < len)
+        return -1;
+    for (size_t i = 0; i + len <= avail; i++)
+    {
+        if (begin[i] == (uint8_t)needle[0] && memcmp(begin + i, needle, len) == 0)
+            return (long)i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Case-insensitive header value lookup inside [begin, begin + len).
+ * @return Pointer to the first character of the value, or NULL.
+ */
+static const char *findHeader(const char *begin, size_t len, const char *name)
+{
+    size_t n = strlen(name);
+    for (size_t i = 0; i + n <= len; i++)
+    {
+        if (strncasecmp(begin + i, name, n) == 0)
+        {
+            const char *v = begin + i + n;
+            while (v < begin + len && (*v == ' ' || *v == '\t'))
+                v++;
+            return v;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Consumes as many complete parser steps as the window allows.
+ */
+static void parse(MjpegReceiver *rx)
+{
+    while (rx->rxEnd > rx->rxStart)
+    {
+        size_t avail = rx->rxEnd - rx->rxStart;
+        const uint8_t *data = rx->rx.data() + rx->rxStart;
+
+        if (rx->state == MjpegReceiver::FIND_BOUNDARY)
+        {
+            long at = findInWindow(rx, rx->boundary.data(), rx->boundary.size());
+            if (at < 0)
+            {
+                // Keep a possible partial boundary at the end of the window
+                size_t keep = rx->boundary.size() - 1;
+                if (avail > keep)
+                    rx->rxStart = rx->rxEnd - keep;
+                return;
+            }
+            rx->rxStart += at + rx->boundary.size();
+            rx->state = MjpegReceiver::PART_HEADER;
+        }
+        else if (rx->state == MjpegReceiver::PART_HEADER)
+        {
+            // Remainder of the boundary line + headers, up to the blank line
+            long end = findInWindow(rx, "\r\n\r\n", 4);
+            if (end < 0)
+            {
+                if (avail > HEADER_MAX)
+                {
+                    rx->corrupt++;
+                    rx->state = MjpegReceiver::FIND_BOUNDARY;
+                    continue;
+                }
+                return;
+            }
+            const char *len = findHeader((const char *)data, end, "content-length:");
+            long n = len ? strtol(len, NULL, 10) : -1;
+            rx->rxStart += end + 4;
+            if (n <= 0 || (size_t)n > FRAME_MAX)
+            {
+                rx->corrupt++;
+                rx->state = MjpegReceiver::FIND_BOUNDARY;
+                continue;
+            }
+            rx->bodyLen = (size_t)n;
+            rx->assembling.clear();
+            rx->state = MjpegReceiver::BODY;
+        }
+        else // BODY
+        {
+            size_t take = rx->bodyLen - rx->assembling.size();
+            if (take > avail)
+                take = avail;
+            rx->assembling.insert(rx->assembling.end(), data, data + take);
+            rx->rxStart += take;
+
+            if (rx->assembling.size() == rx->bodyLen)
+            {
+                // Complete part: it supersedes any part that was never decoded
+                if (rx->haveNewest)
+                    rx->skipped++;
+                rx->newest.swap(rx->assembling);
+                rx->haveNewest = true;
+                rx->newestSeq = ++rx->partSeq;
+                rx->newestDone = Clock::now();
+                rx->received++;
+                rx->state = MjpegReceiver::FIND_BOUNDARY;
+            }
+        }
+    }
+}
+
+// =============================================================================
+// DECODER
+// =============================================================================
+
+/**
+ * @brief Decodes 'newest' into the back buffer and publishes it.
+ */
+static void decodeNewest(MjpegReceiver *rx)
+{
+    Clock::time_point t0 = Clock::now();
+    Frame &out = rx->frames[rx->back];
+    rx->haveNewest = false;
+
+    jpeg_decompress_struct *cinfo = &rx->cinfo;
+    if (setjmp(rx->jerr.jump))
+    {
+        jpeg_abort_decompress(cinfo);
+        rx->corrupt++;
+        return;
+    }
+
+    jpeg_mem_src(cinfo, rx->newest.data(), (unsigned long)rx->newest.size());
+    jpeg_read_header(cinfo, TRUE);
+#ifdef JCS_EXTENSIONS
+    cinfo->out_color_space = JCS_EXT_BGR; // OpenCV order, no swap pass
+#else
+    cinfo->out_color_space = JCS_RGB;
+#endif
+    // Speed over the last bit of quality: this image is for piloting
+    cinfo->dct_method = JDCT_IFAST;
+    cinfo->do_fancy_upsampling = FALSE;
+    jpeg_start_decompress(cinfo);
+
+    int w = cinfo->output_width;
+    int h = cinfo->output_height;
+    out.pixels.resize((size_t)w * h * 3); // No-op once the size is known
+    out.width = w;
+    out.height = h;
+    out.seq = rx->newestSeq;
+
+    rx->rows.resize(h);
+    for (int y = 0; y < h; y++)
+        rx->rows[y] = out.pixels.data() + (size_t)y * w * 3;
+    while (cinfo->output_scanline < cinfo->output_height)
+        jpeg_read_scanlines(cinfo, rx->rows.data() + cinfo->output_scanline, cinfo->output_height - cinfo->output_scanline);
+    jpeg_finish_decompress(cinfo);
+
+#ifndef JCS_EXTENSIONS
+    for (size_t i = 0; i < out.pixels.size(); i += 3)
+        std::swap(out.pixels[i], out.pixels[i + 2]);
+#endif
+
+    Clock::time_point t1 = Clock::now();
+    {
+        std::lock_guard<std::mutex> guard(rx->lock);
+        std::swap(rx->back, rx->ready);
+        rx->fresh = true;
+    }
+    rx->decoded++;
+    rx->lastDecodeUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    rx->lastPublishUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(t1 - rx->newestDone).count();
+}
+
+// =============================================================================
+// RECEIVER THREAD
+// =============================================================================
+
+/**
+ * @brief true if more stream bytes are already waiting in the kernel.
+ */
+static bool moreQueued(int sock)
+{
+    pollfd p = {sock, POLLIN, 0};
+    return poll(&p, 1, 0) > 0 && (p.revents & POLLIN);
+}
+
+static void receiverLoop(MjpegReceiver *rx)
+{
+    while (!rx->stop)
+    {
+        // 1. RECEIVE (window compacted, grown only for oversized frames)
+        if (rx->rxStart > 0)
+        {
+            memmove(rx->rx.data(), rx->rx.data() + rx->rxStart, rx->rxEnd - rx->rxStart);
+            rx->rxEnd -= rx->rxStart;
+            rx->rxStart = 0;
+        }
+        if (rx->rx.size() - rx->rxEnd < RX_CHUNK)
+            rx->rx.resize(rx->rxEnd + RX_CHUNK);
+
+        ssize_t n = recv(rx->sock, rx->rx.data() + rx->rxEnd, rx->rx.size() - rx->rxEnd, 0);
+        if (n <= 0)
+            break; // Closed, timed out (SO_RCVTIMEO) or shut down by mjpeg_close()
+        rx->rxEnd += n;
+        rx->bytes += n;
+
+        // 2. PARSE everything received so far
+        parse(rx);
+
+        // 3. DECODE only the newest part, once the backlog is drained
+        if (rx->haveNewest && !moreQueued(rx->sock))
+            decodeNewest(rx);
+    }
+
+    // A last complete part is still worth showing
+    if (rx->haveNewest && !rx->stop)
+        decodeNewest(rx);
+    rx->connected = 0;
+}
+
+// =============================================================================
+// C API
+// =============================================================================
+
+/**
+ * @brief Blocking TCP connect with the receive timeout applied.
+ */
+static int connectTo(const char *host, int port, int timeoutMs)
+{
+    char service[8];
+    snprintf(service, sizeof(service), "%d", port);
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *res = NULL;
+    if (getaddrinfo(host, service, &hints, &res) != 0 || !res)
+        return -1;
+
+    int sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (sock >= 0)
+    {
+        timeval tv = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+        setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)); // Bounds connect() too (Linux)
+        if (connect(sock, res->ai_addr, res->ai_addrlen) != 0)
+        {
+            close(sock);
+            sock = -1;
+        }
+    }
+    freeaddrinfo(res);
+    return sock;
+}
+
+MjpegReceiver *mjpeg_open(const char *host, int port, const char *path, int timeoutMs)
+{
+    int sock = connectTo(host, port, timeoutMs);
+    if (sock < 0)
+        return NULL;
+
+    // 1. REQUEST
+    char req[512];
+    int len = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n", path, host);
+    if (len <= 0 || len >= (int)sizeof(req) || send(sock, req, len, 0) != len)
+    {
+        close(sock);
+        return NULL;
+    }
+
+    MjpegReceiver *rx = new MjpegReceiver();
+    rx->sock = sock;
+    rx->rx.resize(RX_CHUNK);
+
+    // 2. RESPONSE HEADER (synchronous: a wrong path fails here, not silently later)
+    long end = -1;
+    while ((end = findInWindow(rx, "\r\n\r\n", 4)) < 0 && rx->rxEnd < HEADER_MAX)
+    {
+        ssize_t n = recv(sock, rx->rx.data() + rx->rxEnd, rx->rx.size() - rx->rxEnd, 0);
+        if (n <= 0)
+            break;
+        rx->rxEnd += n;
+        rx->bytes += n;
+    }
+    const char *head = (const char *)rx->rx.data();
+    if (end < 0 || strncmp(head, "HTTP/1.", 7) != 0 || end < 12 || strncmp(head + 9, "200", 3) != 0)
+    {
+        close(sock);
+        delete rx;
+        return NULL;
+    }
+
+    // Boundary as announced by the server (firmware: PART_BOUNDARY)
+    const char *b = findHeader(head, end, "boundary=");
+    std::string boundary = DEFAULT_BOUNDARY;
+    if (b)
+    {
+        const char *e = b;
+        while (e < head + end && *e != '\r' && *e != ';' && *e != ' ')
+            e++;
+        boundary.assign(b, e - b);
+    }
+    rx->boundary = "--" + boundary;
+    rx->rxStart = end + 4;
+
+    // 3. DECODER (created once, reused for every frame)
+    rx->cinfo.err = jpeg_std_error(&rx->jerr.mgr);
+    rx->jerr.mgr.error_exit = onJpegError;
+    rx->jerr.mgr.output_message = onJpegMessage;
+    jpeg_create_decompress(&rx->cinfo);
+
+    rx->connected = 1;
+    rx->thread = std::thread(receiverLoop, rx);
+    return rx;
+}
+
+int mjpeg_acquire(MjpegReceiver *rx, const uint8_t **data, int *width, int *height, uint64_t *seq)
+{
+    int result;
+    {
+        std::lock_guard<std::mutex> guard(rx->lock);
+        if (rx->fresh)
+        {
+            std::swap(rx->held, rx->ready);
+            rx->fresh = false;
+            result = 1;
+        }
+        else
+        {
+            result = rx->frames[rx->held].seq ? 0 : -1;
+        }
+    }
+
+    // 'held' belongs to the reader: no lock needed to read it
+    const Frame &f = rx->frames[rx->held];
+    *data = f.seq ? f.pixels.data() : NULL;
+    *width = f.width;
+    *height = f.height;
+    *seq = f.seq;
+    return result;
+}
+
+void mjpeg_stats(MjpegReceiver *rx, MjpegStats *out)
+{
+    out->received = rx->received;
+    out->decoded = rx->decoded;
+    out->skipped = rx->skipped;
+    out->corrupt = rx->corrupt;
+    out->bytes = rx->bytes;
+    out->lastDecodeUs = rx->lastDecodeUs;
+    out->lastPublishUs = rx->lastPublishUs;
+    out->connected = rx->connected;
+}
+
+void mjpeg_close(MjpegReceiver *rx)
+{
+    if (!rx)
+        return;
+    rx->stop = true;
+    shutdown(rx->sock, SHUT_RDWR); // Unblocks recv()
+    if (rx->thread.joinable())
+        rx->thread.join();
+    close(rx->sock);
+    jpeg_destroy_decompress(&rx->cinfo);
+    delete rx;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file mjpeg_receiver.h
+ * @brief Low-Latency MJPEG Receiver (Pilot Client, Host Side).
+ * @author Alejandro Moyano (@AleSMC)
+ *
+ * @details
+ * Receives the rover's '/stream' (multipart/x-mixed-replace, boundary
+ * PART_BOUNDARY of firmware/lib/CameraServer/CameraServer.cpp) on a plain TCP
+ * socket and keeps only what the pilot needs: the NEWEST frame.
+ *
+ * - Incremental parser: boundary line, part headers (Content-Length), body.
+ *   No per-frame allocation once the buffers have grown to the frame size.
+ * - Newest-only decode: the socket is drained first; of all the JPEGs that
+ *   completed meanwhile, only the last one is decoded (libjpeg-turbo, BGR).
+ *   Older ones are counted as skipped, never decoded.
+ * - Triple buffer: the receiver thread decodes into a back buffer and
+ *   publishes it; the reader holds its own buffer, so acquiring a frame is a
+ *   pointer swap (zero-copy for the numpy view in modules/MjpegReceiver.py).
+ *
+ * C API (ctypes-friendly, no C++ types across the boundary).
+ *
+ * =================================================================================
+ * @section build Build (Linux/macOS, libjpeg-turbo)
+ * =================================================================================
+ * From 'software/':
+ * $ g++ -O2 -std=c++11 -shared -fPIC -pthread native/mjpeg_receiver.cpp -ljpeg -o native/libmjpeg_receiver.so
+ * (macOS: '-o native/libmjpeg_receiver.dylib', add '-I/opt/homebrew/include -L/opt/homebrew/lib')
+ * =================================================================================
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /** @brief Opaque receiver handle. */
+    typedef struct MjpegReceiver MjpegReceiver;
+
+    /**
+     * @brief Counters since mjpeg_open() (plain struct: mirrored by ctypes).
+     */
+    typedef struct
+    {
+        uint64_t received;      ///< Complete JPEG parts parsed
+        uint64_t decoded;       ///< Parts decoded and published
+        uint64_t skipped;       ///< Parts superseded before decoding (never decoded)
+        uint64_t corrupt;       ///< Parts the decoder rejected
+        uint64_t bytes;         ///< Stream bytes received (headers included)
+        uint32_t lastDecodeUs;  ///< Decode time of the last published frame
+        uint32_t lastPublishUs; ///< Last part completed -> published (decode + wait)
+        int32_t connected;      ///< 1 while the stream is open
+    } MjpegStats;
+
+    /**
+     * @brief Connects and starts the receiver thread.
+     * @param host IPv4 address or host name.
+     * @param port HTTP port.
+     * @param path Stream path (e.g. "/stream").
+     * @param timeoutMs Connect/receive timeout (the thread exits on a silent link).
+     * @return Handle, or NULL if the connection or the HTTP request failed.
+     */
+    MjpegReceiver *mjpeg_open(const char *host, int port, const char *path, int timeoutMs);
+
+    /**
+     * @brief Hands the newest decoded frame to the caller (zero-copy).
+     * @param rx Handle.
+     * @param data Out: BGR pixels (height x width x 3, row-major). Owned by the
+     * receiver and valid until the next mjpeg_acquire() or mjpeg_close().
+     * @param width Out: frame width.
+     * @param height Out: frame height.
+     * @param seq Out: stream position of the frame (1 = first part received).
+     * @return 1 = new frame since the last call, 0 = same frame as before,
+     * -1 = no frame yet (or the stream ended before the first one).
+     */
+    int mjpeg_acquire(MjpegReceiver *rx, const uint8_t **data, int *width, int *height, uint64_t *seq);
+
+    /**
+     * @brief Copies the counters.
+     */
+    void mjpeg_stats(MjpegReceiver *rx, MjpegStats *out);
+
+    /**
+     * @brief Stops the thread, closes the socket and frees every buffer.
+     */
+    void mjpeg_close(MjpegReceiver *rx);
+
+#ifdef __cplusplus
+}
+#endif
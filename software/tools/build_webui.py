@@ -0,0 +1,106 @@
+"""
+build_webui.py
+--------------
+Author: Alejandro Moyano (@AleSMC)
+Description: Builds the LittleFS image contents of the web pilot UI.
+
+Reads 'firmware/web/' and writes gzip-compressed copies to 'firmware/data/'
+(the PlatformIO filesystem directory), which 'pio run -t uploadfs' flashes:
+
+    web/index.html  -> data/index.html.gz   (served at '/')
+    web/ui/<file>   -> data/ui/<file>.gz    (served at '/ui/<file>')
+
+The rover serves these bytes as-is ('Content-Encoding: gzip'); the ETag comes
+from the gzip trailer, so the output is deterministic (no timestamp, no file
+name in the header): an unchanged page keeps its ETag across rebuilds.
+
+The control packet constants are injected into the page from the generated
+'modules/Protocol.py' (placeholder '/*@PROTOCOL@*/'), so the browser encodes
+packets exactly like the firmware decodes them.
+
+Usage (from 'software/'):
+    python -m tools.build_webui
+    cd ../firmware && pio run -t uploadfs
+"""
+
+import argparse
+import gzip
+import json
+import os
+import sys
+
+from modules import Protocol
+
+HERE = os.path.dirname(__file__)
+DEFAULT_SRC = os.path.normpath(os.path.join(HERE, "..", "..", "firmware", "web"))
+DEFAULT_OUT = os.path.normpath(os.path.join(HERE, "..", "..", "firmware", "data"))
+
+PROTOCOL_MARK = b"/*@PROTOCOL@*/ {}"
+TEXT_EXT = (".html", ".js", ".css", ".svg", ".json", ".webmanifest")
+
+# Must match lib/WebUI (WebUI.h Asset fields) and config.h WEBUI_MAX_FILES
+URI_MAX = 31
+MAX_FILES = 8
+
+
+def protocol_json():
+    """Upper-case integer constants of the generated Protocol module."""
+    consts = {k: v for k, v in vars(Protocol).items() if k.isupper() and isinstance(v, int)}
+    return json.dumps(consts, separators=(",", ":")).encode()
+
+
+def compress(data):
+    """gzip -9 with mtime 0 and no file name: same input, same bytes (same ETag)."""
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gzip the web UI into the LittleFS data directory.")
+    parser.add_argument("--src", default=DEFAULT_SRC, help="UI sources (firmware/web)")
+    parser.add_argument("--out", default=DEFAULT_OUT, help="PlatformIO data dir (firmware/data)")
+    args = parser.parse_args()
+
+    files = []
+    for root, _, names in os.walk(args.src):
+        for name in sorted(names):
+            rel = os.path.relpath(os.path.join(root, name), args.src).replace(os.sep, "/")
+            if rel == "index.html" or rel.startswith("ui/") and rel.count("/") == 1:
+                files.append(rel)
+            else:
+                print(f"[WEB] Skipping {rel} (only index.html and ui/<file> are served)")
+
+    if "index.html" not in files:
+        print(f"[WEB] {args.src}/index.html not found")
+        sys.exit(1)
+    if len(files) > MAX_FILES:
+        print(f"[WEB] {len(files)} files > WEBUI_MAX_FILES ({MAX_FILES}): the rover would drop some")
+        sys.exit(1)
+
+    total_raw = total_gz = 0
+    for rel in files:
+        uri = "/" if rel == "index.html" else "/" + rel
+        if len(uri) > URI_MAX:
+            print(f"[WEB] {uri}: name too long (max {URI_MAX} characters)")
+            sys.exit(1)
+
+        with open(os.path.join(args.src, rel), "rb") as f:
+            data = f.read()
+        if rel.endswith(TEXT_EXT) and PROTOCOL_MARK in data:
+            data = data.replace(PROTOCOL_MARK, protocol_json())
+
+        packed = compress(data)
+        dst = os.path.join(args.out, rel + ".gz")
+        os.makedirs(os.path.dirname(dst), exist_ok=True)
+        with open(dst, "wb") as f:
+            f.write(packed)
+
+        total_raw += len(data)
+        total_gz += len(packed)
+        print(f"[WEB] {uri:<24} {len(data):>7} B -> {len(packed):>6} B gzip ({100 * len(packed) / len(data):.0f}%)")
+
+    print(f"[WEB] {len(files)} file(s): {total_raw} B -> {total_gz} B in {args.out}")
+    print("[WEB] Flash with: pio run -t uploadfs (from 'firmware/')")
+
+
+if __name__ == "__main__":
+    main()
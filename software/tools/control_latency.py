@@ -0,0 +1,119 @@
+"""
+control_latency.py
+------------------
+Author: Alejandro Moyano (@AleSMC)
+Description: Control-packet latency probe (QoS A/B test).
+
+Sends neutral control packets (Coast + Center) with an appended probe token.
+The firmware echoes the token once the command has been applied to the
+actuators, so the measured RTT covers: PC -> AP -> Rover -> PWM -> Rover -> PC.
+
+Optionally opens N '/stream' clients to saturate the radio with video, which
+is the scenario where WMM marking (DSCP) makes a difference.
+
+Usage (from 'software/'):
+    python -m tools.control_latency --ip 192.168.4.1 --video 1
+    python -m tools.control_latency --ip 192.168.4.1 --video 1 --dscp 0
+"""
+
+import argparse
+import socket
+import struct
+import threading
+import time
+import urllib.request
+
+from modules import Protocol
+
+# Probe token layout (appended after the 2 control bytes): seq (u32) + t_send (u64 ns)
+PROBE_FMT = "<IQ"
+NEUTRAL_CMD = (Protocol.TRACTION_COAST, Protocol.STEERING_STRAIGHT)  # Coast + Center: safe while measuring
+
+
+def video_sink(url, stop_event, stats, idx):
+    """Downloads the MJPEG stream as fast as possible (load generator)."""
+    try:
+        with urllib.request.urlopen(url, timeout=5) as resp:
+            while not stop_event.is_set():
+                chunk = resp.read(16384)
+                if not chunk:
+                    break
+                stats[idx] += len(chunk)
+    except Exception as e:
+        print(f"[VIDEO {idx}] Closed: {e}")
+
+
+def percentile(sorted_values, p):
+    """Nearest-rank percentile of an already sorted list."""
+    if not sorted_values:
+        return float("nan")
+    k = max(0, min(len(sorted_values) - 1, int(round(p / 100.0 * len(sorted_values))) - 1))
+    return sorted_values[k]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure control-packet latency (probe echo).")
+    parser.add_argument("--ip", default="192.168.4.1", help="Rover IP address")
+    parser.add_argument("--port", type=int, default=9999, help="UDP control port")
+    parser.add_argument("--rate", type=float, default=50.0, help="Probes per second")
+    parser.add_argument("--duration", type=float, default=20.0, help="Test duration (s)")
+    parser.add_argument("--dscp", type=int, default=48, help="DSCP for probes (48=CS6/AC_VO, 0=BE)")
+    parser.add_argument("--video", type=int, default=0, help="Concurrent /stream clients (load)")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_TOS, args.dscp << 2)
+    sock.settimeout(0.05)
+
+    # 1. Video load
+    stop_event = threading.Event()
+    video_bytes = [0] * args.video
+    for i in range(args.video):
+        t = threading.Thread(target=video_sink,
+                             args=(f"http://{args.ip}/stream", stop_event, video_bytes, i),
+                             daemon=True)
+        t.start()
+    if args.video:
+        time.sleep(2.0)  # Let the stream ramp up
+
+    # 2. Probe loop
+    rtts_ms = []
+    sent = 0
+    interval = 1.0 / args.rate
+    t_end = time.monotonic() + args.duration
+    next_send = time.monotonic()
+
+    print(f"[PROBE] {args.ip}:{args.port} | DSCP {args.dscp} | {args.rate:.0f} Hz | "
+          f"{args.video} video client(s)")
+
+    while time.monotonic() < t_end:
+        now = time.monotonic()
+        if now >= next_send:
+            token = struct.pack(PROBE_FMT, sent, time.perf_counter_ns())
+            sock.sendto(Protocol.encode(*NEUTRAL_CMD, probe=token), (args.ip, args.port))
+            sent += 1
+            next_send += interval
+        try:
+            data, _ = sock.recvfrom(64)
+            if len(data) == struct.calcsize(PROBE_FMT):
+                _, t_send = struct.unpack(PROBE_FMT, data)
+                rtts_ms.append((time.perf_counter_ns() - t_send) / 1e6)
+        except socket.timeout:
+            pass
+
+    stop_event.set()
+
+    # 3. Report
+    rtts_ms.sort()
+    lost = sent - len(rtts_ms)
+    print(f"[RESULT] Sent {sent} | Received {len(rtts_ms)} | Lost {lost} "
+          f"({100.0 * lost / max(sent, 1):.1f}%)")
+    print(f"[RESULT] RTT ms: p50 {percentile(rtts_ms, 50):.1f} | p90 {percentile(rtts_ms, 90):.1f} | "
+          f"p99 {percentile(rtts_ms, 99):.1f} | max {rtts_ms[-1] if rtts_ms else float('nan'):.1f}")
+    if args.video:
+        total = sum(video_bytes) * 8 / 1e6 / args.duration
+        print(f"[RESULT] Video load: {total:.2f} Mbit/s")
+
+
+if __name__ == "__main__":
+    main()
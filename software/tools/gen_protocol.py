@@ -0,0 +1,125 @@
+"""
+gen_protocol.py
+---------------
+Author: Alejandro Moyano (@AleSMC)
+Description: Generates 'modules/Protocol.py' from the firmware's control codec.
+
+'firmware/include/control_protocol.h' is the single definition of the control
+packet layout (compiled by the firmware and host C++ tools). This script reads
+its 'constexpr <type> NAME = <integer>;' constants and writes the Python module
+the client and tools encode/decode packets with, so both sides stay in lockstep.
+
+Usage (from 'software/'):
+    python -m tools.gen_protocol          # Regenerate after editing the header
+    python -m tools.gen_protocol --check  # Exit 1 if Protocol.py is stale
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HERE = os.path.dirname(__file__)
+DEFAULT_HEADER = os.path.normpath(os.path.join(HERE, "..", "..", "firmware", "include", "control_protocol.h"))
+DEFAULT_OUTPUT = os.path.normpath(os.path.join(HERE, "..", "modules", "Protocol.py"))
+
+CONST_RE = re.compile(r"^\s*constexpr\s+\w+\s+([A-Z][A-Z0-9_]*)\s*=\s*(0[xX][0-9a-fA-F]+|\d+)\s*;\s*(?:///<\s*(.*))?$")
+
+# Constants the generated functions rely on (the header must define them)
+REQUIRED = ("VERSION", "TRACTION_OFFSET", "STEERING_OFFSET", "COMMAND_SIZE", "PROBE_OFFSET", "PROBE_MAX")
+
+TEMPLATE = '''"""
+Protocol.py
+-----------
+Control packet codec (Python side of 'firmware/include/control_protocol.h').
+
+GENERATED by 'python -m tools.gen_protocol'. DO NOT EDIT: change the header
+and regenerate, so the firmware and the client never disagree on the layout.
+"""
+
+{constants}
+
+
+def encode(traction, steering, probe=b""):
+    """
+    Builds one control packet (same rules as ControlProtocol::encode).
+    :param traction: 0=Coast, 1=Brake, 2-255=PWM forward.
+    :param steering: Servo angle (0-180).
+    :param probe: Optional token echoed back by the rover (max PROBE_MAX bytes).
+    :return: bytes ready for sendto() / a WebSocket binary frame.
+    """
+    if not (0 <= traction <= 255 and 0 <= steering <= 255):
+        raise ValueError(f"command out of byte range: {{traction}}, {{steering}}")
+    if len(probe) > PROBE_MAX:
+        raise ValueError(f"probe token too long: {{len(probe)}} > {{PROBE_MAX}}")
+    packet = bytearray(COMMAND_SIZE)
+    packet[TRACTION_OFFSET] = traction
+    packet[STEERING_OFFSET] = steering
+    return bytes(packet) + bytes(probe)
+
+
+def decode(data):
+    """
+    Splits one packet (same rules as ControlProtocol::PacketView).
+    :return: (traction, steering, probe) or None if shorter than COMMAND_SIZE.
+    """
+    if len(data) < COMMAND_SIZE:
+        return None
+    return data[TRACTION_OFFSET], data[STEERING_OFFSET], bytes(data[PROBE_OFFSET:])
+'''
+
+
+def parse_header(path):
+    """Returns [(name, value, comment)] in header order."""
+    constants = []
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            m = CONST_RE.match(line)
+            if m:
+                constants.append((m.group(1), int(m.group(2), 0), (m.group(3) or "").strip()))
+    return constants
+
+
+def render(constants):
+    """Builds the module text."""
+    width = max(len(name) for name, _, _ in constants)
+    lines = []
+    for name, value, comment in constants:
+        line = f"{name.ljust(width)} = {value}"
+        lines.append(f"{line}  # {comment}" if comment else line)
+    return TEMPLATE.format(constants="\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate modules/Protocol.py from control_protocol.h.")
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="C++ codec header")
+    parser.add_argument("--output", default=DEFAULT_OUTPUT, help="Generated Python module")
+    parser.add_argument("--check", action="store_true", help="Only verify the module is up to date")
+    args = parser.parse_args()
+
+    constants = parse_header(args.header)
+    missing = [name for name in REQUIRED if name not in {c[0] for c in constants}]
+    if missing:
+        print(f"[GEN] {args.header}: missing constants {', '.join(missing)}")
+        sys.exit(1)
+    text = render(constants)
+
+    if args.check:
+        try:
+            with open(args.output, encoding="utf-8") as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current != text:
+            print(f"[GEN] {args.output} is stale: run 'python -m tools.gen_protocol'")
+            sys.exit(1)
+        print(f"[GEN] {args.output} up to date ({len(constants)} constants)")
+        return
+
+    with open(args.output, "w", encoding="utf-8", newline="\n") as f:
+        f.write(text)
+    print(f"[GEN] Wrote {args.output} ({len(constants)} constants)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,240 @@
+"""
+load_generator.py
+-----------------
+Author: Alejandro Moyano (@AleSMC)
+Description: Control flood + concurrent video load generator (capacity test).
+
+Companion of 'firmware/examples/bench_network.cpp'. For every step of the
+sweep (stream clients x packet rate) it:
+
+1. Scrapes 'rover_udp_received_total' from '/metrics' (keepalive rate).
+2. Opens N '/stream' clients and floods UDP 9999 at the step rate with
+   neutral commands (Coast + Center) carrying a probe token (seq, t_send).
+3. Closes the streams, scrapes '/metrics' again and prints one CSV row:
+
+clients,rate,sent,fw_rx,drops,drop_pct,echoed,rtt_p50_ms,rtt_p99_ms,rtt_max_ms,per_client_fps
+
+- drops:          datagrams sent that never reached the control socket
+                  (radio + lwIP queue), from the firmware's own counter.
+- rtt_*:          probe echo round trip (PC -> Rover -> PWM -> Rover -> PC).
+- per_client_fps: JPEG frames received per client during the flood, '|' separated.
+
+Between steps, and while '/metrics' is scraped, the sender keeps a KEEPALIVE_HZ
+trickle: the link governor (on by default) learns a timeout near
+LINK_FAILSAFE_MIN_MS from it, so any pause would trip the failsafe and the
+step would be measured mid-failsafe. '/metrics' is scraped with the streams
+closed so the counters cover the whole step. Above STREAM_MAX_CLIENTS (config.h) each new client purges the
+least recently served one, so the extra clients show up as short-lived.
+
+Usage (from 'software/'):
+    python -m tools.load_generator --ip 192.168.4.1 --rates 50,100,200,500,1000 --clients 0,1,2
+"""
+
+import argparse
+import re
+import socket
+import struct
+import threading
+import time
+import urllib.request
+
+from modules import Protocol
+from tools.control_latency import NEUTRAL_CMD, PROBE_FMT, percentile
+
+KEEPALIVE_HZ = 20.0  # 50 ms gaps: inside the adaptive failsafe floor (LINK_FAILSAFE_MIN_MS, 150 ms)
+SETTLE_S = 0.2  # Flood backlog (socket buffer, radio queue) lands before a scrape
+FRAME_MARKER = b"Content-Type: image/jpeg"  # One per multipart part (CameraServer _STREAM_PART)
+RX_METRIC_RE = re.compile(rb"^rover_udp_received_total (\d+)$", re.M)
+
+
+class StreamClient(threading.Thread):
+    """Reads '/stream' as fast as possible and counts JPEG parts."""
+
+    def __init__(self, url):
+        super().__init__(daemon=True)
+        self.url = url
+        self.frames = 0
+        self.stop_event = threading.Event()
+
+    def run(self):
+        tail = b""
+        try:
+            with urllib.request.urlopen(self.url, timeout=5) as resp:
+                while not self.stop_event.is_set():
+                    chunk = resp.read1(16384)  # Whatever arrived: FPS is timed on it
+                    if not chunk:
+                        break
+                    # Keep the end of the previous chunk: a marker may be split
+                    data = tail + chunk
+                    self.frames += data.count(FRAME_MARKER)
+                    tail = data[-(len(FRAME_MARKER) - 1):]
+        except Exception:
+            pass  # Closed by us, or purged by the rover (STREAM_MAX_CLIENTS)
+
+
+class ControlFlood:
+    """Paced UDP sender and probe-echo receiver running for the whole sweep."""
+
+    def __init__(self, ip, port, dscp):
+        self.addr = (ip, port)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.IPPROTO_IP, socket.IP_TOS, dscp << 2)
+        self.sock.settimeout(0.1)
+        self.lock = threading.Lock()
+        self.rate = KEEPALIVE_HZ
+        self.sent = 0
+        self.echoes = []  # (t_send_ns, rtt_ms)
+        self.stop_event = threading.Event()
+
+    def set_rate(self, rate):
+        with self.lock:
+            self.rate = rate
+
+    def start(self):
+        threading.Thread(target=self._send_loop, daemon=True).start()
+        threading.Thread(target=self._recv_loop, daemon=True).start()
+
+    def _send_loop(self):
+        seq = 0
+        phase_start, phase_sent, phase_rate = time.perf_counter(), 0, self.rate
+        while not self.stop_event.is_set():
+            with self.lock:
+                rate = self.rate
+            if rate != phase_rate:
+                phase_start, phase_sent, phase_rate = time.perf_counter(), 0, rate
+
+            # Catch up with the schedule in bursts (sleep granularity is ~1ms)
+            due = int((time.perf_counter() - phase_start) * rate) - phase_sent
+            for _ in range(due):
+                token = struct.pack(PROBE_FMT, seq, time.perf_counter_ns())
+                try:
+                    self.sock.sendto(Protocol.encode(*NEUTRAL_CMD, probe=token), self.addr)
+                except OSError:
+                    continue  # ENOBUFS: the PC itself is saturated, not counted
+                seq += 1
+                phase_sent += 1
+                with self.lock:
+                    self.sent += 1
+            time.sleep(0.001)
+
+    def _recv_loop(self):
+        size = struct.calcsize(PROBE_FMT)
+        while not self.stop_event.is_set():
+            try:
+                data, _ = self.sock.recvfrom(64)
+            except socket.timeout:
+                continue
+            if len(data) == size:
+                _, t_send = struct.unpack(PROBE_FMT, data)
+                rtt = (time.perf_counter_ns() - t_send) / 1e6
+                with self.lock:
+                    self.echoes.append((t_send, rtt))
+
+    def snapshot_sent(self):
+        with self.lock:
+            return self.sent
+
+    def rtts_between(self, t0_ns, t1_ns):
+        with self.lock:
+            return sorted(rtt for t, rtt in self.echoes if t0_ns <= t < t1_ns)
+
+
+def scrape_rx(ip):
+    """Reads rover_udp_received_total. Returns None if '/metrics' does not answer."""
+    try:
+        with urllib.request.urlopen(f"http://{ip}/metrics", timeout=2) as resp:
+            m = RX_METRIC_RE.search(resp.read())
+            return int(m.group(1)) if m else None
+    except Exception:
+        return None
+
+
+def settled_scrape(flood, ip):
+    """Lets the flood backlog land at the keepalive rate, then scrapes.
+
+    Returns (sent, fw_rx). The keepalive never stops (failsafe): a datagram sent
+    during the scrape itself may be counted by the rover only. That skew is the
+    same at both ends of a step and cancels in the difference (+-1 datagram).
+    """
+    flood.set_rate(KEEPALIVE_HZ)
+    time.sleep(SETTLE_S)
+    sent = flood.snapshot_sent()
+    rx = scrape_rx(ip)
+    return sent, rx
+
+
+def run_step(flood, ip, clients, rate, duration):
+    """Runs one (clients, rate) step and returns its CSV row."""
+    # 1. BASELINE (streams closed, keepalive only)
+    sent0, rx0 = settled_scrape(flood, ip)
+
+    # 2. LOAD: streams first (ramp up), then the flood
+    streams = [StreamClient(f"http://{ip}/stream") for _ in range(clients)]
+    for s in streams:
+        s.start()
+    if streams:
+        time.sleep(2.0)
+
+    frames0 = [s.frames for s in streams]
+    t0 = time.perf_counter_ns()
+    flood.set_rate(rate)
+    time.sleep(duration)
+    flood.set_rate(KEEPALIVE_HZ)
+    t1 = time.perf_counter_ns()
+    fps = [(s.frames - f0) / duration for s, f0 in zip(streams, frames0)]
+
+    # 3. TEARDOWN: the handler notices the closed socket on its next send
+    for s in streams:
+        s.stop_event.set()
+    time.sleep(1.0 + 0.5 * len(streams))
+    sent1, rx1 = settled_scrape(flood, ip)
+
+    # 4. ROW
+    sent = sent1 - sent0
+    if rx0 is None or rx1 is None:
+        fw_rx, drops, drop_pct = "n/a", "n/a", "n/a"
+    else:
+        fw_rx = rx1 - rx0
+        drops = sent - fw_rx
+        drop_pct = f"{100.0 * drops / max(sent, 1):.2f}"
+    rtts = flood.rtts_between(t0, t1)
+    rtt_max = f"{rtts[-1]:.1f}" if rtts else "nan"
+    per_client = "|".join(f"{f:.1f}" for f in fps)
+    return (f"{clients},{rate:g},{sent},{fw_rx},{drops},{drop_pct},{len(rtts)},"
+            f"{percentile(rtts, 50):.1f},{percentile(rtts, 99):.1f},{rtt_max},{per_client}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flood the control port and open /stream clients (capacity test).")
+    parser.add_argument("--ip", default="192.168.4.1", help="Rover IP address")
+    parser.add_argument("--port", type=int, default=9999, help="UDP control port")
+    parser.add_argument("--rates", default="50,100,200,500,1000", help="Packet rates to sweep (pps, comma separated)")
+    parser.add_argument("--clients", default="0,1,2", help="Concurrent /stream clients to sweep (comma separated)")
+    parser.add_argument("--duration", type=float, default=10.0, help="Flood time per step (s)")
+    parser.add_argument("--dscp", type=int, default=48, help="DSCP for control packets (48=CS6/AC_VO)")
+    args = parser.parse_args()
+
+    rates = [float(r) for r in args.rates.split(",")]
+    client_counts = [int(c) for c in args.clients.split(",")]
+
+    if scrape_rx(args.ip) is None:
+        print(f"[LOAD] WARNING: http://{args.ip}/metrics unreachable, drops will be 'n/a'.")
+
+    flood = ControlFlood(args.ip, args.port, args.dscp)
+    flood.start()
+    print(f"[LOAD] {args.ip}:{args.port} | DSCP {args.dscp} | {len(rates) * len(client_counts)} steps "
+          f"x {args.duration:.0f}s")
+    print("clients,rate,sent,fw_rx,drops,drop_pct,echoed,rtt_p50_ms,rtt_p99_ms,rtt_max_ms,per_client_fps")
+
+    try:
+        for clients in client_counts:
+            for rate in rates:
+                print(run_step(flood, args.ip, clients, rate, args.duration), flush=True)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        flood.stop_event.set()
+
+
+if __name__ == "__main__":
+    main()
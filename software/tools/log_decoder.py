@@ -0,0 +1,187 @@
+"""
+log_decoder.py
+--------------
+Author: Alejandro Moyano (@AleSMC)
+Description: Serial console with binary event log decoding (EventLog).
+
+The firmware writes plain-text boot logs and binary event records on the same
+UART. Each record is framed as:
+
+    0x00 | COBS( id:u16 | ts_us:u32 | core:4 nargs:4 | args:u32 x nargs | crc8 ) | 0x00
+
+Text is passed through unchanged; records are rebuilt into text using the
+format strings of 'firmware/include/log_events.h' (the same table the firmware
+is compiled from, so IDs always match the flashed build).
+
+Usage (from 'software/'):
+    python -m tools.log_decoder --port /dev/ttyUSB0
+    python -m tools.log_decoder --file capture.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+DEFAULT_TABLE = os.path.join(os.path.dirname(__file__), "..", "..", "firmware", "include", "log_events.h")
+DEFAULT_BAUD = 921600  # LOG_BAUD in config.h
+
+# Longest encoded record: id + ts + meta + 15 args + crc (68 bytes) + 1 COBS code byte
+MAX_FRAME = 2 + 4 + 1 + 4 * 15 + 1 + 1
+
+# printf conversion specs: the letter decides how the raw u32 is interpreted
+SPEC_RE = re.compile(r"%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l)?([diuxXc%])")
+
+
+def load_table(path):
+    """Parses the X-macro table: position in ROVER_LOG_EVENTS = event ID."""
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    block = text[text.index("#define ROVER_LOG_EVENTS"):]
+    block = block[: block.index("\n\n")]
+    return re.findall(r'X\((\w+),\s*"((?:[^"\\]|\\.)*)"\)', block)
+
+
+def crc8(data):
+    """CRC-8, poly 0x07, init 0x00 (same as EventLog.cpp)."""
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def cobs_decode(data):
+    """Reverses COBS. Returns None on a malformed frame."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1: i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def format_event(table, raw):
+    """Rebuilds the text of one decoded record. Returns None if invalid."""
+    if len(raw) < 8 or crc8(raw[:-1]) != raw[-1]:
+        return None
+    event_id, ts = struct.unpack_from("<HI", raw, 0)
+    meta = raw[6]
+    core, nargs = meta >> 4, meta & 0x0F
+    if len(raw) != 8 + 4 * nargs:
+        return None
+    args = list(struct.unpack_from("<%dI" % nargs, raw, 7))
+
+    if event_id >= len(table):
+        return f"[{ts / 1e6:12.6f}] C{core} <unknown event {event_id}> {args}"
+    name, fmt = table[event_id]
+
+    # Reinterpret signed conversions (%d/%i) as int32
+    values = []
+    for spec in SPEC_RE.findall(fmt):
+        if spec == "%":
+            continue
+        v = args.pop(0) if args else 0
+        if spec in "di" and v >= 0x80000000:
+            v -= 1 << 32
+        values.append(v)
+    try:
+        text = SPEC_RE.sub(lambda m: m.group(0).replace("l", "").replace("h", ""), fmt) % tuple(values)
+    except (TypeError, ValueError):
+        text = f"{fmt} {values}"
+    return f"[{ts / 1e6:12.6f}] C{core} {text}"
+
+
+class StreamDecoder:
+    """Splits a byte stream into text lines and 0x00-delimited binary records.
+
+    Attached mid-record, the first 0x00 seen may close a record instead of
+    opening one, and the text after it is taken for a record. Resync: a frame
+    that does not decode was out of phase, so its closing 0x00 opens the next
+    record; a frame longer than any record is text and is printed as such.
+    """
+
+    def __init__(self, table, out):
+        self.table = table
+        self.out = out
+        self.text = bytearray()
+        self.frame = None  # bytearray while inside a record
+        self.bad = 0
+
+    def feed(self, data):
+        for b in data:
+            if self.frame is None:
+                if b == 0:
+                    self._flush_text()
+                    self.frame = bytearray()
+                else:
+                    self.text.append(b)
+                    if b == 0x0A:
+                        self._flush_text()
+            elif b == 0:
+                if self.frame:
+                    raw = cobs_decode(bytes(self.frame))
+                    line = format_event(self.table, raw) if raw else None
+                    if line is None:
+                        self.bad += 1
+                        self.frame = bytearray()  # Out of phase: this 0x00 opens a record
+                    else:
+                        self.out.write(line + "\n")
+                        self.frame = None
+                # Empty frame = back-to-back delimiters: stay in frame mode
+            else:
+                self.frame.append(b)
+                if len(self.frame) > MAX_FRAME:
+                    # No record is this long: it was text after a closing 0x00
+                    self.text += self.frame
+                    self.frame = None
+                    if b == 0x0A:
+                        self._flush_text()
+        self.out.flush()
+
+    def _flush_text(self):
+        if self.text:
+            self.out.write(self.text.decode("utf-8", errors="replace"))
+            self.text.clear()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the Rover serial log (text + binary events).")
+    parser.add_argument("--port", help="Serial port (e.g. /dev/ttyUSB0, COM3)")
+    parser.add_argument("--baud", type=int, default=DEFAULT_BAUD, help="Baud rate (LOG_BAUD)")
+    parser.add_argument("--file", help="Decode a raw capture instead of a serial port")
+    parser.add_argument("--table", default=DEFAULT_TABLE, help="Path to log_events.h")
+    args = parser.parse_args()
+
+    table = load_table(args.table)
+    decoder = StreamDecoder(table, sys.stdout)
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            decoder.feed(f.read())
+    elif args.port:
+        import serial  # pyserial, only needed for live capture
+
+        with serial.Serial(args.port, args.baud, timeout=0.1) as ser:
+            print(f"[DECODER] {args.port} @ {args.baud} baud, {len(table)} events. Ctrl+C to exit.")
+            try:
+                while True:
+                    decoder.feed(ser.read(4096))
+            except KeyboardInterrupt:
+                pass
+    else:
+        parser.error("--port or --file is required")
+
+    if decoder.bad:
+        print(f"[DECODER] {decoder.bad} corrupt record(s) skipped.", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,69 @@
+"""
+params.py
+---------
+Author: Alejandro Moyano (@AleSMC)
+Description: Runtime parameter client (track-side tuning without reflashing).
+
+Talks to the firmware's ParamRegistry over its UDP text protocol
+(PARAM_UDP_PORT, default 9998). Values are applied live by the owning
+subsystem and stored in NVS, so they survive reboots until reset.
+
+Usage (from 'software/'):
+    python -m tools.params --ip 192.168.4.1 list
+    python -m tools.params --ip 192.168.4.1 get failsafe_ms
+    python -m tools.params --ip 192.168.4.1 set motor_pwm_hz 18000
+    python -m tools.params --ip 192.168.4.1 reset steer_center
+
+The same table is served as JSON at 'http://<ip>/params'.
+"""
+
+import argparse
+import socket
+import sys
+
+PARAM_PORT = 9998  # Must match PARAM_UDP_PORT in firmware/include/config.h
+
+
+def request(ip, port, line, timeout=1.0, retries=3):
+    """Sends one request datagram and returns the reply text (None if no answer)."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(timeout)
+    try:
+        for _ in range(retries):  # UDP: a lost request is simply sent again (set is idempotent)
+            sock.sendto(line.encode(), (ip, port))
+            try:
+                data, _ = sock.recvfrom(2048)
+                return data.decode(errors="replace")
+            except socket.timeout:
+                continue
+        return None
+    finally:
+        sock.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Get/set rover runtime parameters (NVS-backed, applied live).")
+    parser.add_argument("--ip", default="192.168.4.1", help="Rover IP address")
+    parser.add_argument("--port", type=int, default=PARAM_PORT, help="Parameter UDP port")
+    parser.add_argument("command", choices=["list", "get", "set", "reset"])
+    parser.add_argument("key", nargs="?", help="Parameter name (get/set/reset)")
+    parser.add_argument("value", nargs="?", type=int, help="New value (set)")
+    args = parser.parse_args()
+
+    if args.command != "list" and not args.key:
+        parser.error(f"'{args.command}' needs a key")
+    if args.command == "set" and args.value is None:
+        parser.error("'set' needs a value")
+
+    line = " ".join(str(x) for x in (args.command, args.key, args.value) if x is not None)
+    reply = request(args.ip, args.port, line)
+    if reply is None:
+        print(f"[PARAMS] No answer from {args.ip}:{args.port}")
+        sys.exit(1)
+
+    print(reply, end="" if reply.endswith("\n") else "\n")
+    sys.exit(1 if reply.startswith("ERR") else 0)
+
+
+if __name__ == "__main__":
+    main()